@@ -1,71 +1,22 @@
-QT       += core gui
+# Physics project: the graphical application, the command-line simulation runner,
+# the static library of the computation core and its tests
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+TEMPLATE = subdirs
 
-QMAKE_CXXFLAGS += -std=c++14
+SUBDIRS += \
+    engine \
+    gui \
+    cli \
+    tests
 
-# The following define makes your compiler emit warnings if you use
-# any Qt feature that has been marked deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
+gui.file = Physics_project_gui.pro
+cli.file = cli/cli.pro
+engine.file = engine/engine.pro
+tests.file = tests/tests.pro
 
-# You can also make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+# The application and the runner link the static library of the computation core
+gui.depends = engine
+cli.depends = engine
 
-SOURCES += \
-    computation/antennas.cpp \
-    computation/computationunit.cpp \
-    computation/constants.cpp \
-    computation/emitter.cpp \
-    computation/raypath.cpp \
-    computation/receiver.cpp \
-    computation/simulationdata.cpp \
-    computation/simulationhandler.cpp \
-    computation/walls.cpp \
-    interface/datalegenditem.cpp \
-    interface/emitterdialog.cpp \
-    interface/mainwindow.cpp \
-    interface/receiverdialog.cpp \
-    interface/scaleruleritem.cpp \
-    interface/simulationitem.cpp \
-    interface/simulationscene.cpp \
-    main.cpp
-
-HEADERS += \
-    computation/antennas.h \
-    computation/computationunit.h \
-    computation/constants.h \
-    computation/emitter.h \
-    computation/raypath.h \
-    computation/receiver.h \
-    computation/simulationdata.h \
-    computation/simulationhandler.h \
-    computation/walls.h \
-    interface/datalegenditem.h \
-    interface/emitterdialog.h \
-    interface/mainwindow.h \
-    interface/receiverdialog.h \
-    interface/scaleruleritem.h \
-    interface/simulationitem.h \
-    interface/simulationscene.h
-
-FORMS += \
-    interface/emitterdialog.ui \
-    interface/mainwindow.ui \
-    interface/receiverdialog.ui
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-DISTFILES += \
-    resources/antenna.ico
-
-RESOURCES += \
-    resources/resources.qrc
-
-RC_ICONS = resources/antenna.ico
+# The tests of the computation core only link its library
+tests.depends = engine
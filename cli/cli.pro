@@ -0,0 +1,23 @@
+# The simulation items are graphics items, so the runner needs QtGui and QtWidgets
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TARGET = Physics_project_cli
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../simulation.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
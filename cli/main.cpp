@@ -0,0 +1,714 @@
+#include "computation/simulationhandler.h"
+#include "computation/propagationmodel.h"
+#include "interface/simulationscene.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QGraphicsView>
+#include <QImage>
+#include <QPainter>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+/**
+ * Command-line simulation runner.
+ *
+ * This program loads a map file (.rtmap), runs a point or area simulation
+ * without any display, and writes the results of each receiver into a CSV file.
+ * The 'points' mode evaluates a list of points with the computation core only
+ * (no simulation item is created), optionally for a sweep of frequencies
+ * (one results file per band) or with the wideband metrics of the channel.
+ * The 'render' mode measures the time taken to render the items of the map with a view,
+ * with and without the cached geometry of the items (bounding rects and shapes).
+ */
+
+/**
+ * @brief simulationBoundingRect
+ * @param data
+ * @return
+ *
+ * This function returns the rectangle containing all the items of the simulation data
+ * (same as SimulationScene::simulationBoundingRect(), without scene)
+ */
+static QRectF simulationBoundingRect(SimulationData *data) {
+    QRectF bounding_rect;
+    QList<SimulationItem*> items;
+
+    foreach (Wall *w, data->getWallsList()) {
+        items.append(w);
+    }
+    foreach (Emitter *e, data->getEmittersList()) {
+        items.append(e);
+    }
+    foreach (Receiver *r, data->getReceiverList()) {
+        items.append(r);
+    }
+
+    foreach (SimulationItem *s_i, items) {
+        // Bounding rect is a rectangle containing bounding rects of all items
+        bounding_rect = bounding_rect.united(s_i->boundingRect().translated(s_i->pos()));
+    }
+
+    return bounding_rect;
+}
+
+/**
+ * @brief renderFrames
+ * @param view     : The view of the scene to render
+ * @param items    : The items of the map
+ * @param frames   : The number of frames to render
+ * @param uncached : Compute the geometry of the items again before each frame
+ * @param err      : The stream to write the timings
+ *
+ * This function renders the view into an image once per frame, and writes the time
+ * taken by the first frame and the mean time of the next ones.
+ */
+static void renderFrames(QGraphicsView *view, const QList<SimulationItem*> &items, int frames, bool uncached, QTextStream &err) {
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+
+    QElapsedTimer timer;
+    double first_frame = 0;
+    double next_frames = 0;
+
+    for (int f = 0 ; f < frames ; f++) {
+        image.fill(Qt::white);
+        timer.start();
+
+        if (uncached) {
+            foreach (SimulationItem *item, items) {
+                item->invalidateGeometry();
+            }
+        }
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        view->render(&painter);
+        painter.end();
+
+        const double frame_time = timer.nsecsElapsed() * 1e-6;
+
+        if (f == 0) {
+            first_frame = frame_time;
+        }
+        else {
+            next_frames += frame_time;
+        }
+    }
+
+    err << (uncached ? "Uncached geometry" : "Cached geometry") << Qt::endl;
+    err << "  First frame: " << first_frame << " ms" << Qt::endl;
+
+    if (frames > 1) {
+        err << "  Next frames: " << next_frames / (frames - 1) << " ms per frame" << Qt::endl;
+    }
+}
+
+/**
+ * @brief benchmarkGeometry
+ * @param data   : The simulation data of the map
+ * @param frames : The number of frames to measure
+ * @param err    : The stream to write the timings
+ *
+ * This function places the walls and emitters of the map in a simulation scene, and
+ * renders the scene with a view into an image for the given number of frames.
+ * The frames are rendered with the cached geometry of the items (computed by the first
+ * frame), then with the geometry computed again before each frame, to compare both.
+ */
+static void benchmarkGeometry(SimulationData *data, int frames, QTextStream &err) {
+    QList<SimulationItem*> items;
+
+    foreach (Wall *w, data->getWallsList()) {
+        items.append(w);
+    }
+    foreach (Emitter *e, data->getEmittersList()) {
+        items.append(e);
+    }
+
+    SimulationScene scene;
+
+    foreach (SimulationItem *item, items) {
+        scene.addItem(item);
+    }
+
+    // Show the whole map in the view, as the editor does after loading a file
+    QGraphicsView view(&scene);
+    view.resize(1280, 720);
+    view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.fitInView(scene.simulationBoundingRect(), Qt::KeepAspectRatio);
+
+    err << "Rendering " << items.size() << " items in a " << view.viewport()->width()
+        << "x" << view.viewport()->height() << " px view" << Qt::endl;
+
+    renderFrames(&view, items, frames, false, err);
+    renderFrames(&view, items, frames, true, err);
+
+    // The items are owned by the simulation data, not by the scene
+    foreach (SimulationItem *item, items) {
+        scene.removeItem(item);
+    }
+}
+
+/**
+ * @brief writeResults
+ * @param file_path
+ * @param receivers
+ * @return
+ *
+ * This function writes the results of each receiver into a CSV file
+ * (position in meters, received power, bitrate and number of ray paths)
+ */
+static bool writeResults(QString file_path, QList<Receiver*> receivers) {
+    QFile file(file_path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "x;y;power_dbm;bitrate_mbps;ray_paths\n";
+
+    foreach (Receiver *r, receivers) {
+        const QPointF pos = r->getRealPos();
+
+        out << pos.x() << ";"
+            << pos.y() << ";"
+            << SimulationData::convertPowerTodBm(r->receivedPower()) << ";"
+            << r->getBitRate() << ";"
+            << r->receivedPathsCount() << "\n";
+    }
+
+    file.close();
+    return true;
+}
+
+/**
+ * @brief writeAreaResults
+ * @param file_path
+ * @param area
+ * @return
+ *
+ * This function writes the results of each cell of an area into a CSV file
+ * (same columns as writeResults())
+ */
+static bool writeAreaResults(QString file_path, ReceiversArea *area) {
+    QFile file(file_path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "x;y;power_dbm;bitrate_mbps;ray_paths\n";
+
+    for (int cell : area->getCellsList()) {
+        const QPointF pos = area->cellRealPos(cell);
+        const double power = area->receivedPower(cell);
+
+        out << pos.x() << ";"
+            << pos.y() << ";"
+            << SimulationData::convertPowerTodBm(power) << ";"
+            << PropagationModel::bitRate(power) << ";"
+            << area->receivedPathsCount(cell) << "\n";
+    }
+
+    file.close();
+    return true;
+}
+
+/**
+ * @brief writePointsResults
+ * @param file_path
+ * @param points
+ * @param results
+ * @return
+ *
+ * This function writes the results of a batch of points into a CSV file
+ */
+static bool writePointsResults(QString file_path, const vector<QPointF> &points, const vector<PointResult> &results) {
+    QFile file(file_path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "x;y;power_dbm;bitrate_mbps;ray_paths\n";
+
+    for (size_t i = 0 ; i < points.size() ; i++) {
+        out << points[i].x() << ";"
+            << points[i].y() << ";"
+            << SimulationData::convertPowerTodBm(results[i].power) << ";"
+            << results[i].bitrate << ";"
+            << results[i].paths_count << "\n";
+    }
+
+    file.close();
+    return true;
+}
+
+/**
+ * @brief bandFilePath
+ * @param output_path : The results file of the simulation
+ * @param frequency   : The frequency of the band (in Hz)
+ * @return
+ *
+ * This function returns the results file of a band of a frequency sweep
+ * (the frequency in GHz is added before the extension)
+ */
+static QString bandFilePath(QString output_path, double frequency) {
+    const int dot = output_path.lastIndexOf('.');
+    const QString base = dot > 0 ? output_path.left(dot) : output_path;
+    const QString ext = dot > 0 ? output_path.mid(dot) : QString(".csv");
+
+    return QString("%1_%2GHz%3").arg(base).arg(frequency / 1e9).arg(ext);
+}
+
+/**
+ * @brief writeChannelResults
+ * @param file_path
+ * @param points
+ * @param results
+ * @return
+ *
+ * This function writes the wideband metrics of a batch of points into a CSV file, and
+ * their power delay profiles into a second file (the bins with some power, one per line)
+ */
+static bool writeChannelResults(QString file_path, const vector<QPointF> &points, const vector<ChannelMetrics> &results) {
+    QFile file(file_path);
+    QFile pdp_file(file_path.left(file_path.lastIndexOf('.')) + "_pdp.csv");
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text) ||
+            !pdp_file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "x;y;power_dbm;wideband_power_dbm;mean_delay_ns;rms_delay_spread_ns;capacity_mbps;ray_paths\n";
+
+    QTextStream pdp_out(&pdp_file);
+    pdp_out << "x;y;delay_ns;power_dbm\n";
+
+    for (size_t i = 0 ; i < points.size() ; i++) {
+        const ChannelMetrics &m = results[i];
+
+        out << points[i].x() << ";"
+            << points[i].y() << ";"
+            << SimulationData::convertPowerTodBm(m.totalPower()) << ";"
+            << SimulationData::convertPowerTodBm(m.widebandPower()) << ";"
+            << m.meanDelay() * 1e9 << ";"
+            << m.rmsDelaySpread() * 1e9 << ";"
+            << m.capacity() << ";"
+            << m.pathsCount() << "\n";
+
+        const vector<double> &pdp = m.delayProfile();
+
+        for (size_t b = 0 ; b < pdp.size() ; b++) {
+            if (pdp[b] > 0) {
+                pdp_out << points[i].x() << ";"
+                        << points[i].y() << ";"
+                        << b * PDP_BIN_WIDTH * 1e9 << ";"
+                        << SimulationData::convertPowerTodBm(pdp[b]) << "\n";
+            }
+        }
+    }
+
+    file.close();
+    pdp_file.close();
+    return true;
+}
+
+/**
+ * @brief evaluatePointsFile
+ * @param map_path    : The map file
+ * @param points_path : The file of the points to evaluate (one "x;y" line per point, in meters)
+ * @param output_path : The results file
+ * @param antenna     : The antenna of the receivers at the points
+ * @param threads     : The number of threads (0 for the number of processor cores)
+ * @param pruning     : The pruning threshold (in Watts, 0 to disable)
+ * @param reflections : The max number of reflections (-1 for the value saved in the map)
+ * @param bands       : The frequencies of the sweep (in Hz, empty for the frequencies of the emitters)
+ * @param channel     : The channel of the wideband metrics to compute (nullptr for the powers only)
+ * @return            : The exit code of the program
+ *
+ * This function evaluates a batch of points with the computation core.
+ * For a frequency sweep, the ray paths are traced once and evaluated at each frequency,
+ * and the results of each band are written into their own file.
+ */
+static int evaluatePointsFile(
+        QString map_path,
+        QString points_path,
+        QString output_path,
+        const Antenna *antenna,
+        int threads,
+        double pruning,
+        int reflections,
+        const vector<double> &bands,
+        const ChannelMetrics *channel)
+{
+    QTextStream err(stderr);
+
+    // Read the map file into a compiled scene (no graphics item)
+    QFile map_file(map_path);
+    if (!map_file.open(QIODevice::ReadOnly)) {
+        err << "Unable to open the map file " << map_path << Qt::endl;
+        return 1;
+    }
+
+    CompiledScene scene;
+    QDataStream in(&map_file);
+    in >> &scene;
+    map_file.close();
+
+    if (in.status() != QDataStream::Ok) {
+        err << "Invalid map file " << map_path << Qt::endl;
+        return 1;
+    }
+
+    if (reflections >= 0) {
+        scene.setReflectionsCount(reflections);
+    }
+
+    // The coefficients of the materials must be computed at the frequencies of the sweep
+    for (double frequency : bands) {
+        scene.addFrequency(frequency);
+    }
+    scene.finalize();
+
+    // Read the points
+    QFile points_file(points_path);
+    if (!points_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        err << "Unable to open the points file " << points_path << Qt::endl;
+        return 1;
+    }
+
+    vector<QPointF> points;
+    QTextStream points_in(&points_file);
+
+    while (!points_in.atEnd()) {
+        const QStringList fields = points_in.readLine().split(';');
+        bool x_ok = false, y_ok = false;
+
+        if (fields.size() >= 2) {
+            const double x = fields[0].toDouble(&x_ok);
+            const double y = fields[1].toDouble(&y_ok);
+
+            // Skip the lines that are not points (header)
+            if (x_ok && y_ok) {
+                points.push_back(QPointF(x, y));
+            }
+        }
+    }
+    points_file.close();
+
+    PropagationModel model(&scene);
+
+    // Wideband metrics of the channel at each point
+    if (channel != nullptr) {
+        vector<ChannelMetrics> metrics;
+        model.evaluatePointsChannel(points, antenna, *channel, &metrics, threads);
+
+        if (!writeChannelResults(output_path, points, metrics)) {
+            err << "Unable to write the results file " << output_path << Qt::endl;
+            return 1;
+        }
+
+        err << "Evaluated the channel at " << points.size() << " points, results written to " << output_path << Qt::endl;
+        return 0;
+    }
+
+    // Frequency sweep: one results layer per band
+    if (!bands.empty()) {
+        if (pruning > 0) {
+            err << "The pruning is not used for a frequency sweep" << Qt::endl;
+        }
+
+        vector<vector<PointResult>> layers;
+        if (!model.evaluatePointsBands(points, antenna, bands, &layers, threads)) {
+            err << "Unable to evaluate the frequency sweep (a frequency is missing in the scene)" << Qt::endl;
+            return 1;
+        }
+
+        for (size_t b = 0 ; b < bands.size() ; b++) {
+            const QString band_path = bandFilePath(output_path, bands[b]);
+
+            if (!writePointsResults(band_path, points, layers[b])) {
+                err << "Unable to write the results file " << band_path << Qt::endl;
+                return 1;
+            }
+        }
+
+        err << "Evaluated " << points.size() << " points for " << bands.size() << " bands" << Qt::endl;
+        return 0;
+    }
+
+    // Evaluate all the points at once
+    vector<PointResult> results;
+    model.evaluatePoints(points, antenna, &results, pruning, threads);
+
+    if (!writePointsResults(output_path, points, results)) {
+        err << "Unable to write the results file " << output_path << Qt::endl;
+        return 1;
+    }
+
+    err << "Evaluated " << points.size() << " points, results written to " << output_path << Qt::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // The simulation items are graphics items (QtWidgets), so they need a QApplication.
+    // No window is shown, so the offscreen platform is used unless another one is given.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("Physics_project_cli");
+
+    QTextStream err(stderr);
+
+    // Command line options
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a ray-tracing simulation without graphical interface.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("map", "The map file to simulate (.rtmap).");
+
+    QCommandLineOption mode_option(
+                QStringList() << "m" << "mode",
+                "Simulation type: 'point' (receivers of the map), 'area' (one receiver per m²),"
+                " 'points' (points of the --points file) or 'render' (geometry timings of the map).",
+                "mode", "point");
+    QCommandLineOption reflections_option(
+                QStringList() << "r" << "reflections",
+                "Max number of reflections (default: value saved in the map).",
+                "count");
+    QCommandLineOption threads_option(
+                QStringList() << "t" << "threads",
+                "Number of computation threads (default: number of cores).",
+                "count");
+    QCommandLineOption antenna_option(
+                QStringList() << "a" << "antenna",
+                "Antenna of the area receivers: 'vertical' or 'horizontal' half-wave dipole.",
+                "type", "vertical");
+    QCommandLineOption pruning_option(
+                "pruning",
+                "Prune the reflections whose estimated power doesn't reach this threshold (in dBm).",
+                "dBm");
+    QCommandLineOption points_option(
+                "points",
+                "Points to evaluate in the 'points' mode (CSV file, one 'x;y' line per point, in meters).",
+                "file");
+    QCommandLineOption bands_option(
+                "bands",
+                "Frequencies of a sweep in the 'points' mode (comma-separated, in Hz),"
+                " with one results file per band.",
+                "frequencies");
+    QCommandLineOption wideband_option(
+                "wideband",
+                "Compute the wideband metrics of the channel in the 'points' mode (delay spread,"
+                " frequency response and capacity), and the power delay profiles.");
+    QCommandLineOption bandwidth_option(
+                "bandwidth",
+                "Bandwidth of the OFDM channel of the wideband metrics (in MHz, default: 80).",
+                "MHz");
+    QCommandLineOption subcarriers_option(
+                "subcarriers",
+                "Number of subcarriers of the OFDM channel of the wideband metrics (default: 256).",
+                "count");
+    QCommandLineOption frames_option(
+                "frames",
+                "Number of frames measured in the 'render' mode (default: 100).",
+                "count", "100");
+    QCommandLineOption output_option(
+                QStringList() << "o" << "output",
+                "Results file (CSV, default: the map file with the .csv extension).",
+                "file");
+
+    parser.addOption(mode_option);
+    parser.addOption(reflections_option);
+    parser.addOption(threads_option);
+    parser.addOption(antenna_option);
+    parser.addOption(pruning_option);
+    parser.addOption(points_option);
+    parser.addOption(bands_option);
+    parser.addOption(wideband_option);
+    parser.addOption(bandwidth_option);
+    parser.addOption(subcarriers_option);
+    parser.addOption(frames_option);
+    parser.addOption(output_option);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    const QString map_path = parser.positionalArguments().first();
+    QString output_path = parser.value(output_option);
+
+    if (output_path.isEmpty()) {
+        output_path = map_path.left(map_path.lastIndexOf('.')) + ".csv";
+    }
+
+    // Evaluate a list of points with the computation core only
+    if (parser.value(mode_option) == "points") {
+        if (!parser.isSet(points_option)) {
+            err << "The 'points' mode needs a --points file" << Qt::endl;
+            return 1;
+        }
+
+        AntennaType::AntennaType type = AntennaType::HalfWaveDipoleVert;
+
+        if (parser.value(antenna_option) == "horizontal") {
+            type = AntennaType::HalfWaveDipoleHoriz;
+        }
+
+        // Frequencies of the sweep
+        vector<double> bands;
+
+        if (parser.isSet(bands_option)) {
+            foreach (const QString &field, parser.value(bands_option).split(',')) {
+                bool ok = false;
+                const double frequency = field.toDouble(&ok);
+
+                if (!ok || frequency <= 0) {
+                    err << "Invalid frequency " << field << Qt::endl;
+                    return 1;
+                }
+
+                bands.push_back(frequency);
+            }
+        }
+
+        // OFDM channel of the wideband metrics
+        ChannelMetrics channel(
+                    parser.isSet(bandwidth_option) ?
+                        parser.value(bandwidth_option).toDouble() * 1e6 : CHANNEL_DEFAULT_BANDWIDTH,
+                    parser.isSet(subcarriers_option) ?
+                        parser.value(subcarriers_option).toInt() : CHANNEL_DEFAULT_SUBCARRIERS);
+
+        Antenna *antenna = Antenna::createAntenna(type, 1.0);
+
+        const int exit_code = evaluatePointsFile(
+                    map_path,
+                    parser.value(points_option),
+                    output_path,
+                    antenna,
+                    parser.isSet(threads_option) ? parser.value(threads_option).toInt() : 0,
+                    parser.isSet(pruning_option) ?
+                        SimulationData::convertPowerToWatts(parser.value(pruning_option).toDouble()) : 0,
+                    parser.isSet(reflections_option) ? parser.value(reflections_option).toInt() : -1,
+                    bands,
+                    parser.isSet(wideband_option) ? &channel : nullptr);
+
+        delete antenna;
+        return exit_code;
+    }
+
+    SimulationHandler handler;
+    SimulationData *data = handler.simulationData();
+
+    // Read the map file
+    QFile file(map_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "Unable to open the map file " << map_path << Qt::endl;
+        return 1;
+    }
+
+    QDataStream in(&file);
+    in >> data;
+    file.close();
+
+    // Measure the geometry of the items instead of simulating
+    if (parser.value(mode_option) == "render") {
+        benchmarkGeometry(data, parser.value(frames_option).toInt(), err);
+        return 0;
+    }
+
+    if (data->getEmittersList().size() < 1) {
+        err << "The map must contain at least one emitter" << Qt::endl;
+        return 1;
+    }
+
+    // Simulation settings
+    if (parser.isSet(reflections_option)) {
+        data->setReflectionsCount(parser.value(reflections_option).toInt());
+    }
+    if (parser.isSet(threads_option)) {
+        handler.setThreadsCount(parser.value(threads_option).toInt());
+    }
+    if (parser.isSet(pruning_option)) {
+        data->setPruningEnabled(true);
+        data->setPruningThreshold(parser.value(pruning_option).toDouble());
+    }
+
+    // Get the receivers (or the cells of the area) for the simulation type
+    QList<Receiver*> receivers;
+    ReceiversArea area;
+    bool area_mode = false;
+
+    if (parser.value(mode_option) == "area") {
+        AntennaType::AntennaType type = AntennaType::HalfWaveDipoleVert;
+
+        if (parser.value(antenna_option) == "horizontal") {
+            type = AntennaType::HalfWaveDipoleHoriz;
+        }
+
+        data->setSimulationType(SimType::AreaReceiver);
+        area.setArea(type, simulationBoundingRect(data));
+        area_mode = true;
+    }
+    else if (parser.value(mode_option) == "point") {
+        data->setSimulationType(SimType::PointReceiver);
+        receivers = data->getReceiverList();
+    }
+    else {
+        err << "Unknown simulation type " << parser.value(mode_option) << Qt::endl;
+        return 1;
+    }
+
+    // Write the results and quit when the simulation is done
+    int exit_code = 0;
+
+    QObject::connect(&handler, &SimulationHandler::simulationFinished, [&]() {
+        const bool written = area_mode ?
+                    writeAreaResults(output_path, &area) :
+                    writeResults(output_path, receivers);
+
+        if (!written) {
+            err << "Unable to write the results file " << output_path << Qt::endl;
+            exit_code = 1;
+        }
+        else {
+            err << "Simulated " << (area_mode ? area.cellsCount() : receivers.size()) << " receivers with "
+                << handler.threadsCount() << " threads, results written to " << output_path << Qt::endl;
+        }
+
+        if (data->pruningEnabled()) {
+            err << "Pruned branches: " << handler.prunedBranchesCount()
+                << ", estimated error per receiver: "
+                << SimulationData::convertPowerTodBm(handler.pruningErrorEstimate()) << " dBm" << Qt::endl;
+        }
+
+        app.quit();
+    });
+
+    // Start the simulation from the event loop (the end of the computation is signaled through it)
+    QTimer::singleShot(0, [&]() {
+        if (area_mode) {
+            handler.startSimulationComputation(&area, area.getCellsList());
+        }
+        else {
+            handler.startSimulationComputation(receivers);
+        }
+    });
+
+    app.exec();
+
+    // Delete the ray paths before the receivers (and the area)
+    handler.resetComputedData();
+
+    return exit_code;
+}
@@ -65,6 +65,19 @@ Antenna *Antenna::createAntenna(AntennaType::AntennaType type, double efficiency
     return antenna;
 }
 
+/**
+ * @brief Antenna::clone
+ * @return
+ *
+ * This function returns a new antenna with the same type, efficiency and rotation
+ */
+Antenna *Antenna::clone() const {
+    Antenna *antenna = createAntenna(getAntennaType(), getEfficiency());
+    antenna->setRotation(getRotation());
+
+    return antenna;
+}
+
 QDataStream &operator>>(QDataStream &in, Antenna *&a) {
     int type;
     double efficiency;
@@ -154,7 +167,7 @@ double HalfWaveDipoleVert::getGain(double theta, double phi) const {
  * Returns the effective height of the dipole at the given incidents angles.
  * The 'frequency' defines the design of the antenna (wave length)
  */
-vector<complex> HalfWaveDipoleVert::getEffectiveHeight(
+cvector3 HalfWaveDipoleVert::getEffectiveHeight(
         double theta,
         double phi,
         double frequency) const
@@ -163,17 +176,17 @@ vector<complex> HalfWaveDipoleVert::getEffectiveHeight(
 
     // This function equals 0 for theta == 0, but avoid the 0/0 situation
     if (theta == 0) {
-        return {0, 0, 0};
+        return cvector3();
     }
 
     // Compute the wave length
     double lambda = LIGHT_SPEED / frequency;
 
-    return {
+    return cvector3(
         0,
         0,
         -lambda/M_PI * cos(M_PI_2 * cos(theta))/pow(sin(theta),2)
-    };
+    );
 }
 
 /**
@@ -183,8 +196,33 @@ vector<complex> HalfWaveDipoleVert::getEffectiveHeight(
  * Returns the vector describing the polarization.
  * The first component is the parallel, the second is the orthogonal.
  */
-vector<complex> HalfWaveDipoleVert::getPolarization() const {
-    return {0, 1};
+cvector3 HalfWaveDipoleVert::getPolarization() const {
+    return cvector3(0, 1);
+}
+
+/**
+ * @brief HalfWaveDipoleVert::getMaxGain
+ * @return
+ *
+ * Returns the maximum of the gain over all the incidence angles
+ */
+double HalfWaveDipoleVert::getMaxGain() const {
+    // The gain of the dipole is maximal in its orthogonal plane
+    return getEfficiency() * 16.0/(3*M_PI);
+}
+
+/**
+ * @brief HalfWaveDipoleVert::getMaxEffectiveHeight
+ * @param frequency
+ * @return
+ *
+ * Returns the maximum of the effective height's modulus over all the incidence angles
+ */
+double HalfWaveDipoleVert::getMaxEffectiveHeight(double frequency) const {
+    // Compute the wave length
+    double lambda = LIGHT_SPEED / frequency;
+
+    return lambda/M_PI;
 }
 
 
@@ -260,7 +298,7 @@ double HalfWaveDipoleHoriz::getGain(double theta, double phi) const {
  *
  * WARNING: the y axis is upside down in the graphics scene !
  */
-vector<complex> HalfWaveDipoleHoriz::getEffectiveHeight(
+cvector3 HalfWaveDipoleHoriz::getEffectiveHeight(
         double theta,
         double phi,
         double frequency) const
@@ -269,7 +307,7 @@ vector<complex> HalfWaveDipoleHoriz::getEffectiveHeight(
 
     // This function equals 0 for theta == 0, but avoid the 0/0 situation
     if (phi == 0) {
-        return {0, 0, 0};
+        return cvector3();
     }
 
     // Compute the wave length
@@ -278,11 +316,11 @@ vector<complex> HalfWaveDipoleHoriz::getEffectiveHeight(
     // Compute the effective height (equation 5.42)
     complex he = -lambda/M_PI * cos(M_PI_2 * cos(phi))/pow(sin(phi),2);
 
-    return {
+    return cvector3(
         cos(getRotation()) * he,
         -sin(getRotation()) * he,
         0
-    };
+    );
 }
 
 /**
@@ -292,7 +330,32 @@ vector<complex> HalfWaveDipoleHoriz::getEffectiveHeight(
  * Returns the vector describing the polarization.
  * The first component is the parallel, the second is the orthogonal.
  */
-vector<complex> HalfWaveDipoleHoriz::getPolarization() const {
-    return {1, 0};
+cvector3 HalfWaveDipoleHoriz::getPolarization() const {
+    return cvector3(1, 0);
+}
+
+/**
+ * @brief HalfWaveDipoleHoriz::getMaxGain
+ * @return
+ *
+ * Returns the maximum of the gain over all the incidence angles
+ */
+double HalfWaveDipoleHoriz::getMaxGain() const {
+    // The gain of the dipole is maximal in its orthogonal plane
+    return getEfficiency() * 16.0/(3*M_PI);
+}
+
+/**
+ * @brief HalfWaveDipoleHoriz::getMaxEffectiveHeight
+ * @param frequency
+ * @return
+ *
+ * Returns the maximum of the effective height's modulus over all the incidence angles
+ */
+double HalfWaveDipoleHoriz::getMaxEffectiveHeight(double frequency) const {
+    // Compute the wave length
+    double lambda = LIGHT_SPEED / frequency;
+
+    return lambda/M_PI;
 }
 
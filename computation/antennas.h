@@ -33,15 +33,19 @@ public:
     void setEfficiency(double efficiency);
 
     static Antenna *createAntenna(AntennaType::AntennaType type, double efficiency);
+    Antenna *clone() const;
 
     virtual AntennaType::AntennaType getAntennaType() const = 0;
     virtual QString getAntennaName() const = 0;
     virtual QString getAntennaLabel() const = 0;
 
     virtual double getResistance() const = 0;
-    virtual vector<complex> getEffectiveHeight(double theta, double phi, double frequency) const = 0;
+    virtual cvector3 getEffectiveHeight(double theta, double phi, double frequency) const = 0;
     virtual double getGain(double theta, double phi) const = 0;
-    virtual vector<complex> getPolarization() const = 0;
+    virtual cvector3 getPolarization() const = 0;
+
+    virtual double getMaxGain() const = 0;
+    virtual double getMaxEffectiveHeight(double frequency) const = 0;
 
 private:
     double m_rotation_angle;
@@ -58,9 +62,12 @@ public:
     QString getAntennaLabel() const override;
 
     double getResistance() const override;
-    vector<complex> getEffectiveHeight(double theta, double phi, double frequency) const override;
+    cvector3 getEffectiveHeight(double theta, double phi, double frequency) const override;
     double getGain(double theta, double phi) const override;
-    vector<complex> getPolarization() const override;
+    cvector3 getPolarization() const override;
+
+    double getMaxGain() const override;
+    double getMaxEffectiveHeight(double frequency) const override;
 
 };
 
@@ -75,9 +82,12 @@ public:
     QString getAntennaLabel() const override;
 
     double getResistance() const override;
-    vector<complex> getEffectiveHeight(double theta, double phi, double frequency) const override;
+    cvector3 getEffectiveHeight(double theta, double phi, double frequency) const override;
     double getGain(double theta, double phi) const override;
-    vector<complex> getPolarization() const override;
+    cvector3 getPolarization() const override;
+
+    double getMaxGain() const override;
+    double getMaxEffectiveHeight(double frequency) const override;
 
 };
 
@@ -0,0 +1,264 @@
+#include "channelmetrics.h"
+
+#include <QtGlobal>
+
+/**
+ * @brief ChannelMetrics::ChannelMetrics
+ * @param bandwidth   : The bandwidth of the OFDM channel (in Hz)
+ * @param subcarriers : The number of subcarriers of the channel
+ */
+ChannelMetrics::ChannelMetrics(double bandwidth, int subcarriers)
+{
+    m_bandwidth = bandwidth;
+    m_subcarriers = max(subcarriers, 1);
+
+    reset();
+}
+
+/**
+ * @brief ChannelMetrics::reset
+ *
+ * This function removes all the ray paths from the metrics
+ */
+void ChannelMetrics::reset() {
+    m_paths_count = 0;
+    m_power_sum = 0;
+    m_delay_sum = 0;
+    m_delay2_sum = 0;
+    m_batch_size = 0;
+
+    m_pdp.assign(PDP_BINS_COUNT, 0.0);
+    m_h_re.assign(m_subcarriers, 0.0);
+    m_h_im.assign(m_subcarriers, 0.0);
+}
+
+/**
+ * @brief ChannelMetrics::addPath
+ * @param amplitude : The complex amplitude of the ray path at the receiver (|amplitude|² = power)
+ * @param delay     : The propagation delay of the ray path (in seconds)
+ *
+ * This function adds a ray path to the metrics
+ */
+void ChannelMetrics::addPath(complex amplitude, double delay) {
+    const double power = norm(amplitude);
+
+    m_paths_count++;
+    m_power_sum += power;
+    m_delay_sum += power * delay;
+    m_delay2_sum += power * delay * delay;
+
+    // The last bin also contains the longer delays
+    const int bin = min((int) (delay / PDP_BIN_WIDTH), PDP_BINS_COUNT - 1);
+    m_pdp[bin] += power;
+
+    // Phase shift of the ray path at the first subcarrier, and between two subcarriers
+    // (relative to the carrier frequency, already in the amplitude)
+    const complex z = amplitude * exp(-2i * M_PI * subcarrierOffset(0) * delay);
+    const complex w = exp(-2i * M_PI * (m_bandwidth / m_subcarriers) * delay);
+
+    m_z_re[m_batch_size] = z.real();
+    m_z_im[m_batch_size] = z.imag();
+    m_w_re[m_batch_size] = w.real();
+    m_w_im[m_batch_size] = w.imag();
+    m_batch_size++;
+
+    if (m_batch_size == CHANNEL_PATHS_BATCH) {
+        flushBatch();
+    }
+}
+
+/**
+ * @brief ChannelMetrics::flushBatch
+ *
+ * This function adds the buffered ray paths to the frequency response
+ * (kernel over the subcarriers and the ray paths of the batch)
+ */
+void ChannelMetrics::flushBatch() {
+    const int n = m_batch_size;
+
+    double *z_re = m_z_re;
+    double *z_im = m_z_im;
+    const double *w_re = m_w_re;
+    const double *w_im = m_w_im;
+
+    for (int k = 0 ; k < m_subcarriers ; k++) {
+        double sum_re = 0;
+        double sum_im = 0;
+
+        // Sum the phasors of the ray paths at this subcarrier, and rotate them to the next one
+        for (int p = 0 ; p < n ; p++) {
+            const double re = z_re[p];
+            const double im = z_im[p];
+
+            sum_re += re;
+            sum_im += im;
+
+            z_re[p] = re * w_re[p] - im * w_im[p];
+            z_im[p] = re * w_im[p] + im * w_re[p];
+        }
+
+        m_h_re[k] += sum_re;
+        m_h_im[k] += sum_im;
+    }
+
+    m_batch_size = 0;
+}
+
+/**
+ * @brief ChannelMetrics::finish
+ *
+ * This function adds the last buffered ray paths to the frequency response
+ */
+void ChannelMetrics::finish() {
+    if (m_batch_size > 0) {
+        flushBatch();
+    }
+}
+
+/**
+ * @brief ChannelMetrics::merge
+ * @param other : Finished metrics of other ray paths (same channel)
+ *
+ * This function adds the ray paths of other metrics to these ones
+ */
+void ChannelMetrics::merge(const ChannelMetrics &other) {
+    Q_ASSERT(other.m_batch_size == 0 && other.m_subcarriers == m_subcarriers);
+
+    m_paths_count += other.m_paths_count;
+    m_power_sum += other.m_power_sum;
+    m_delay_sum += other.m_delay_sum;
+    m_delay2_sum += other.m_delay2_sum;
+
+    for (int i = 0 ; i < PDP_BINS_COUNT ; i++) {
+        m_pdp[i] += other.m_pdp[i];
+    }
+
+    for (int k = 0 ; k < m_subcarriers ; k++) {
+        m_h_re[k] += other.m_h_re[k];
+        m_h_im[k] += other.m_h_im[k];
+    }
+}
+
+double ChannelMetrics::bandwidth() const {
+    return m_bandwidth;
+}
+
+int ChannelMetrics::subcarriersCount() const {
+    return m_subcarriers;
+}
+
+/**
+ * @brief ChannelMetrics::subcarrierOffset
+ * @param k : The index of the subcarrier
+ * @return
+ *
+ * Returns the offset of the subcarrier from the center of the channel (in Hz)
+ */
+double ChannelMetrics::subcarrierOffset(int k) const {
+    return (k - m_subcarriers / 2) * (m_bandwidth / m_subcarriers);
+}
+
+int ChannelMetrics::pathsCount() const {
+    return m_paths_count;
+}
+
+/**
+ * @brief ChannelMetrics::totalPower
+ * @return
+ *
+ * Returns the sum of the powers of the ray paths (in Watts)
+ */
+double ChannelMetrics::totalPower() const {
+    return m_power_sum;
+}
+
+/**
+ * @brief ChannelMetrics::meanDelay
+ * @return
+ *
+ * Returns the mean delay of the ray paths, weighted by their powers (in seconds)
+ */
+double ChannelMetrics::meanDelay() const {
+    if (m_power_sum <= 0) {
+        return 0;
+    }
+
+    return m_delay_sum / m_power_sum;
+}
+
+/**
+ * @brief ChannelMetrics::rmsDelaySpread
+ * @return
+ *
+ * Returns the RMS delay spread of the channel (in seconds)
+ */
+double ChannelMetrics::rmsDelaySpread() const {
+    if (m_power_sum <= 0) {
+        return 0;
+    }
+
+    const double mean = meanDelay();
+    return sqrt(max(m_delay2_sum / m_power_sum - mean * mean, 0.0));
+}
+
+/**
+ * @brief ChannelMetrics::delayProfile
+ * @return
+ *
+ * Returns the power delay profile: the power of the ray paths in each delay bin of
+ * PDP_BIN_WIDTH (in Watts)
+ */
+const vector<double> &ChannelMetrics::delayProfile() const {
+    return m_pdp;
+}
+
+/**
+ * @brief ChannelMetrics::frequencyResponse
+ * @param k : The index of the subcarrier
+ * @return
+ *
+ * Returns the complex amplitude received at the subcarrier (|H|² is the power that
+ * would be received if all the power of the emitter were at this frequency)
+ */
+complex ChannelMetrics::frequencyResponse(int k) const {
+    return complex(m_h_re[k], m_h_im[k]);
+}
+
+/**
+ * @brief ChannelMetrics::widebandPower
+ * @return
+ *
+ * Returns the mean received power over the subcarriers (in Watts).
+ * With a single ray path, this is the same as the total power.
+ */
+double ChannelMetrics::widebandPower() const {
+    double power = 0;
+
+    for (int k = 0 ; k < m_subcarriers ; k++) {
+        power += m_h_re[k] * m_h_re[k] + m_h_im[k] * m_h_im[k];
+    }
+
+    return power / m_subcarriers;
+}
+
+/**
+ * @brief ChannelMetrics::capacity
+ * @return
+ *
+ * Returns the capacity of the channel (in Mb/s): the sum of the Shannon capacities
+ * of the subcarriers, with the power of the emitter spread over the subcarriers and
+ * the thermal noise of the receiver in each subcarrier.
+ */
+double ChannelMetrics::capacity() const {
+    const double spacing = m_bandwidth / m_subcarriers;
+    const double noise = NOISE_DENSITY * spacing * pow(10.0, RECEIVER_NOISE_FIGURE / 10.0);
+
+    double capacity = 0;
+
+    for (int k = 0 ; k < m_subcarriers ; k++) {
+        const double power = (m_h_re[k] * m_h_re[k] + m_h_im[k] * m_h_im[k]) / m_subcarriers;
+        capacity += spacing * log2(1.0 + power / noise);
+    }
+
+    return capacity / 1e6;
+}
@@ -0,0 +1,92 @@
+#ifndef CHANNELMETRICS_H
+#define CHANNELMETRICS_H
+
+#include "constants.h"
+
+// Default OFDM channel: 802.11ac channel of 80 MHz (256 subcarriers of 312.5 kHz)
+#define CHANNEL_DEFAULT_BANDWIDTH    80e6
+#define CHANNEL_DEFAULT_SUBCARRIERS  256
+
+// Width and count of the bins of the power delay profile (1 ns up to 1 µs, about 300 m)
+#define PDP_BIN_WIDTH   1e-9
+#define PDP_BINS_COUNT  1024
+
+// Number of ray paths buffered before they are added to the frequency response
+#define CHANNEL_PATHS_BATCH 32
+
+// Thermal noise density (-174 dBm/Hz) and noise figure of the receivers (in dB)
+const double NOISE_DENSITY = 3.98107e-21;   // [W/Hz]
+#define RECEIVER_NOISE_FIGURE 7.0
+
+
+/**
+ * This class computes the wideband metrics of the channel from an emitter to a receiver,
+ * from the ray paths given one by one (they are not stored):
+ *  - the power delay profile, as a histogram of the powers of the ray paths by delay,
+ *  - the mean delay and the RMS delay spread (from running sums of the powers),
+ *  - the frequency response H(f) at each subcarrier of an OFDM channel, centered on
+ *    the frequency of the emitter (the coefficients of the walls are the ones of this
+ *    frequency, so the response is valid for a channel much narrower than the carrier).
+ *
+ * The complex amplitude of a ray path is the one of its voltage at the receiver, scaled so
+ * its squared modulus is the power of the ray path. The ray paths are added to H(f) by
+ * batches: the phase of each ray path at each subcarrier is computed by rotating its
+ * phasor by a constant step, so the inner loop over the ray paths of a batch only
+ * contains independent multiplications and additions.
+ *
+ * The metrics of several ranges of ray paths can be merged (all of them are sums).
+ * The results are only complete after finish().
+ */
+class ChannelMetrics
+{
+public:
+    ChannelMetrics(double bandwidth = CHANNEL_DEFAULT_BANDWIDTH, int subcarriers = CHANNEL_DEFAULT_SUBCARRIERS);
+
+    void reset();
+    void addPath(complex amplitude, double delay);
+    void finish();
+    void merge(const ChannelMetrics &other);
+
+    double bandwidth() const;
+    int subcarriersCount() const;
+    double subcarrierOffset(int k) const;
+
+    int pathsCount() const;
+    double totalPower() const;
+    double meanDelay() const;
+    double rmsDelaySpread() const;
+    const vector<double> &delayProfile() const;
+
+    complex frequencyResponse(int k) const;
+    double widebandPower() const;
+    double capacity() const;
+
+private:
+    void flushBatch();
+
+    double m_bandwidth;
+    int m_subcarriers;
+
+    int m_paths_count;
+
+    // Sums of the powers, of the powers times the delays, and times the squared delays
+    double m_power_sum;
+    double m_delay_sum;
+    double m_delay2_sum;
+
+    vector<double> m_pdp;
+
+    // Frequency response (real and imaginary parts at each subcarrier)
+    vector<double> m_h_re;
+    vector<double> m_h_im;
+
+    // Ray paths not yet added to the frequency response: phasor at the first
+    // subcarrier and rotation between two subcarriers
+    int m_batch_size;
+    double m_z_re[CHANNEL_PATHS_BATCH];
+    double m_z_im[CHANNEL_PATHS_BATCH];
+    double m_w_re[CHANNEL_PATHS_BATCH];
+    double m_w_im[CHANNEL_PATHS_BATCH];
+};
+
+#endif // CHANNELMETRICS_H
@@ -0,0 +1,793 @@
+#include "compiledscene.h"
+#include "materials.h"
+
+#include <QLine>
+#include <QCryptographicHash>
+
+// Flags stored in the wall sides matrix
+#define SIDE_POSITIVE 0x1
+#define SIDE_NEGATIVE 0x2
+
+// Number of sampled angles per step of the reflection estimate table
+#define REFLECTION_BOUND_SAMPLES 8
+
+
+/**
+ * @brief MaterialCoefficients::reflection
+ * @param theta_i : The incidence angle (to the normal of the wall)
+ * @return
+ *
+ * This function computes the reflection coefficient of a wall of this material.
+ * The coefficient returned is 3-dimensionnal:
+ *  - the two first components are the same and are the coefficient
+ *    for a parallel polarization
+ *  - the last component is the coefficient for the othogonal polarization
+ */
+cvector3 MaterialCoefficients::reflection(double theta_i) const {
+    const complex Z1 = Z_0;
+
+    // Compute the incident and transmission angles (Snell's law)
+    const double sin_i = sin(theta_i);
+    const double cos_i = cos(theta_i);
+    const double sin_t = z_ratio * sin_i;
+    const double cos_t = sqrt(1.0 - sin_t*sin_t);
+
+    // Length of the travel of the ray in the wall
+    const double s = thickness / cos_t;
+
+    // Compute the reflection coefficient for an orthogonal
+    // polarization (equation 8.39)
+    const complex Gamma_orth = (Z2*cos_i - Z1*cos_t) / (Z2*cos_i + Z1*cos_t);
+    // Compute the reflection coefficient for a parallel
+    // polarization (equation 8.32)
+    const complex Gamma_para = (Z2*cos_t - Z1*cos_i) / (Z2*cos_t + Z1*cos_i);
+
+    // Phase term of the multiple reflections in the wall (same for both polarizations)
+    const complex phase = exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin_t * sin_i);
+
+    // Compute the reflection coefficient for the orthogonal polarization (equation 8.43)
+    const complex Gamma_orth_2 = Gamma_orth*Gamma_orth;
+    complex reflection_orth =
+            Gamma_orth +
+            (1.0 - Gamma_orth_2) * Gamma_orth * phase /
+            (1.0 - Gamma_orth_2 * phase);
+
+    // Compute the reflection coefficient for the parallel polarization (equation 8.43)
+    const complex Gamma_para_2 = Gamma_para*Gamma_para;
+    complex reflection_para =
+            Gamma_para +
+            (1.0 - Gamma_para_2) * Gamma_para * phase /
+            (1.0 - Gamma_para_2 * phase);
+
+    // Return as a 3-D vector
+    return cvector3(
+        reflection_para,
+        reflection_para,
+        reflection_orth
+    );
+}
+
+/**
+ * @brief MaterialCoefficients::transmission
+ * @param theta_i : The incidence angle (to the normal of the wall)
+ * @return
+ *
+ * This function computes the transmission coefficient through a wall of this material.
+ * The coefficient returned is 3-dimensionnal (same as the reflection coefficient).
+ */
+cvector3 MaterialCoefficients::transmission(double theta_i) const {
+    const complex Z1 = Z_0;
+
+    // Compute the incident and transmission angles (Snell's law)
+    const double sin_i = sin(theta_i);
+    const double cos_i = cos(theta_i);
+    const double sin_t = z_ratio * sin_i;
+    const double cos_t = sqrt(1.0 - sin_t*sin_t);
+
+    // Length of the travel of the ray in the wall
+    const double s = thickness / cos_t;
+
+    // Compute the reflection coefficient for an orthogonal polarization (equation 8.39).
+    // The transmission coefficient is deduced from the reflection coefficient (equation 8.37).
+    const complex Gamma_orth = (Z2*cos_i-Z1*cos_t)/(Z2*cos_i+Z1*cos_t);
+
+    // Compute the reflection coefficient for a parallel polarization (equation 8.32)
+    const complex Gamma_para = (Z2*cos_t-Z1*cos_i)/(Z2*cos_t+Z1*cos_i);
+
+    // Attenuation through the wall and phase term of the multiple
+    // reflections in the wall (same for both polarizations)
+    const complex attenuation = exp(-gamma_m*s);
+    const complex phase = exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin_t * sin_i);
+
+    // Compute the transmission coefficient for the orthogonal polarization (equation 8.44)
+    const complex Gamma_orth_2 = Gamma_orth*Gamma_orth;
+    complex transmission_orth =
+            (1.0 - Gamma_orth_2) * attenuation /
+            (1.0 - Gamma_orth_2 * phase);
+
+    // Compute the transmission coefficient for the parallel polarization (equation 8.44)
+    const complex Gamma_para_2 = Gamma_para*Gamma_para;
+    complex transmission_para =
+            (1.0 - Gamma_para_2) * attenuation /
+            (1.0 - Gamma_para_2 * phase);
+
+    // Return as a 3-D vector
+    return cvector3(
+        transmission_para,
+        transmission_para,
+        transmission_orth
+    );
+}
+
+/**
+ * @brief CompiledWall::mirror
+ *
+ * This function returns the coordinates of the image of the point 'p'
+ * after an axial symmetry through the wall (precomputed matrix multiplication).
+ *
+ * @param p : The position of the source whose image is calculated
+ * @return  : The coordinates of the image
+ */
+QPointF CompiledWall::mirror(const QPointF &p) const {
+    return QPointF(m11*p.x() + m12*p.y(), m21*p.x() + m22*p.y()) + offset;
+}
+
+/**
+ * @brief CompiledWall::normalAngleTo
+ * @param ray
+ * @return
+ *
+ * This function returns the angle made by the 'ray' to the normal of the wall.
+ * This angle is defined as 0 <= theta <= PI/2 (in radians)
+ */
+double CompiledWall::normalAngleTo(const QLineF &ray) const {
+    const double length = ray.length();
+
+    // Avoid the division by 0 (a null ray is a normal incidence)
+    if (length == 0.0) {
+        return 0.0;
+    }
+
+    // The cosine of the angle is the projection of the ray on the normal
+    double cos_theta = fabs(ray.dx()*normal.x() + ray.dy()*normal.y()) / length;
+
+    return acos(min(cos_theta, 1.0));
+}
+
+/**
+ * @brief CompiledWall::side
+ * @param p
+ * @return
+ *
+ * This function returns the signed distance from the point 'p' to the line of the wall.
+ * The sign tells on which side of the wall the point is (positive along the normal).
+ */
+double CompiledWall::side(const QPointF &p) const {
+    return (p.x() - line.p1().x()) * normal.x() + (p.y() - line.p1().y()) * normal.y();
+}
+
+/**
+ * @brief CompiledWall::crossedBy
+ * @param a
+ * @param b
+ * @return
+ *
+ * This function is a cheap test that returns true if the segment [a,b] crosses the wall
+ * (on the wall itself, not on its extension). The two points must be strictly on both
+ * sides of the wall.
+ */
+bool CompiledWall::crossedBy(const QPointF &a, const QPointF &b) const {
+    const double side_a = side(a);
+    const double side_b = side(b);
+
+    // The two points must be on both sides of the wall
+    if (side_a * side_b >= 0) {
+        return false;
+    }
+
+    // Intersection of the segment with the line of the wall
+    const QPointF pt = a + (b - a) * (side_a / (side_a - side_b));
+
+    // Position of the intersection along the wall (0 at p1, 1 at p2)
+    const double dx = line.dx();
+    const double dy = line.dy();
+    const double t = ((pt.x() - line.p1().x()) * dx + (pt.y() - line.p1().y()) * dy) / (dx*dx + dy*dy);
+
+    return t >= 0.0 && t <= 1.0;
+}
+
+/**
+ * @brief CompiledWall::maxIncidenceAngle
+ * @param source
+ * @return
+ *
+ * This function returns the largest incidence angle (to the normal) of a ray
+ * going from the 'source' to any point of the wall.
+ */
+double CompiledWall::maxIncidenceAngle(const QPointF &source) const {
+    // Unit vector along the wall
+    const QPointF u(normal.y(), -normal.x());
+
+    // Distances from the source to the wall's ends, along and across the wall
+    const QPointF d1 = line.p1() - source;
+    const QPointF d2 = line.p2() - source;
+    const double along = max(fabs(d1.x()*u.x() + d1.y()*u.y()), fabs(d2.x()*u.x() + d2.y()*u.y()));
+
+    return atan2(along, fabs(side(source)));
+}
+
+/**
+ * @brief CompiledEmitter::incidentRayAngle
+ * @param ray
+ * @return
+ *
+ * Returns the incidence angle of the ray to the emitter (in radians).
+ * This function assumes the ray comes out the emitter.
+ */
+double CompiledEmitter::incidentRayAngle(const QLineF &ray) const {
+    double ray_angle = ray.angle() / 180.0 * M_PI;
+    return ray_angle - antenna->getRotation();
+}
+
+/**
+ * @brief CompiledEmitter::getGain
+ * @param phi
+ * @return
+ *
+ * Returns the gain of the emitter's antenna in the plane θ = π/2
+ */
+double CompiledEmitter::getGain(double phi) const {
+    return antenna->getGain(M_PI_2, phi);
+}
+
+/**
+ * @brief CompiledReceiver::incidentRayAngle
+ * @param ray
+ * @return
+ *
+ * Returns the incidence angle of the ray to the receiver (in radians)
+ * This function assumes the ray comes into the receiver.
+ */
+double CompiledReceiver::incidentRayAngle(const QLineF &ray) const {
+    double ray_angle = ray.angle() / 180.0 * M_PI - M_PI;
+    return ray_angle - rotation;
+}
+
+/**
+ * @brief CompiledReceiver::getEffectiveHeight
+ * @param phi
+ * @param frequency
+ * @return
+ *
+ * Returns the effective height of the receiver's antenna in the plane θ = π/2
+ */
+cvector3 CompiledReceiver::getEffectiveHeight(double phi, double frequency) const {
+    return antenna->getEffectiveHeight(M_PI_2, phi, frequency);
+}
+
+
+
+CompiledScene::CompiledScene()
+{
+    m_reflections_count = 0;
+}
+
+CompiledScene::~CompiledScene()
+{
+    // Delete the private copies of the antennas
+    for (const CompiledEmitter &e : m_emitters) {
+        delete e.antenna;
+    }
+    for (const CompiledReceiver &r : m_receivers) {
+        delete r.antenna;
+    }
+}
+
+/**
+ * @brief CompiledScene::addWall
+ * @param line      : The line of the wall (in meters)
+ * @param e_r       : The relative permittivity of the wall
+ * @param sigma     : The conductivity of the wall
+ * @param thickness : The thickness of the wall (in meters)
+ * @return          : The index of the new wall
+ *
+ * This function adds a wall to the scene and precomputes its reflection transform
+ */
+int CompiledScene::addWall(QLineF line, double e_r, double sigma, double thickness) {
+    CompiledWall w;
+    w.line = line;
+    w.material = materialIndex(e_r, sigma, thickness);
+
+    // Unit vector along the wall
+    const double length = line.length();
+    const double ux = (length > 0 ? line.dx() / length : 1.0);
+    const double uy = (length > 0 ? line.dy() / length : 0.0);
+
+    w.normal = QPointF(-uy, ux);
+
+    // Reflection matrix over a line of direction (ux,uy) passing through the origin
+    w.m11 = 2*ux*ux - 1;
+    w.m12 = 2*ux*uy;
+    w.m21 = 2*ux*uy;
+    w.m22 = 2*uy*uy - 1;
+
+    // The line passes through p1, so translate the origin on p1
+    const QPointF p1 = line.p1();
+    w.offset = p1 - QPointF(w.m11*p1.x() + w.m12*p1.y(), w.m21*p1.x() + w.m22*p1.y());
+
+    m_walls.push_back(w);
+    return (int) m_walls.size() - 1;
+}
+
+/**
+ * @brief CompiledScene::addEmitter
+ * @param pos       : The position of the emitter (in meters)
+ * @param frequency : The frequency of the emitter
+ * @param power     : The power of the emitter
+ * @param antenna   : The antenna of the emitter (a private copy is made)
+ * @return          : The index of the new emitter
+ */
+int CompiledScene::addEmitter(QPointF pos, double frequency, double power, const Antenna *antenna) {
+    CompiledEmitter e;
+    e.position = pos;
+    e.frequency = frequency;
+    e.power = power;
+    e.frequency_index = frequencyIndex(frequency);
+    e.antenna = antenna->clone();
+
+    m_emitters.push_back(e);
+    return (int) m_emitters.size() - 1;
+}
+
+/**
+ * @brief CompiledScene::addReceiver
+ * @param pos      : The position of the receiver (in meters)
+ * @param rotation : The rotation angle of the receiver (in radians)
+ * @param antenna  : The antenna of the receiver (a private copy is made)
+ * @return         : The index of the new receiver
+ */
+int CompiledScene::addReceiver(QPointF pos, double rotation, const Antenna *antenna) {
+    CompiledReceiver r;
+    r.position = pos;
+    r.rotation = rotation;
+    r.antenna = antenna->clone();
+
+    m_receivers.push_back(r);
+    return (int) m_receivers.size() - 1;
+}
+
+/**
+ * @brief CompiledScene::finalize
+ *
+ * This function precomputes the data that depends on the whole scene.
+ * It must be called once all walls, emitters and receivers are added.
+ */
+void CompiledScene::finalize() {
+    const int walls_count = (int) m_walls.size();
+
+    // For each couple of walls, look on which sides of the first one the second one lies.
+    // A ray reflected on a wall goes back to the side of its source, so a reflection
+    // towards a wall that has no point on this side is impossible.
+    m_wall_sides.assign(walls_count * walls_count, 0);
+
+    for (int i = 0 ; i < walls_count ; i++) {
+        for (int j = 0 ; j < walls_count ; j++) {
+            if (i == j) {
+                continue;
+            }
+
+            unsigned char flags = 0;
+
+            for (const QPointF &p : {m_walls[j].line.p1(), m_walls[j].line.p2()}) {
+                const double d = m_walls[i].side(p);
+
+                if (d > GEOMETRY_EPSILON) {
+                    flags |= SIDE_POSITIVE;
+                }
+                else if (d < -GEOMETRY_EPSILON) {
+                    flags |= SIDE_NEGATIVE;
+                }
+            }
+
+            m_wall_sides[i * walls_count + j] = flags;
+        }
+    }
+
+    // Get the rectangle containing all the walls, emitters and receivers
+    // (so it contains every ray of the simulation)
+    QRectF bounds;
+    bool first = true;
+
+    auto extend = [&](const QPointF &p) {
+        if (first) {
+            bounds = QRectF(p, p);
+            first = false;
+        }
+        else {
+            bounds.setLeft(min(bounds.left(), p.x()));
+            bounds.setRight(max(bounds.right(), p.x()));
+            bounds.setTop(min(bounds.top(), p.y()));
+            bounds.setBottom(max(bounds.bottom(), p.y()));
+        }
+    };
+
+    for (const CompiledWall &w : m_walls) {
+        extend(w.line.p1());
+        extend(w.line.p2());
+    }
+    for (const CompiledEmitter &e : m_emitters) {
+        extend(e.position);
+    }
+    for (const CompiledReceiver &r : m_receivers) {
+        extend(r.position);
+    }
+
+    // Build the spatial index over the walls
+    m_wall_grid.build(m_walls, bounds);
+
+    // Compute the coefficients of each material at each frequency of the emitters
+    const int freq_count = (int) m_frequencies.size();
+    m_coefficients.resize(m_materials.size() * freq_count);
+
+    for (size_t m = 0 ; m < m_materials.size() ; m++) {
+        const CompiledMaterial &material = m_materials[m];
+
+        for (int f = 0 ; f < freq_count ; f++) {
+            const double omega = m_frequencies[f]*2*M_PI;
+
+            // Compute the properties of the mediums (air and wall)
+            complex epsilon_tilde = material.rel_permitivity*EPSILON_0 - 1i*material.conductivity/omega;
+            complex Z1 = Z_0;
+            complex Z2 = sqrt(MU_0/epsilon_tilde);
+
+            MaterialCoefficients &c = m_coefficients[m * freq_count + f];
+            c.Z2 = Z2;
+            c.gamma_m = 1i*omega*sqrt(MU_0*epsilon_tilde);
+            c.gamma_0 = 1i*omega*sqrt(MU_0*EPSILON_0);
+            c.z_ratio = real(Z2/Z1);
+            c.thickness = material.thickness;
+        }
+    }
+
+    // Estimate the max of the squared reflection coefficients (for both polarizations)
+    // over the incidence angles from 0 to each step of the table. The coefficients are
+    // only sampled, so a narrow peak between two samples can be missed: this is not a
+    // proven bound (the exact sup over [0, π/2] is 1 at grazing incidence).
+    const double step = M_PI_2 / REFLECTION_BOUND_STEPS;
+    m_reflection_bounds.resize(m_coefficients.size() * (REFLECTION_BOUND_STEPS + 1));
+
+    for (size_t c = 0 ; c < m_coefficients.size() ; c++) {
+        double *bounds = &m_reflection_bounds[c * (REFLECTION_BOUND_STEPS + 1)];
+        double bound = 0;
+
+        for (int k = 0 ; k <= REFLECTION_BOUND_STEPS ; k++) {
+            // Sample the angles of the last step (only the angle 0 for the first one)
+            for (int i = (k == 0 ? REFLECTION_BOUND_SAMPLES : 1) ; i <= REFLECTION_BOUND_SAMPLES ; i++) {
+                const double theta = min((k - 1 + (double) i / REFLECTION_BOUND_SAMPLES) * step, M_PI_2);
+                const cvector3 r = m_coefficients[c].reflection(theta);
+
+                bound = max(bound, max(norm(r[0]), norm(r[2])));
+            }
+
+            bounds[k] = min(bound, 1.0);
+        }
+    }
+}
+
+void CompiledScene::setReflectionsCount(int cnt) {
+    m_reflections_count = cnt;
+}
+
+int CompiledScene::reflectionsCount() const {
+    return m_reflections_count;
+}
+
+/**
+ * @brief CompiledScene::contentHash
+ * @return
+ *
+ * This function returns a hash of everything that changes the results of a simulation
+ * of this scene: the walls, the emitters, the receivers (in the order they were added),
+ * the reflections count and the version of the engine (ENGINE_VERSION).
+ */
+QByteArray CompiledScene::contentHash() const {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << (qint32) ENGINE_VERSION;
+    out << (qint32) m_reflections_count;
+    out << itemsHash();
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/**
+ * @brief CompiledScene::itemsHash
+ * @return
+ *
+ * This function returns a hash of the walls, the emitters and the receivers of this
+ * scene (in the order they were added), without the reflections count.
+ */
+QByteArray CompiledScene::itemsHash() const {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << (quint64) m_walls.size();
+    for (const CompiledWall &w : m_walls) {
+        const CompiledMaterial &m = m_materials[w.material];
+        out << w.line << m.rel_permitivity << m.conductivity << m.thickness;
+    }
+
+    out << (quint64) m_emitters.size();
+    for (const CompiledEmitter &e : m_emitters) {
+        out << e.position << e.frequency << e.power;
+        out << (qint32) e.antenna->getAntennaType() << e.antenna->getEfficiency() << e.antenna->getRotation();
+    }
+
+    out << (quint64) m_receivers.size();
+    for (const CompiledReceiver &r : m_receivers) {
+        out << r.position << r.rotation;
+        out << (qint32) r.antenna->getAntennaType() << r.antenna->getEfficiency();
+    }
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+const vector<CompiledWall> &CompiledScene::getWalls() const {
+    return m_walls;
+}
+
+const vector<CompiledMaterial> &CompiledScene::getMaterials() const {
+    return m_materials;
+}
+
+const vector<CompiledEmitter> &CompiledScene::getEmitters() const {
+    return m_emitters;
+}
+
+const vector<CompiledReceiver> &CompiledScene::getReceivers() const {
+    return m_receivers;
+}
+
+/**
+ * @brief CompiledScene::getCoefficients
+ * @param material        : The index of the material
+ * @param frequency_index : The index of the frequency (from the emitter)
+ * @return
+ *
+ * This function returns the precomputed coefficients of the material at this frequency.
+ */
+const MaterialCoefficients &CompiledScene::getCoefficients(int material, int frequency_index) const {
+    return m_coefficients[material * m_frequencies.size() + frequency_index];
+}
+
+/**
+ * @brief CompiledScene::reflectionBound
+ * @param material        : The index of the material
+ * @param frequency_index : The index of the frequency (from the emitter)
+ * @param theta_max       : The largest possible incidence angle on the wall
+ * @return
+ *
+ * This function returns an estimate of the max of the squared modulus of the reflection
+ * coefficient of the material, for the incidence angles from 0 to 'theta_max'
+ * (max over sampled angles, never more than 1).
+ */
+double CompiledScene::reflectionBound(int material, int frequency_index, double theta_max) const {
+    const int step = min((int) ceil(theta_max / M_PI_2 * REFLECTION_BOUND_STEPS), REFLECTION_BOUND_STEPS);
+    const size_t c = material * m_frequencies.size() + frequency_index;
+
+    return m_reflection_bounds[c * (REFLECTION_BOUND_STEPS + 1) + max(step, 0)];
+}
+
+/**
+ * @brief CompiledScene::mirror
+ *
+ * This function returns the coordinates of the image of the 'source' point
+ * after an axial symmetry through the wall.
+ *
+ * @param source : The position of the source whose image is calculated
+ * @param wall   : The index of the wall over which compute the image
+ * @return       : The coordinates of the image
+ */
+QPointF CompiledScene::mirror(QPointF source, int wall) const {
+    return m_walls[wall].mirror(source);
+}
+
+/**
+ * @brief CompiledScene::canReachWall
+ * @param from_wall     : The index of the wall on which the ray is reflected
+ * @param to_wall       : The index of the wall of the next reflection
+ * @param positive_side : The side of 'from_wall' where is the source of the ray
+ * @return
+ *
+ * This function returns false if a ray reflected on 'from_wall' can never reach 'to_wall'
+ * (all the 'to_wall' is behind the 'from_wall' as seen from the source).
+ */
+bool CompiledScene::canReachWall(int from_wall, int to_wall, bool positive_side) const {
+    const unsigned char flags = m_wall_sides[from_wall * m_walls.size() + to_wall];
+    return flags & (positive_side ? SIDE_POSITIVE : SIDE_NEGATIVE);
+}
+
+/**
+ * @brief CompiledScene::segmentWalls
+ * @param segment : The segment (in meters)
+ * @param walls   : The list to fill with the indexes of the walls (sorted)
+ *
+ * This function gets the walls that may intersect the segment, using the spatial index.
+ */
+void CompiledScene::segmentWalls(const QLineF &segment, vector<int> *walls) const {
+    m_wall_grid.segmentCandidates(segment, walls);
+}
+
+/**
+ * @brief CompiledScene::materialIndex
+ * @return
+ *
+ * This function returns the index of the material with these properties,
+ * and adds it to the materials list if not already known.
+ */
+int CompiledScene::materialIndex(double e_r, double sigma, double thickness) {
+    for (size_t i = 0 ; i < m_materials.size() ; i++) {
+        const CompiledMaterial &m = m_materials[i];
+
+        if (m.rel_permitivity == e_r && m.conductivity == sigma && m.thickness == thickness) {
+            return (int) i;
+        }
+    }
+
+    m_materials.push_back({e_r, sigma, thickness});
+    return (int) m_materials.size() - 1;
+}
+
+/**
+ * @brief CompiledScene::addFrequency
+ * @param frequency
+ * @return
+ *
+ * This function adds a frequency without emitter (for a frequency sweep), so the
+ * coefficients of the materials are also computed at this frequency by finalize().
+ * It returns the index of this frequency.
+ */
+int CompiledScene::addFrequency(double frequency) {
+    return frequencyIndex(frequency);
+}
+
+/**
+ * @brief CompiledScene::getFrequencyIndex
+ * @param frequency
+ * @return
+ *
+ * This function returns the index of a frequency of the scene (-1 if unknown)
+ */
+int CompiledScene::getFrequencyIndex(double frequency) const {
+    for (size_t i = 0 ; i < m_frequencies.size() ; i++) {
+        if (m_frequencies[i] == frequency) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief CompiledScene::frequencyIndex
+ * @return
+ *
+ * This function returns the index of this frequency,
+ * and adds it to the frequencies list if not already known.
+ */
+int CompiledScene::frequencyIndex(double frequency) {
+    const int index = getFrequencyIndex(frequency);
+
+    if (index >= 0) {
+        return index;
+    }
+
+    m_frequencies.push_back(frequency);
+    return (int) m_frequencies.size() - 1;
+}
+
+
+QDataStream &operator>>(QDataStream &in, CompiledScene *scene) {
+    // Read the items in the same format as the SimulationData (walls, emitters, receivers),
+    // without creating any graphics item. The positions are saved in pixels.
+    quint32 count;
+
+    in >> count;
+
+    for (quint32 i = 0 ; i < count && in.status() == QDataStream::Ok ; i++) {
+        int type;
+        double thickness;
+        QLine line;
+
+        in >> type;
+        in >> thickness;
+        in >> line;
+
+        double e_r, sigma;
+
+        switch (type) {
+        case WallType::BrickWall:
+            e_r = BRICK_R_PERMITTIVITY;
+            sigma = BRICK_CONDUCTIVITY;
+            break;
+        case WallType::ConcreteWall:
+            e_r = CONCRETE_R_PERMITTIVITY;
+            sigma = CONCRETE_CONDUCTIVITY;
+            break;
+        case WallType::PartitionWall:
+            e_r = PARTITION_R_PERMITTIVITY;
+            sigma = PARTITION_CONDUCTIVITY;
+            break;
+        default:
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+
+        scene->addWall(
+                    QLineF(QPointF(line.p1()) / SIMULATION_SCALE, QPointF(line.p2()) / SIMULATION_SCALE),
+                    e_r,
+                    sigma,
+                    thickness);
+    }
+
+    in >> count;
+
+    for (quint32 i = 0 ; i < count && in.status() == QDataStream::Ok ; i++) {
+        Antenna *ant = nullptr;
+        double power;
+        double frequency;
+        double rotation;
+        QPoint pos;
+
+        in >> ant;
+        in >> power;
+        in >> frequency;
+        in >> rotation;
+        in >> pos;
+
+        // A truncated or corrupt file stops the reading (no emitter is added)
+        if (in.status() != QDataStream::Ok || ant == nullptr) {
+            delete ant;
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+
+        ant->setRotation(rotation);
+        scene->addEmitter(QPointF(pos) / SIMULATION_SCALE, frequency, power, ant);
+
+        delete ant;
+    }
+
+    in >> count;
+
+    for (quint32 i = 0 ; i < count && in.status() == QDataStream::Ok ; i++) {
+        Antenna *ant = nullptr;
+        QPoint pos;
+
+        in >> ant;
+        in >> pos;
+
+        if (in.status() != QDataStream::Ok || ant == nullptr) {
+            delete ant;
+            in.setStatus(QDataStream::ReadCorruptData);
+            return in;
+        }
+
+        // The map files don't save the rotation of the receivers, so they have
+        // the rotation of the Receiver items (incidence to top)
+        scene->addReceiver(QPointF(pos) / SIMULATION_SCALE, RECEIVER_ROTATION, ant);
+
+        delete ant;
+    }
+
+    int max_refl_count;
+    int sim_type;
+
+    in >> max_refl_count;
+    in >> sim_type;
+
+    scene->setReflectionsCount(max_refl_count);
+
+    return in;
+}
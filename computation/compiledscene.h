@@ -0,0 +1,155 @@
+#ifndef COMPILEDSCENE_H
+#define COMPILEDSCENE_H
+
+#include <QPointF>
+#include <QLineF>
+#include <QDataStream>
+
+#include "constants.h"
+#include "antennas.h"
+#include "wallgrid.h"
+
+// Distance (in meters) under which a point is considered on a wall's line
+#define GEOMETRY_EPSILON 1e-9
+
+// Number of steps of the reflection estimate table (over the incidence angles from 0 to π/2)
+#define REFLECTION_BOUND_STEPS 90
+
+// Properties of a wall material (one per distinct type/thickness couple)
+struct CompiledMaterial
+{
+    double rel_permitivity;
+    double conductivity;
+    double thickness;
+};
+
+// Coefficients of a material at a frequency (they don't depend on the incidence angle)
+struct MaterialCoefficients
+{
+    complex Z2;         // Impedance of the wall
+    complex gamma_m;    // Propagation constant in the wall
+    complex gamma_0;    // Propagation constant in the air
+    double z_ratio;     // real(Z2/Z1), for the Snell's law
+    double thickness;
+
+    cvector3 reflection(double theta_i) const;
+    cvector3 transmission(double theta_i) const;
+};
+
+// Read-only copy of a wall (all distances in meters)
+struct CompiledWall
+{
+    QLineF line;        // The wall's line
+    QPointF normal;     // Unit vector normal to the wall
+
+    // Reflection transform over the wall's line: image = M * point + offset
+    double m11, m12;
+    double m21, m22;
+    QPointF offset;
+
+    int material;       // Index in the materials list
+
+    QPointF mirror(const QPointF &p) const;
+    double normalAngleTo(const QLineF &ray) const;
+    double side(const QPointF &p) const;
+    bool crossedBy(const QPointF &a, const QPointF &b) const;
+    double maxIncidenceAngle(const QPointF &source) const;
+};
+
+// Read-only copy of an emitter (position in meters)
+struct CompiledEmitter
+{
+    QPointF position;
+    double frequency;
+    double power;
+    int frequency_index;  // Index in the frequencies list
+    const Antenna *antenna;   // Private copy of the emitter's antenna
+
+    double incidentRayAngle(const QLineF &ray) const;
+    double getGain(double phi) const;
+};
+
+// Read-only copy of a receiver (position in meters)
+struct CompiledReceiver
+{
+    QPointF position;
+    double rotation;
+    const Antenna *antenna;   // Private copy of the receiver's antenna
+
+    double incidentRayAngle(const QLineF &ray) const;
+    cvector3 getEffectiveHeight(double phi, double frequency) const;
+};
+
+
+/**
+ * This class is a flat snapshot of the simulation scene, built once when a simulation starts.
+ * The computation threads only read from this object, so they never touch the graphics
+ * items (which can be edited by the GUI thread while the simulation is running).
+ *
+ * It doesn't depend on the graphics items, so a scene can also be built directly
+ * (add the walls, emitters and receivers, then finalize) or read from a map file.
+ */
+class CompiledScene
+{
+public:
+    CompiledScene();
+    ~CompiledScene();
+
+    int addWall(QLineF line, double e_r, double sigma, double thickness);
+    int addEmitter(QPointF pos, double frequency, double power, const Antenna *antenna);
+    int addReceiver(QPointF pos, double rotation, const Antenna *antenna);
+    int addFrequency(double frequency);
+
+    void finalize();
+
+    void setReflectionsCount(int cnt);
+    int reflectionsCount() const;
+
+    QByteArray contentHash() const;
+    QByteArray itemsHash() const;
+
+    const vector<CompiledWall> &getWalls() const;
+    const vector<CompiledMaterial> &getMaterials() const;
+    const vector<CompiledEmitter> &getEmitters() const;
+    const vector<CompiledReceiver> &getReceivers() const;
+
+    int getFrequencyIndex(double frequency) const;
+    const MaterialCoefficients &getCoefficients(int material, int frequency_index) const;
+    double reflectionBound(int material, int frequency_index, double theta_max) const;
+
+    QPointF mirror(QPointF source, int wall) const;
+    bool canReachWall(int from_wall, int to_wall, bool positive_side) const;
+    void segmentWalls(const QLineF &segment, vector<int> *walls) const;
+
+private:
+    Q_DISABLE_COPY(CompiledScene)
+
+    int materialIndex(double e_r, double sigma, double thickness);
+    int frequencyIndex(double frequency);
+
+    vector<CompiledWall> m_walls;
+    vector<CompiledMaterial> m_materials;
+    vector<CompiledEmitter> m_emitters;
+    vector<CompiledReceiver> m_receivers;
+    vector<double> m_frequencies;
+
+    // Coefficients of each material (rows) at each frequency (columns)
+    vector<MaterialCoefficients> m_coefficients;
+
+    // Estimated max of the squared reflection coefficient over the incidence angles [0, theta]
+    // for each material and frequency (same order as the coefficients, sampled angles)
+    vector<double> m_reflection_bounds;
+
+    // Flags telling on which sides of a wall (rows) another wall (columns) lies
+    vector<unsigned char> m_wall_sides;
+
+    // Spatial index over the walls
+    WallGrid m_wall_grid;
+
+    int m_reflections_count;
+};
+
+// Operator overload to read a scene from a map file (the scene must be finalized after)
+QDataStream &operator>>(QDataStream &in, CompiledScene *scene);
+
+#endif // COMPILEDSCENE_H
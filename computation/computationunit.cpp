@@ -1,16 +1,13 @@
 #include "computationunit.h"
 #include "simulationhandler.h"
 
-ComputationUnit::ComputationUnit(SimulationHandler *h, Emitter *e, Receiver *r, Wall *w) :
+ComputationUnit::ComputationUnit(SimulationHandler *h) :
     QObject(h), QRunnable()
 {
     // Don't delete the computation unit when finished
     setAutoDelete(false);
 
     m_handler = h;
-    m_emitter = e;
-    m_receiver = r;
-    m_wall = w;
 
     // Mark this CU as stopped
     m_running = false;
@@ -20,10 +17,15 @@ bool ComputationUnit::isRunning() {
     return m_running;
 }
 
+ComputationResults &ComputationUnit::getResults() {
+    return m_results;
+}
+
 /**
  * @brief ComputationUnit::run
  *
- * This function is called when a thread is ready to run it
+ * This function is called when a thread is ready to run it.
+ * It computes chunks of work from the simulation handler until there is no more work.
  */
 void ComputationUnit::run() {
     // Mark this CU as running
@@ -32,8 +34,15 @@ void ComputationUnit::run() {
     // Emit computation started signal
     emit computationStarted();
 
-    // Compute the reflections recursively
-    m_handler->recursiveReflection(m_emitter, m_receiver, m_wall);
+    qint64 first, last;
+
+    // Take the next chunk of work and compute it
+    while (m_handler->nextWorkChunk(&first, &last)) {
+        m_handler->computeWorkChunk(first, last, &m_results);
+
+        // Emit computation progress signal
+        emit computationProgress();
+    }
 
     // Mark this CU as stopped
     m_running = false;
@@ -3,34 +3,92 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <QRectF>
+#include <QLineF>
 
 #include "simulationdata.h"
+#include "propagationmodel.h"
 
 
 class SimulationHandler;
+class RayPath;
+
+// Ray path computed by a computation unit, with the index of its work item
+// (its lines are in the lines of the results, the RayPath object is created by the handler)
+struct ComputedRayPath
+{
+    qint64 item;
+    int receiver;
+    int emitter;
+    double power;
+    int first_ray;
+    int rays_count;
+};
+
+// Sum of the powers of the ray paths of an order computed for a receiver in a range of
+// work items (used instead of the ray paths when only the received power is needed)
+struct ComputedPower
+{
+    qint64 item;
+    int receiver;
+    int order;          // Number of reflections of the ray paths (0 for the direct ray path)
+    double power;
+    int paths_count;
+};
+
+// Ray path computed for the incremental updates of the simulation (kept by the handler)
+struct ComputedPath
+{
+    qint64 item;
+    int receiver;
+    int emitter;
+    int node;           // Node of the emitter's image tree (-1 for a direct or recomputed ray path)
+    int path;           // Index of the recomputed kept path (-1 for a new ray path)
+    double power;
+    PathTerms terms;    // Terms of the power that don't depend on the antennas
+    QRectF bounds;      // Rectangle containing the lines of the ray path
+    vector<QLineF> rays;    // Lines of the ray path
+};
+
+// Results of the computations made by a computation unit
+struct ComputationResults
+{
+    vector<ComputedRayPath> ray_paths;
+    vector<QLineF> rays;    // Lines of all the ray paths, end to end
+    vector<ComputedPower> powers;
+    vector<ComputedPath> paths;
+
+    // Branches of reflections cut by the pruning (and count of their nodes),
+    // and estimated max of their total power at each receiver (in Watts)
+    qint64 pruned_branches = 0;
+    qint64 pruned_nodes = 0;
+    vector<double> pruned_power;
+};
 
 class ComputationUnit : public QObject, public QRunnable
 {
     Q_OBJECT
 
 public:
-    explicit ComputationUnit(SimulationHandler *h, Emitter *e, Receiver *r, Wall *w);
+    explicit ComputationUnit(SimulationHandler *h);
 
     bool isRunning();
     void run() override;
 
+    ComputationResults &getResults();
+
 
 signals:
     void computationStarted();
+    void computationProgress();
     void computationFinished();
 
 private:
-    Emitter *m_emitter;
-    Receiver *m_receiver;
-    Wall *m_wall;
-
     SimulationHandler *m_handler;
     bool m_running;
+
+    // Results of this unit (only accessed by its thread while running)
+    ComputationResults m_results;
 };
 
 #endif // COMPUTATIONUNIT_H
@@ -30,16 +30,51 @@ const double MU_0        = 12.566370614e-7; // [T m/A]
 // Vacuum impedance
 const double Z_0 = sqrt(MU_0/EPSILON_0);  // [Ohm]
 
+// Version of the computation engine, to increment when a change of the engine changes
+// the results of a simulation (it is part of the key of the cached results)
+#define ENGINE_VERSION 2
+
+// Number of pixels per meter (scale of the scene and of the positions saved in the map files)
+#define SIMULATION_SCALE 50.0
+
+// Rotation of the receivers (incidence to top, it is not saved in the map files)
+#define RECEIVER_ROTATION M_PI_2
+
+// Stack-allocated 3-dimensional complex vector (fields, coefficients, effective heights).
+// The missing components are set to 0 (the constructor is explicit, so a complex
+// number is never converted to a vector by mistake).
+struct cvector3
+{
+    complex v[3];
+
+    constexpr cvector3() : v{0, 0, 0} {}
+    explicit constexpr cvector3(complex x, complex y = 0, complex z = 0) : v{x, y, z} {}
+
+    constexpr const complex &operator[](int i) const { return v[i]; }
+    complex &operator[](int i) { return v[i]; }
+};
+
 // Operator overload for vector component to component multiplication.
-// This is only valid for 3-dimensionnal vectors.
-vector<complex> operator*(const vector<complex> v1, const vector<complex> v2) ;
+inline cvector3 operator*(const cvector3 &v1, const cvector3 &v2) {
+    return cvector3(
+        v1[0] * v2[0],
+        v1[1] * v2[1],
+        v1[2] * v2[2]
+    );
+}
 
 // Operator overload for vector component to component multiplication.
-// This is only valid for 3-dimensionnal vectors.
-vector<complex> operator*=(vector<complex> &v1, const vector<complex> v2) ;
+inline cvector3 &operator*=(cvector3 &v1, const cvector3 &v2) {
+    v1[0] *= v2[0];
+    v1[1] *= v2[1];
+    v1[2] *= v2[2];
+    return v1;
+}
 
-// Dot product basic function. Applicable on two 3-dimensional vectors.
-complex dotProduct(const vector<complex> v1, const vector<complex> v2);
+// Dot product basic function.
+inline complex dotProduct(const cvector3 &v1, const cvector3 &v2) {
+    return v1[0]*v2[0] + v1[1]*v2[1] + v1[2]*v2[2];
+}
 
 
 #endif // CONSTANTS_H
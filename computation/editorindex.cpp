@@ -0,0 +1,302 @@
+#include "editorindex.h"
+#include "walls.h"
+
+#include <QSet>
+
+EditorIndex::EditorIndex()
+{
+}
+
+/**
+ * @brief EditorIndex::cellKey
+ * @param cx : The column of the cell
+ * @param cy : The row of the cell
+ * @return
+ *
+ * Returns the key of a cell of the grids
+ */
+qint64 EditorIndex::cellKey(int cx, int cy) {
+    return ((qint64) cx << 32) | (quint32) cy;
+}
+
+/**
+ * @brief EditorIndex::cellsRect
+ * @param rect : A rect of the scene
+ * @return
+ *
+ * Returns the cells of the grids covered by this rect
+ */
+QRect EditorIndex::cellsRect(const QRectF &rect) {
+    const int left   = (int) floor(rect.left() / EDITOR_INDEX_CELL_SIZE);
+    const int top    = (int) floor(rect.top() / EDITOR_INDEX_CELL_SIZE);
+    const int right  = (int) floor(rect.right() / EDITOR_INDEX_CELL_SIZE);
+    const int bottom = (int) floor(rect.bottom() / EDITOR_INDEX_CELL_SIZE);
+
+    return QRect(left, top, right - left + 1, bottom - top + 1);
+}
+
+/**
+ * @brief EditorIndex::insert
+ * @param item
+ *
+ * This function adds an item to the index (and the endpoints of a wall)
+ */
+void EditorIndex::insert(SimulationItem *item) {
+    if (m_items.contains(item)) {
+        return;
+    }
+
+    // Add the item to all the cells covered by its bounding rect
+    const QRect cells = cellsRect(item->sceneBoundingRect());
+
+    for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+        for (int cy = cells.top() ; cy <= cells.bottom() ; cy++) {
+            m_item_cells[cellKey(cx, cy)].append(item);
+        }
+    }
+
+    m_items.insert(item, cells);
+
+    Wall *wall = dynamic_cast<Wall*>(item);
+
+    if (wall) {
+        insertEndpoint(wall->getLine().p1());
+        insertEndpoint(wall->getLine().p2());
+    }
+}
+
+/**
+ * @brief EditorIndex::remove
+ * @param item
+ *
+ * This function removes an item from the index (only from the cells it covers)
+ */
+void EditorIndex::remove(SimulationItem *item) {
+    auto it = m_items.find(item);
+
+    if (it == m_items.end()) {
+        return;
+    }
+
+    const QRect cells = it.value();
+    m_items.erase(it);
+
+    for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+        for (int cy = cells.top() ; cy <= cells.bottom() ; cy++) {
+            auto cell = m_item_cells.find(cellKey(cx, cy));
+
+            if (cell == m_item_cells.end()) {
+                continue;
+            }
+
+            cell.value().removeOne(item);
+
+            if (cell.value().isEmpty()) {
+                m_item_cells.erase(cell);
+            }
+        }
+    }
+
+    Wall *wall = dynamic_cast<Wall*>(item);
+
+    if (wall) {
+        removeEndpoint(wall->getLine().p1());
+        removeEndpoint(wall->getLine().p2());
+    }
+}
+
+/**
+ * @brief EditorIndex::update
+ * @param item
+ *
+ * This function indexes an item again after its bounding rect changed (as an emitter
+ * whose antenna changed). Nothing is done if the item is not in the index.
+ */
+void EditorIndex::update(SimulationItem *item) {
+    if (!m_items.contains(item)) {
+        return;
+    }
+
+    remove(item);
+    insert(item);
+}
+
+/**
+ * @brief EditorIndex::clear
+ *
+ * This function removes all the items from the index
+ */
+void EditorIndex::clear() {
+    m_item_cells.clear();
+    m_items.clear();
+    m_endpoint_cells.clear();
+    m_endpoints_x.clear();
+    m_endpoints_y.clear();
+}
+
+void EditorIndex::insertEndpoint(const QPointF &pt) {
+    const QRect cell = cellsRect(QRectF(pt, pt));
+    m_endpoint_cells[cellKey(cell.left(), cell.top())].append(pt);
+
+    m_endpoints_x[pt.x()]++;
+    m_endpoints_y[pt.y()]++;
+}
+
+void EditorIndex::removeEndpoint(const QPointF &pt) {
+    const QRect cell_rect = cellsRect(QRectF(pt, pt));
+    auto cell = m_endpoint_cells.find(cellKey(cell_rect.left(), cell_rect.top()));
+
+    if (cell != m_endpoint_cells.end()) {
+        cell.value().removeOne(pt);
+
+        if (cell.value().isEmpty()) {
+            m_endpoint_cells.erase(cell);
+        }
+    }
+
+    // Remove the coordinates when no other endpoint has them
+    auto x_it = m_endpoints_x.find(pt.x());
+
+    if (x_it != m_endpoints_x.end() && --x_it.value() == 0) {
+        m_endpoints_x.erase(x_it);
+    }
+
+    auto y_it = m_endpoints_y.find(pt.y());
+
+    if (y_it != m_endpoints_y.end() && --y_it.value() == 0) {
+        m_endpoints_y.erase(y_it);
+    }
+}
+
+/**
+ * @brief EditorIndex::itemsIn
+ * @param rect : A rect of the scene
+ * @return
+ *
+ * Returns the items whose shape intersects this rect (same as QGraphicsScene::items())
+ */
+QList<SimulationItem*> EditorIndex::itemsIn(const QRectF &rect) const {
+    QList<SimulationItem*> items;
+    QSet<SimulationItem*> tested;
+
+    QPainterPath rect_path;
+    rect_path.addRect(rect);
+
+    const QRect cells = cellsRect(rect);
+
+    for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+        for (int cy = cells.top() ; cy <= cells.bottom() ; cy++) {
+            auto cell = m_item_cells.find(cellKey(cx, cy));
+
+            if (cell == m_item_cells.end()) {
+                continue;
+            }
+
+            foreach (SimulationItem *item, cell.value()) {
+                // An item can be in several cells
+                if (tested.contains(item)) {
+                    continue;
+                }
+
+                tested.insert(item);
+
+                if (item->collidesWithPath(item->mapFromScene(rect_path))) {
+                    items.append(item);
+                }
+            }
+        }
+    }
+
+    return items;
+}
+
+/**
+ * @brief EditorIndex::nearestEndpoint
+ * @param pos      : A position in the scene
+ * @param radius   : The max distance of the endpoint
+ * @param endpoint : The nearest endpoint (if one)
+ * @return
+ *
+ * Returns true if an endpoint of a wall is at a distance less than the radius
+ */
+bool EditorIndex::nearestEndpoint(const QPointF &pos, double radius, QPointF *endpoint) const {
+    double min_dist = radius;
+    bool found = false;
+
+    const QRect cells = cellsRect(QRectF(pos.x() - radius, pos.y() - radius, 2 * radius, 2 * radius));
+
+    for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+        for (int cy = cells.top() ; cy <= cells.bottom() ; cy++) {
+            auto cell = m_endpoint_cells.find(cellKey(cx, cy));
+
+            if (cell == m_endpoint_cells.end()) {
+                continue;
+            }
+
+            foreach (const QPointF &pt, cell.value()) {
+                const double dist = QLineF(pos, pt).length();
+
+                if (dist < min_dist) {
+                    min_dist = dist;
+                    *endpoint = pt;
+                    found = true;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief EditorIndex::nearestCoordinate
+ * @param coordinates : The coordinates of the endpoints (x or y)
+ * @param c           : A coordinate
+ * @param radius      : The max distance of the coordinate
+ * @param nearest     : The nearest coordinate (if one)
+ * @return
+ *
+ * Returns true if a coordinate is at a distance less than the radius
+ */
+bool EditorIndex::nearestCoordinate(const QMap<double, int> &coordinates, double c, double radius, double *nearest) {
+    double min_dist = radius;
+    bool found = false;
+
+    for (auto it = coordinates.lowerBound(c - radius) ; it != coordinates.end() && it.key() < c + radius ; ++it) {
+        const double dist = fabs(it.key() - c);
+
+        if (dist < min_dist) {
+            min_dist = dist;
+            *nearest = it.key();
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief EditorIndex::alignedX
+ * @param x         : A x coordinate in the scene
+ * @param radius    : The max distance of the endpoint
+ * @param aligned_x : The x coordinate of the nearest endpoint (if one)
+ * @return
+ *
+ * Returns true if an endpoint of a wall is at a horizontal distance less than the radius
+ */
+bool EditorIndex::alignedX(double x, double radius, double *aligned_x) const {
+    return nearestCoordinate(m_endpoints_x, x, radius, aligned_x);
+}
+
+/**
+ * @brief EditorIndex::alignedY
+ * @param y         : A y coordinate in the scene
+ * @param radius    : The max distance of the endpoint
+ * @param aligned_y : The y coordinate of the nearest endpoint (if one)
+ * @return
+ *
+ * Returns true if an endpoint of a wall is at a vertical distance less than the radius
+ */
+bool EditorIndex::alignedY(double y, double radius, double *aligned_y) const {
+    return nearestCoordinate(m_endpoints_y, y, radius, aligned_y);
+}
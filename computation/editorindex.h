@@ -0,0 +1,64 @@
+#ifndef EDITORINDEX_H
+#define EDITORINDEX_H
+
+#include <QHash>
+#include <QMap>
+#include <QRect>
+#include <QRectF>
+#include <QPointF>
+#include <QList>
+
+#include "interface/simulationitem.h"
+
+// Size of the cells of the grid (in pixels)
+#define EDITOR_INDEX_CELL_SIZE 64
+
+
+/**
+ * This class indexes the items placed in the editor (walls, emitters and receivers),
+ * so the editor doesn't loop over all the items of the scene on each mouse move:
+ *  - a uniform grid gives the items which can intersect a rect (eraser),
+ *  - another grid gives the endpoints of the walls near a point (snapping),
+ *  - two sorted maps give the x and y coordinates of the endpoints near a coordinate
+ *    (alignment guides).
+ *
+ * It is updated by the simulation data when an item is attached or detached, and
+ * when the shape of an item changes (see update()), so the items must not be moved
+ * while they are indexed.
+ */
+class EditorIndex
+{
+public:
+    EditorIndex();
+
+    void insert(SimulationItem *item);
+    void remove(SimulationItem *item);
+    void update(SimulationItem *item);
+    void clear();
+
+    QList<SimulationItem*> itemsIn(const QRectF &rect) const;
+    bool nearestEndpoint(const QPointF &pos, double radius, QPointF *endpoint) const;
+    bool alignedX(double x, double radius, double *aligned_x) const;
+    bool alignedY(double y, double radius, double *aligned_y) const;
+
+private:
+    static qint64 cellKey(int cx, int cy);
+    static QRect cellsRect(const QRectF &rect);
+    static bool nearestCoordinate(const QMap<double, int> &coordinates, double c, double radius, double *nearest);
+
+    void insertEndpoint(const QPointF &pt);
+    void removeEndpoint(const QPointF &pt);
+
+    // Items in each cell of the grid, and cells covered by each item
+    QHash<qint64, QList<SimulationItem*>> m_item_cells;
+    QHash<SimulationItem*, QRect> m_items;
+
+    // Endpoints of the walls in each cell of the grid
+    QHash<qint64, QList<QPointF>> m_endpoint_cells;
+
+    // Number of endpoints at each x and y coordinate
+    QMap<double, int> m_endpoints_x;
+    QMap<double, int> m_endpoints_y;
+};
+
+#endif // EDITORINDEX_H
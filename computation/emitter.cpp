@@ -31,6 +31,8 @@ Emitter::Emitter(
     m_power      = power;
     m_antenna    = antenna;
 
+    m_geometry_valid = false;
+
     // Setup the tooltip
     updateTooltip();
 }
@@ -70,7 +72,10 @@ Emitter* Emitter::clone() {
  * Sets the rotation angle of the emitter (in radians)
  */
 void Emitter::setRotation(double angle) {
+    prepareGeometryChange();
     m_antenna->setRotation(angle);
+    invalidateGeometry();
+    update();
 }
 
 /**
@@ -102,17 +107,20 @@ void Emitter::setAntenna(AntennaType::AntennaType type, double efficiency) {
 }
 
 void Emitter::setAntenna(Antenna *a) {
+    // The geometry depends on the gain of the antenna
+    prepareGeometryChange();
+
     if (m_antenna != nullptr) {
         delete m_antenna;
     }
 
     m_antenna = a;
+    invalidateGeometry();
 
     // Update the tooltip
     updateTooltip();
 
     // Update the graphics
-    prepareGeometryChange();
     update();
 }
 
@@ -158,7 +166,7 @@ double Emitter::getResistance() const {
  * Returns the same as getEffectiveHeight(theta, phi), but with the default angle
  * theta to π/2, since the 2D simulation is in the plane θ = π/2
  */
-vector<complex> Emitter::getEffectiveHeight(double phi) const {
+cvector3 Emitter::getEffectiveHeight(double phi) const {
     return m_antenna->getEffectiveHeight(M_PI_2, phi, m_frequency);
 }
 
@@ -180,7 +188,7 @@ double Emitter::getGain(double phi) const {
  *
  * Returns the antenna's polarization vector
  */
-vector<complex> Emitter::getPolarization() const{
+cvector3 Emitter::getPolarization() const{
     return m_antenna->getPolarization();
 }
 
@@ -217,34 +225,56 @@ void Emitter::updateTooltip() {
  * This function returns a polygon that represent the gain of the emitter around the phi angle
  */
 QPolygonF Emitter::getPolyGain() const {
-    QPolygonF poly_gain;
+    updateGeometry();
+    return m_poly_gain;
+}
+
+void Emitter::invalidateGeometry() {
+    m_geometry_valid = false;
+}
+
+/**
+ * @brief Emitter::updateGeometry
+ *
+ * This function computes the cached gain polygon, shape and bounding rect
+ * of the emitter (if needed)
+ */
+void Emitter::updateGeometry() const {
+    if (m_geometry_valid) {
+        return;
+    }
+
+    m_poly_gain.clear();
     QPointF pt;
 
     for (double phi = -M_PI ; phi < M_PI + 0.1 ; phi += 0.1) {
         pt = QPointF(cos(phi), sin(phi));
-        poly_gain.append(pt * getGain(phi + getRotation()) * EMITTER_POLYGAIN_SIZE);
+        m_poly_gain.append(pt * getGain(phi + getRotation()) * EMITTER_POLYGAIN_SIZE);
     }
 
-    return poly_gain;
-}
-
-QRectF Emitter::boundingRect() const {
     QRectF emitter_rect(-EMITTER_WIDTH/2 - 2, -EMITTER_HEIGHT - 2,
                         EMITTER_WIDTH + 4, EMITTER_HEIGHT + 4);
 
-    QRectF gain_rect = getPolyGain().boundingRect();
-
     // Bounding rect contains the emitter and his text
-    return emitter_rect.united(gain_rect).united(TEXT_RECT);
+    m_bounding_rect = emitter_rect.united(m_poly_gain.boundingRect()).united(TEXT_RECT);
+
+    m_shape = QPainterPath();
+    m_shape.addRect(-EMITTER_WIDTH/2 - 4, -EMITTER_HEIGHT - 4,
+                    EMITTER_WIDTH + 8, EMITTER_HEIGHT + 8);
+    m_shape.addRect(TEXT_RECT);
+    m_shape.addPolygon(m_poly_gain);
+
+    m_geometry_valid = true;
+}
+
+QRectF Emitter::boundingRect() const {
+    updateGeometry();
+    return m_bounding_rect;
 }
 
 QPainterPath Emitter::shape() const {
-    QPainterPath path;
-    path.addRect(-EMITTER_WIDTH/2 - 4, -EMITTER_HEIGHT - 4,
-                 EMITTER_WIDTH + 8, EMITTER_HEIGHT + 8);
-    path.addRect(TEXT_RECT);
-    path.addPolygon(getPolyGain());
-    return path;
+    updateGeometry();
+    return m_shape;
 }
 
 void Emitter::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) {
@@ -39,9 +39,9 @@ public:
     double getEfficiency() const;
 
     double getResistance() const;
-    vector<complex> getEffectiveHeight(double phi) const;
+    cvector3 getEffectiveHeight(double phi) const;
     double getGain(double phi) const;
-    vector<complex> getPolarization() const;
+    cvector3 getPolarization() const;
 
     void updateTooltip();
 
@@ -50,11 +50,22 @@ public:
     QPainterPath shape() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
 
+    void invalidateGeometry() override;
+
 private:
+    void updateGeometry() const;
+
     double m_frequency;
     double m_power;
 
     Antenna *m_antenna;
+
+    // Cached geometry: the gain polygon, the shape and bounding rect of the item
+    // (computed again after a change of the antenna or of its rotation)
+    mutable bool m_geometry_valid;
+    mutable QPolygonF m_poly_gain;
+    mutable QPainterPath m_shape;
+    mutable QRectF m_bounding_rect;
 };
 
 
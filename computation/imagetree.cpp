@@ -0,0 +1,125 @@
+#include "imagetree.h"
+
+
+/**
+ * @brief ImageTree::ImageTree
+ * @param scene   : The compiled scene (must be finalized)
+ * @param emitter : The index of the emitter, source of the images
+ *
+ * This constructor builds the whole image tree of the emitter
+ */
+ImageTree::ImageTree(const CompiledScene *scene, int emitter)
+{
+    m_emitter = emitter;
+
+    // No image to compute if there is no reflection
+    if (scene->reflectionsCount() < 1) {
+        return;
+    }
+
+    const QPointF source = scene->getEmitters()[emitter].position;
+
+    // The first reflection can occur on every wall of the scene
+    for (int w = 0 ; w < (int) scene->getWalls().size() ; w++) {
+        build(scene, -1, w, source, 1.0, 1);
+    }
+}
+
+int ImageTree::emitter() const {
+    return m_emitter;
+}
+
+const vector<ImageNode> &ImageTree::getNodes() const {
+    return m_nodes;
+}
+
+/**
+ * @brief ImageTree::getChain
+ * @param node   : The index of the last node of the chain
+ * @param images : The list to fill with the images (from the first reflection to the last)
+ * @param walls  : The list to fill with the walls indexes (same order)
+ *
+ * This function gets the sequence of images and walls from the emitter to the 'node'
+ */
+void ImageTree::getChain(int node, vector<QPointF> *images, vector<int> *walls) const {
+    // Number of reflections of the chain
+    int length = 0;
+
+    for (int i = node ; i >= 0 ; i = m_nodes[i].parent) {
+        length++;
+    }
+
+    // Go up to the root, filling the lists from the end (they keep their capacity,
+    // so a list reused for all the nodes is only allocated for the longest chain)
+    images->resize(length);
+    walls->resize(length);
+
+    for (int i = node ; i >= 0 ; i = m_nodes[i].parent) {
+        length--;
+        (*images)[length] = m_nodes[i].image;
+        (*walls)[length] = m_nodes[i].wall;
+    }
+}
+
+/**
+ * @brief ImageTree::build
+ * @param scene  : The compiled scene
+ * @param parent : The index of the parent node (-1 for a first reflection)
+ * @param wall   : The index of the reflection wall
+ * @param source : The position of the source (emitter or parent's image)
+ * @param gain   : The power factor bound of the parent node (1 for a first reflection)
+ * @param level  : The recursion level (number of reflections)
+ *
+ * This function computes the image of the source over the wall, and then the
+ * images of this image recursively.
+ * The branches that can't form a valid ray path are pruned.
+ */
+void ImageTree::build(
+        const CompiledScene *scene,
+        int parent,
+        int wall,
+        QPointF source,
+        double gain,
+        int level)
+{
+    const CompiledWall &w = scene->getWalls()[wall];
+
+    // Side of the wall where the source is (the reflected ray goes back to this side)
+    const double source_side = w.side(source);
+
+    // If the source is on the line of the wall, no reflection can occur on it,
+    // so the whole branch is invalid.
+    if (fabs(source_side) < GEOMETRY_EPSILON) {
+        return;
+    }
+
+    // The reflection coefficient on this wall is estimated from its values up to the largest
+    // incidence angle from the source (the estimate doesn't depend on the receiver)
+    const int frequency_index = scene->getEmitters()[m_emitter].frequency_index;
+    const double node_gain = gain * scene->reflectionBound(w.material, frequency_index, w.maxIncidenceAngle(source));
+
+    // Add the node for the image of the source over this wall
+    const int index = (int) m_nodes.size();
+    const QPointF image = w.mirror(source);
+    m_nodes.push_back({parent, wall, -1, level, image, node_gain});
+
+    // If the level of recursion is under the max number of reflections
+    if (level < scene->reflectionsCount()) {
+        for (int next = 0 ; next < (int) scene->getWalls().size() ; next++) {
+            // We don't have to compute any reflection from the wall to itself
+            if (next == wall) {
+                continue;
+            }
+
+            // No reflection is possible on a wall that is entirely behind this wall
+            if (!scene->canReachWall(wall, next, source_side > 0)) {
+                continue;
+            }
+
+            build(scene, index, next, image, node_gain, level + 1);
+        }
+    }
+
+    // The subtree of this node ends here
+    m_nodes[index].end = (int) m_nodes.size();
+}
@@ -0,0 +1,47 @@
+#ifndef IMAGETREE_H
+#define IMAGETREE_H
+
+#include <QPointF>
+#include <QList>
+
+#include "constants.h"
+#include "compiledscene.h"
+
+// Node of the image tree: image of the parent's source over a wall
+struct ImageNode
+{
+    int parent;         // Index of the parent node (-1 for a first reflection)
+    int wall;           // Index of the reflection wall in the compiled scene
+    int end;            // Index following the last node of this node's subtree
+    int order;          // Number of reflections up to this node (1 for a first reflection)
+    QPointF image;      // Position of the image (in meters)
+    double gain;        // Estimated max of the power factor of the reflections up to this node
+};
+
+
+/**
+ * This class stores all the images of an emitter, for every sequence of reflections
+ * up to the max reflections count. The images don't depend on the receivers, so the
+ * tree is built once per emitter and walked for each receiver.
+ *
+ * The nodes are stored in depth-first order, so the subtree of a node is the range
+ * of nodes [index, end).
+ */
+class ImageTree
+{
+public:
+    ImageTree(const CompiledScene *scene, int emitter);
+
+    int emitter() const;
+    const vector<ImageNode> &getNodes() const;
+
+    void getChain(int node, vector<QPointF> *images, vector<int> *walls) const;
+
+private:
+    void build(const CompiledScene *scene, int parent, int wall, QPointF source, double gain, int level);
+
+    int m_emitter;
+    vector<ImageNode> m_nodes;
+};
+
+#endif // IMAGETREE_H
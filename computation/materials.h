@@ -0,0 +1,23 @@
+#ifndef MATERIALS_H
+#define MATERIALS_H
+
+// Type used to recognize the saved classes into a file
+namespace WallType {
+enum WallType{
+    BrickWall       = 1,
+    ConcreteWall    = 2,
+    PartitionWall   = 3,
+};
+}
+
+// Wall's relative permittivity
+#define BRICK_R_PERMITTIVITY      4.6
+#define CONCRETE_R_PERMITTIVITY   5
+#define PARTITION_R_PERMITTIVITY  2.25
+
+// Wall's conductivity
+#define BRICK_CONDUCTIVITY      0.02
+#define CONCRETE_CONDUCTIVITY   0.014
+#define PARTITION_CONDUCTIVITY  0.04
+
+#endif // MATERIALS_H
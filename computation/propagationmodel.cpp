@@ -0,0 +1,1148 @@
+#include "propagationmodel.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QAtomicInteger>
+
+#include <functional>
+
+
+/**
+ * This class evaluates the points of a batch in a thread of the pool.
+ * The points are taken by chunks from a shared counter, until all the points are done.
+ * Each point has its own result, so the results don't depend on the threads.
+ */
+class PointsEvaluationUnit : public QRunnable
+{
+public:
+    PointsEvaluationUnit(
+            qint64 points_count,
+            const std::function<void(qint64)> *evaluate,
+            QAtomicInteger<qint64> *next_chunk)
+    {
+        m_points_count = points_count;
+        m_evaluate = evaluate;
+        m_next_chunk = next_chunk;
+    }
+
+    void run() override {
+        while (true) {
+            const qint64 first = m_next_chunk->fetchAndAddOrdered(1) * POINTS_CHUNK_SIZE;
+
+            if (first >= m_points_count) {
+                break;
+            }
+
+            const qint64 last = min(first + POINTS_CHUNK_SIZE, m_points_count);
+
+            for (qint64 i = first ; i < last ; i++) {
+                (*m_evaluate)(i);
+            }
+        }
+    }
+
+private:
+    qint64 m_points_count;
+    const std::function<void(qint64)> *m_evaluate;
+    QAtomicInteger<qint64> *m_next_chunk;
+};
+
+
+/**
+ * @brief PropagationModel::PropagationModel
+ * @param scene : The compiled scene (must be finalized, it is not copied)
+ *
+ * This constructor builds the image tree of each emitter (the images don't depend
+ * on the receivers, so they are shared by all the evaluated points).
+ */
+PropagationModel::PropagationModel(const CompiledScene *scene)
+{
+    m_scene = scene;
+
+    for (int e = 0 ; e < (int) scene->getEmitters().size() ; e++) {
+        m_image_trees.append(new ImageTree(scene, e));
+    }
+}
+
+PropagationModel::~PropagationModel()
+{
+    foreach (ImageTree *tree, m_image_trees) {
+        delete tree;
+    }
+}
+
+const CompiledScene *PropagationModel::compiledScene() const {
+    return m_scene;
+}
+
+const ImageTree *PropagationModel::imageTree(int emitter) const {
+    return m_image_trees.at(emitter);
+}
+
+/**
+ * @brief PropagationModel::computeReflection
+ *
+ * This function computes the reflection coefficient for the reflection of
+ * an incident ray on a wall.
+ * The coefficient returned is 3-dimensionnal:
+ *  - the two first components are the same and are the coefficient
+ *    for a parallel polarization
+ *  - the last component is the coefficient for the othogonal polarization
+ *
+ * @param em     : The emitter (source of this ray)
+ * @param w      : The index of the reflection wall
+ * @param ray_in : The incident ray
+ * @return       : The reflection coefficient for this reflection
+ */
+cvector3 PropagationModel::computeReflection(const CompiledEmitter &em, int w, const QLineF &in_ray) const {
+    // Get the properties of the reflection wall at the frequency of the emitter
+    const CompiledWall &wall = m_scene->getWalls()[w];
+    const MaterialCoefficients &mc = m_scene->getCoefficients(wall.material, em.frequency_index);
+
+    // Compute the reflection coefficient for the incidence angle of the ray
+    return mc.reflection(wall.normalAngleTo(in_ray));
+}
+
+/**
+ * @brief PropagationModel::computeTransmissons
+ *
+ * This function computes all the transmissions undergone by the 'ray', and returns
+ * the total transmission coefficient.
+ * The coefficient returned is 3-dimensionnal:
+ *  - the two first components are the same and are the coefficient
+ *    for a parallel polarization
+ *  - the last component is the coefficient for the othogonal polarization
+ *
+ * @param em          : The emitter (source of this ray)
+ * @param ray         : The ray for which to compute the transmissions
+ * @param origin_wall : The index of the wall from which this ray come from (reflection), or -1
+ * @param target_wall : The index of the wall to which this ray go to (reflection), or -1
+ * @return            : The total transmission coefficient for all undergone transmissions
+ */
+cvector3 PropagationModel::computeTransmissons(
+        const CompiledEmitter &em,
+        const QLineF &ray,
+        int origin_wall,
+        int target_wall) const
+{
+    // Total transmission coefficient (for this ray)
+    cvector3 total_coeff(1, 1, 1);
+
+    const vector<CompiledWall> &walls = m_scene->getWalls();
+
+    // Get the walls that may intersect the ray from the spatial index
+    // (the list is reused by each thread to avoid allocations)
+    static thread_local vector<int> candidates;
+    m_scene->segmentWalls(ray, &candidates);
+
+    // Loop over the candidate walls and look for transmissions (intersection with ray)
+    for (int i : candidates) {
+        // No transmission through the origin or target wall (where this ray is reflected)
+        if (i == origin_wall || i == target_wall) {
+            continue;
+        }
+
+        const CompiledWall &w = walls[i];
+
+        // Get the transmission point
+        QPointF pt;
+        QLineF::IntersectionType i_t = ray.intersects(w.line, &pt);
+
+        // There is transmission if the intersection with the ray is
+        // on the wall (not on its extension)
+        if (i_t != QLineF::BoundedIntersection) {
+            continue;
+        }
+
+        // Get the properties of the transmission wall at the frequency of the emitter
+        const MaterialCoefficients &mc = m_scene->getCoefficients(w.material, em.frequency_index);
+
+        // Compute the transmission coefficient for the incidence angle of the ray
+        const cvector3 coeff = mc.transmission(w.normalAngleTo(ray));
+
+        // Multiply the total transmission coefficient with this one
+        // The multiplication is made component by component (not a cross product).
+        total_coeff *= coeff;
+    }
+
+    return total_coeff;
+}
+
+/**
+ * @brief PropagationModel::computeNominalElecField
+ *
+ * This function computes the "Nominal" electric field (equation 8.77).
+ * So this is the electric field as if there were no reflection or transmission.
+ * The electric field is returned in a 3-dimentionnal vector.
+ *
+ * @param em    : The emitter (source of this ray)
+ * @param e_ray : The ray coming out from the emitter
+ * @param r_ray : The ray coming to the receiver
+ * @param dn    : The total length of the ray path
+ * @return      : The "Nominal" electric field
+ */
+cvector3 PropagationModel::computeNominalElecField(
+        const CompiledEmitter &em,
+        const QLineF &e_ray,
+        const QLineF &r_ray,
+        double dn) const
+{
+    // Incidence angle of the ray from the emitter
+    double phi = em.incidentRayAngle(e_ray);
+
+    // Get the polarization vector of the emitter
+    const cvector3 polarization = em.antenna->getPolarization();
+
+    // Get properties from the emitter
+    double GTX = em.getGain(phi);
+    double PTX = em.power;
+    double omega = em.frequency*2*M_PI;
+
+    // Compute the direction of the parallel component of the electric field at the receiver.
+    // This direction is a unit vector normal to the propagation vector in the incidence plane.
+    QLineF E_unit = r_ray.normalVector().unitVector();
+
+    // Propagation constant (air)
+    complex gamma_0 = 1i*omega*sqrt(MU_0*EPSILON_0);
+
+    // Direct (nominal) electric field (equation 8.77)
+    complex E = sqrt(60.0*GTX*PTX) * exp(-gamma_0*dn) / dn;
+
+    // The first component of the polarization vector is the parallel component, the second
+    // is the orthogonal one.
+    // E_unit is the direction vector of the electric field in the incidence plane.
+    return cvector3(
+        E * polarization[0] * E_unit.dx(),
+        E * polarization[0] * E_unit.dy(),
+        E * polarization[1]
+    );
+}
+
+/**
+ * @brief PropagationModel::computeRayPower
+ *
+ * This function computes the power of a ray path from an emitter to a receiver
+ * (equation 8.83, applyed to one ray)
+ *
+ * @param em  : The emitter (source of the ray path)
+ * @param re  : The receiver (destination of the ray path)
+ * @param ray : The ray coming to the receiver
+ * @param En  : The electric field of the ray
+ * @return    : The power of the ray path to the receiver
+ */
+double PropagationModel::computeRayPower(
+        const CompiledEmitter &em,
+        const CompiledReceiver &re,
+        const QLineF &ray,
+        const cvector3 &En) const
+{
+    // Incidence angle of the ray to the receiver
+    double phi = re.incidentRayAngle(ray);
+
+    // Get the frequency from the emitter
+    double frequency = em.frequency;
+
+    // Get the antenna's resistance and effective height
+    double Ra = re.antenna->getResistance();
+    cvector3 he = re.getEffectiveHeight(phi, frequency);
+
+    // norm() = square of modulus
+    return norm(dotProduct(he, En)) / (8.0 * Ra);
+}
+
+/**
+ * @brief PropagationModel::computeRayAmplitude
+ *
+ * This function computes the complex amplitude of a ray path at the receiver: the open
+ * circuit voltage of the receiver's antenna, scaled so its squared modulus is the power
+ * of the ray path (see computeRayPower()). Its phase contains the propagation delay.
+ *
+ * @param em  : The emitter (source of the ray path)
+ * @param re  : The receiver (destination of the ray path)
+ * @param ray : The ray coming to the receiver
+ * @param En  : The electric field of the ray
+ * @return    : The complex amplitude of the ray path
+ */
+complex PropagationModel::computeRayAmplitude(
+        const CompiledEmitter &em,
+        const CompiledReceiver &re,
+        const QLineF &ray,
+        const cvector3 &En) const
+{
+    const double phi = re.incidentRayAngle(ray);
+    const cvector3 he = re.getEffectiveHeight(phi, em.frequency);
+
+    return dotProduct(he, En) / sqrt(8.0 * re.antenna->getResistance());
+}
+
+/**
+ * @brief PropagationModel::traceRayPath
+ *
+ * This function computes the lines and the power of the ray path for a combination
+ * of reflections, without creating any RayPath object.
+ *
+ * @param em     : The emitter of this ray path
+ * @param re     : The receiver of this ray path
+ * @param images : The list of reflection images computed for this ray path
+ * @param walls  : The list of walls indexes that form a combination of reflections
+ * @param rays   : The list to fill with the lines of the ray path (from the receiver)
+ * @param power  : Set to the power of the ray path at the receiver
+ * @param terms  : If not null, set to the terms of the ray path that don't depend on the antennas
+ * @return       : False if the ray path is invalid
+ */
+bool PropagationModel::traceRayPath(
+        const CompiledEmitter &em,
+        const CompiledReceiver &re,
+        const vector<QPointF> &images,
+        const vector<int> &walls,
+        vector<QLineF> *rays,
+        double *power,
+        PathTerms *terms) const
+{
+    // This coefficient will contain the product of all reflection and
+    // transmission coefficients for this ray path
+    cvector3 coeff(1, 1, 1);
+
+    // Total length of the ray path
+    double dn;
+
+    // First pass: compute all the reflection points and check the validity of the ray path,
+    // so no coefficient is computed for an invalid ray path.
+    if (!traceReflections(em, re, images, walls, rays, &dn)) {
+        return false;
+    }
+
+    // The last ray line is from the emitter to the first reflection point (or the receiver)
+    const QLineF ray = rays->back();
+
+    // Second pass: compute the coefficients of the (valid) ray path
+
+    // Wall of the next reflection (towards the receiver)
+    int target_wall = -1;
+
+    for (int i = (int) images.size()-1, k = 0 ; i >= 0 ; i--, k++) {
+        int reflect_wall = walls[i];
+
+        // Compute the reflection coefficient for this reflection
+        // The multiplication is made component by component (not a cross product).
+        coeff *= computeReflection(em, reflect_wall, (*rays)[k]);
+
+        // Compute the transmission coefficient for all transmissions undergone by the ray line.
+        coeff *= computeTransmissons(em, (*rays)[k], reflect_wall, target_wall);
+
+        target_wall = reflect_wall;
+    }
+
+    // Compute all the transmissions undergone by the ray line from the emitter.
+    coeff *= computeTransmissons(em, ray, -1, target_wall);
+
+    // Keep the terms that don't depend on the antennas (to update the power of this
+    // ray path if only the powers or the antennas change)
+    if (terms != nullptr) {
+        terms->e_ray = rays->back();
+        terms->r_ray = rays->front();
+        terms->length = dn;
+        terms->coeff = coeff;
+    }
+
+    // Compute the electric field for this ray path (equation 8.78)
+    // rays->back() is the ray coming out from the emitter
+    // rays->front() is the ray coming to the receiver
+    // The multiplication is made component by component (not a cross product).
+    cvector3 En = coeff * computeNominalElecField(em, rays->back(), rays->front(), dn);
+
+    // Compute the power of the ray coming to the receiver (first ray in the list)
+    *power = computeRayPower(em, re, rays->front(), En);
+
+    return true;
+}
+
+/**
+ * @brief PropagationModel::traceReflections
+ *
+ * This function computes the lines of the ray path for a combination of reflections
+ * (first pass of traceRayPath() and tracePathGeometry()), and checks that it is valid:
+ * each reflection point must be on its wall (not on its extension), and two consecutive
+ * points of the ray path must be different.
+ *
+ * @param em     : The emitter of this ray path (only its position is used)
+ * @param re     : The receiver of this ray path
+ * @param images : The list of reflection images computed for this ray path
+ * @param walls  : The list of walls indexes that form a combination of reflections
+ * @param rays   : The list to fill with the lines of the ray path (from the receiver)
+ * @param length : Set to the total length of the ray path
+ * @return       : False if the ray path is invalid
+ */
+bool PropagationModel::traceReflections(
+        const CompiledEmitter &em,
+        const CompiledReceiver &re,
+        const vector<QPointF> &images,
+        const vector<int> &walls,
+        vector<QLineF> *rays,
+        double *length) const
+{
+    // We run backward in this function (from receiver to emitter)
+
+    // The first target point is the receiver
+    QPointF target_point = re.position;
+
+    // This list will contain the lines forming the ray path
+    rays->clear();
+
+    // Loop over the images (backward)
+    for (int i = (int) images.size()-1; i >= 0 ; i--) {
+        // Compute the virtual ray (line from the image to te target point)
+        QLineF virtual_ray (images[i], target_point);
+
+        // If this is the virtual ray from the last image to the receiver,
+        // it length is the total ray path length.
+        if (i == (int) images.size()-1) {
+            *length = virtual_ray.length();
+        }
+
+        // Get the reflection point (intersection of the virtual ray and the wall)
+        QPointF reflection_pt;
+        QLineF::IntersectionType i_t =
+                virtual_ray.intersects(m_scene->getWalls()[walls[i]].line, &reflection_pt);
+
+        // The ray path is valid if the reflection is on the wall (not on its extension)
+        if (i_t != QLineF::BoundedIntersection) {
+            return false; // Invalid ray path
+        }
+
+        // If the target point is the same as the reflection point
+        //  -> not a physics situation -> invalid raypath
+        if (reflection_pt == target_point) {
+            return false;
+        }
+
+        // Add this ray line to the list of lines forming the ray path
+        rays->push_back(QLineF(reflection_pt, target_point));
+
+        // The next target point is the current reflection point
+        target_point = reflection_pt;
+    }
+
+    // If the target point is the same as the emitter point
+    //  -> not a physics situation -> invalid raypath
+    if (em.position == target_point) {
+        return false;
+    }
+
+    // The last ray line is from the emitter to the target point
+    rays->push_back(QLineF(em.position, target_point));
+
+    // If there were no images in the list, this is the direct ray, so the length
+    // of the ray path is the length of the ray line from emitter to receiver.
+    if (images.empty()) {
+        *length = rays->back().length();
+    }
+
+    return true;
+}
+
+/**
+ * @brief PropagationModel::termsPower
+ * @param em    : The emitter of the ray path
+ * @param re    : The receiver of the ray path
+ * @param terms : The terms of the ray path computed by traceRayPath()
+ * @return
+ *
+ * This function computes the power of a ray path from its terms, for other powers,
+ * antennas or rotations of its emitter and receiver (same positions and frequency).
+ * The result is the same as the one of traceRayPath(), without any geometry.
+ */
+double PropagationModel::termsPower(const CompiledEmitter &em, const CompiledReceiver &re, const PathTerms &terms) const {
+    const cvector3 En = terms.coeff * computeNominalElecField(em, terms.e_ray, terms.r_ray, terms.length);
+    return computeRayPower(em, re, terms.r_ray, En);
+}
+
+/**
+ * @brief PropagationModel::tracePathGeometry
+ *
+ * This function computes the geometry of the ray path for a combination of reflections:
+ * its lines, and the walls and incidence angles of its reflections and transmissions.
+ * Nothing here depends on the frequency, so the power of the ray path can then be
+ * computed for several frequencies with pathPower(), without tracing it again.
+ *
+ * @param em     : The emitter of this ray path (only its position is used)
+ * @param re     : The receiver of this ray path
+ * @param images : The list of reflection images computed for this ray path
+ * @param walls  : The list of walls indexes that form a combination of reflections
+ * @param path   : The geometry to fill
+ * @return       : False if the ray path is invalid
+ */
+bool PropagationModel::tracePathGeometry(
+        const CompiledEmitter &em,
+        const CompiledReceiver &re,
+        const vector<QPointF> &images,
+        const vector<int> &walls,
+        PathGeometry *path) const
+{
+    path->reflection_walls.clear();
+    path->reflection_angles.clear();
+    path->transmission_walls.clear();
+    path->transmission_angles.clear();
+
+    // Same first pass as traceRayPath() (the lines are from the receiver to the emitter)
+    if (!traceReflections(em, re, images, walls, &path->rays, &path->length)) {
+        return false;
+    }
+
+    // The line k comes to the reflection point of the wall of the image (images.size()-1-k)
+    for (int i = (int) images.size()-1, k = 0 ; i >= 0 ; i--, k++) {
+        path->reflection_walls.push_back(walls[i]);
+        path->reflection_angles.push_back(m_scene->getWalls()[walls[i]].normalAngleTo(path->rays[k]));
+    }
+
+    // Find the transmissions undergone by each line (same rules as computeTransmissons())
+    const vector<CompiledWall> &scene_walls = m_scene->getWalls();
+    static thread_local vector<int> candidates;
+
+    for (size_t k = 0 ; k < path->rays.size() ; k++) {
+        const QLineF &ray = path->rays[k];
+
+        // No transmission through the walls where this line is reflected
+        const int origin_wall = k < path->reflection_walls.size() ? path->reflection_walls[k] : -1;
+        const int target_wall = k > 0 ? path->reflection_walls[k-1] : -1;
+
+        m_scene->segmentWalls(ray, &candidates);
+
+        for (int i : candidates) {
+            if (i == origin_wall || i == target_wall) {
+                continue;
+            }
+
+            QPointF pt;
+
+            if (ray.intersects(scene_walls[i].line, &pt) == QLineF::BoundedIntersection) {
+                path->transmission_walls.push_back(i);
+                path->transmission_angles.push_back(scene_walls[i].normalAngleTo(ray));
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief PropagationModel::pathPower
+ * @param em   : The emitter of the ray path (its frequency is used for all the coefficients)
+ * @param re   : The receiver of the ray path
+ * @param path : The geometry computed by tracePathGeometry()
+ * @return
+ *
+ * This function computes the power of a traced ray path at the frequency of the emitter
+ * (same computation as the second pass of traceRayPath()).
+ */
+double PropagationModel::pathPower(const CompiledEmitter &em, const CompiledReceiver &re, const PathGeometry &path) const {
+    return norm(pathAmplitude(em, re, path));
+}
+
+/**
+ * @brief PropagationModel::pathAmplitude
+ * @param em   : The emitter of the ray path (its frequency is used for all the coefficients)
+ * @param re   : The receiver of the ray path
+ * @param path : The geometry computed by tracePathGeometry()
+ * @return
+ *
+ * This function computes the complex amplitude of a traced ray path at the receiver
+ * (see computeRayAmplitude()).
+ */
+complex PropagationModel::pathAmplitude(const CompiledEmitter &em, const CompiledReceiver &re, const PathGeometry &path) const {
+    const vector<CompiledWall> &walls = m_scene->getWalls();
+    cvector3 coeff(1, 1, 1);
+
+    for (size_t i = 0 ; i < path.reflection_walls.size() ; i++) {
+        const int material = walls[path.reflection_walls[i]].material;
+        coeff *= m_scene->getCoefficients(material, em.frequency_index).reflection(path.reflection_angles[i]);
+    }
+
+    for (size_t i = 0 ; i < path.transmission_walls.size() ; i++) {
+        const int material = walls[path.transmission_walls[i]].material;
+        coeff *= m_scene->getCoefficients(material, em.frequency_index).transmission(path.transmission_angles[i]);
+    }
+
+    const cvector3 En = coeff * computeNominalElecField(em, path.rays.back(), path.rays.front(), path.length);
+
+    return computeRayAmplitude(em, re, path.rays.front(), En);
+}
+
+/**
+ * @brief PropagationModel::powerBound
+ * @param em : The emitter
+ * @param re : The receiver
+ * @return
+ *
+ * This function returns an upper bound of the power of a ray path from the emitter
+ * to the receiver, for a unit path length and without losses. It is computed from
+ * the max gain of the emitter and the max effective height of the receiver
+ * (equations 8.77 and 8.83, with |he.En| <= |he|*|En|)
+ */
+double PropagationModel::powerBound(const CompiledEmitter &em, const CompiledReceiver &re) const {
+    const double he_max = re.antenna->getMaxEffectiveHeight(em.frequency);
+
+    return 60.0 * em.antenna->getMaxGain() * em.power * he_max*he_max
+            / (8.0 * re.antenna->getResistance());
+}
+
+/**
+ * @brief PropagationModel::nodePowerBound
+ * @param node        : The node of the image tree
+ * @param pos         : The position of the receiver
+ * @param power_bound : The bound returned by powerBound() for this emitter and receiver
+ * @return
+ *
+ * This function returns an estimate of the max power of every ray path of the node's subtree.
+ * The length of these ray paths is at least the distance from the image to the receiver
+ * (triangle inequality), and each reflection adds a factor lower than 1. It is only an
+ * estimate since the reflection factors of the node are estimated from sampled angles.
+ */
+double PropagationModel::nodePowerBound(const ImageNode &node, const QPointF &pos, double power_bound) {
+    const QPointF d = node.image - pos;
+    return power_bound * node.gain / (d.x()*d.x() + d.y()*d.y());
+}
+
+/**
+ * @brief PropagationModel::prunedAncestor
+ * @param nodes             : The nodes of the image tree
+ * @param node              : The index of the node
+ * @param pos               : The position of the receiver
+ * @param power_bound       : The bound returned by powerBound() for this emitter and receiver
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts)
+ * @return
+ *
+ * This function returns the highest ancestor of a node whose branch is pruned, or -1.
+ * A range of nodes can start inside a branch pruned by a previous range (the ranges are
+ * computed separately), so its first nodes are skipped up to the end of this branch.
+ */
+int PropagationModel::prunedAncestor(
+        const vector<ImageNode> &nodes,
+        int node,
+        const QPointF &pos,
+        double power_bound,
+        double pruning_threshold)
+{
+    int ancestor = -1;
+
+    for (int i = nodes[node].parent ; i >= 0 ; i = nodes[i].parent) {
+        if (nodePowerBound(nodes[i], pos, power_bound) < pruning_threshold) {
+            ancestor = i;
+        }
+    }
+
+    return ancestor;
+}
+
+/**
+ * @brief PropagationModel::directPower
+ * @param emitter : The index of the emitter
+ * @param re      : The receiver
+ * @param result  : The sum where to add the power of the direct ray path
+ *
+ * This function computes the power of the direct ray path from the emitter to the receiver.
+ */
+void PropagationModel::directPower(int emitter, const CompiledReceiver &re, ReceivedPower *result) const {
+    // The lines buffer is reused by each thread to avoid allocations
+    // (the empty lists of images and walls don't allocate anything)
+    static thread_local vector<QLineF> rays;
+    double power;
+
+    if (traceRayPath(m_scene->getEmitters()[emitter], re, vector<QPointF>(), vector<int>(), &rays, &power)) {
+        result->power += power;
+        result->paths_count++;
+    }
+}
+
+/**
+ * @brief PropagationModel::reflectionsPower
+ * @param emitter           : The index of the emitter
+ * @param re                : The receiver
+ * @param first             : The index of the first node in the emitter's image tree
+ * @param last              : The index after the last node in the emitter's image tree
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts, 0 to disable)
+ * @param result            : The sum where to add the powers of the ray paths
+ * @param min_order         : Only the nodes of a higher order of reflection are computed (0 for all the nodes)
+ * @param orders            : If not null, the sums of each order of reflection (indexed by the number of reflections)
+ *
+ * This function computes the power of the ray path to the receiver for each node in the
+ * range [first, last) of the emitter's image tree, and adds them to the 'result'.
+ * The power of each ray path is also added to the sum of its order in 'orders'.
+ */
+void PropagationModel::reflectionsPower(
+        int emitter,
+        const CompiledReceiver &re,
+        int first,
+        int last,
+        double pruning_threshold,
+        ReceivedPower *result,
+        int min_order,
+        ReceivedPower *orders) const
+{
+    const ImageTree *tree = m_image_trees.at(emitter);
+    const vector<ImageNode> &nodes = tree->getNodes();
+    const vector<CompiledWall> &walls = m_scene->getWalls();
+    const CompiledEmitter &em = m_scene->getEmitters()[emitter];
+    const double power_bound = powerBound(em, re);
+
+    // The buffers are reused by each thread to avoid allocations
+    static thread_local vector<QPointF> images_chain;
+    static thread_local vector<int> walls_chain;
+    static thread_local vector<QLineF> rays;
+
+    // Skip the nodes of a branch pruned by a previous range (it is only counted there)
+    if (pruning_threshold > 0 && first < last) {
+        const int ancestor = prunedAncestor(nodes, first, re.position, power_bound, pruning_threshold);
+
+        if (ancestor >= 0) {
+            first = min(nodes[ancestor].end, last);
+        }
+    }
+
+    for (int i = first ; i < last ; i++) {
+        const ImageNode &node = nodes[i];
+
+        // Power-bound pruning of the node's subtree
+        if (pruning_threshold > 0) {
+            const double bound = nodePowerBound(node, re.position, power_bound);
+
+            if (bound < pruning_threshold) {
+                // Count the whole subtree once, and skip its nodes in this range
+                // (the next ranges skip the rest of it)
+                result->pruned_branches++;
+                result->pruned_nodes += node.end - i;
+                result->pruned_power += bound * (node.end - i);
+
+                i = min(node.end, last) - 1;
+                continue;
+            }
+        }
+
+        // The lower orders are already computed (their descendants may not be)
+        if (node.order <= min_order) {
+            continue;
+        }
+
+        // Compute the complete ray path only if the line from the image to the receiver
+        // crosses the wall of the last reflection (so the receiver is on the side of the source)
+        if (!walls[node.wall].crossedBy(node.image, re.position)) {
+            continue;
+        }
+
+        // Get the sequence of images and walls of this node
+        tree->getChain(i, &images_chain, &walls_chain);
+
+        double power;
+
+        if (traceRayPath(em, re, images_chain, walls_chain, &rays, &power)) {
+            result->power += power;
+            result->paths_count++;
+
+            if (orders != nullptr) {
+                orders[node.order].power += power;
+                orders[node.order].paths_count++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief PropagationModel::receivedPower
+ * @param emitter           : The index of the emitter
+ * @param re                : The receiver
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts, 0 to disable)
+ * @param result            : The sum where to add the powers of the ray paths
+ *
+ * This function computes the power of all the ray paths from the emitter to the receiver
+ * (direct and reflected).
+ */
+void PropagationModel::receivedPower(
+        int emitter,
+        const CompiledReceiver &re,
+        double pruning_threshold,
+        ReceivedPower *result) const
+{
+    directPower(emitter, re, result);
+    reflectionsPower(emitter, re, 0, (int) m_image_trees.at(emitter)->getNodes().size(), pruning_threshold, result);
+}
+
+/**
+ * @brief PropagationModel::evaluatePoint
+ * @param pos               : The position of the point (in meters)
+ * @param antenna           : The antenna of the receiver at this point
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts, 0 to disable)
+ * @return
+ *
+ * This function computes the power received at a point from all the emitters,
+ * and the corresponding bitrate.
+ */
+PointResult PropagationModel::evaluatePoint(const QPointF &pos, const Antenna *antenna, double pruning_threshold) const {
+    CompiledReceiver re;
+    re.position = pos;
+    re.rotation = 0;
+    re.antenna = antenna;
+
+    PointResult result;
+    evaluateReceiver(re, pruning_threshold, &result);
+
+    return result;
+}
+
+/**
+ * @brief PropagationModel::evaluatePoints
+ * @param points            : The positions of the points (in meters)
+ * @param antenna           : The antenna of the receivers at these points
+ * @param results           : The list to fill with the results (same order as the points)
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts, 0 to disable)
+ * @param threads_count     : The number of threads to use (0 for the number of processor cores)
+ *
+ * This function evaluates a batch of points, with several threads.
+ */
+void PropagationModel::evaluatePoints(
+        const vector<QPointF> &points,
+        const Antenna *antenna,
+        vector<PointResult> *results,
+        double pruning_threshold,
+        int threads_count) const
+{
+    results->resize(points.size());
+
+    runPointsBatch((qint64) points.size(), threads_count, [&](qint64 i) {
+        (*results)[i] = evaluatePoint(points[i], antenna, pruning_threshold);
+    });
+}
+
+/**
+ * @brief PropagationModel::runPointsBatch
+ * @param points_count  : The number of points of the batch
+ * @param threads_count : The number of threads to use (0 for the number of processor cores)
+ * @param evaluate      : The function that evaluates a point (from its index)
+ *
+ * This function evaluates a batch of points. The points are split in chunks between
+ * the threads, and this function returns when all the points are computed.
+ */
+void PropagationModel::runPointsBatch(qint64 points_count, int threads_count, const std::function<void(qint64)> &evaluate) const {
+    if (threads_count <= 0) {
+        threads_count = QThread::idealThreadCount();
+    }
+
+    // No need of other threads for a single chunk
+    const int chunks_count = (int) ((points_count + POINTS_CHUNK_SIZE - 1) / POINTS_CHUNK_SIZE);
+    threads_count = max(1, min(threads_count, chunks_count));
+
+    QAtomicInteger<qint64> next_chunk(0);
+
+    if (threads_count == 1) {
+        PointsEvaluationUnit unit(points_count, &evaluate, &next_chunk);
+        unit.run();
+        return;
+    }
+
+    // Each unit takes chunks of points until all points are done
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads_count);
+
+    for (int i = 0 ; i < threads_count ; i++) {
+        pool.start(new PointsEvaluationUnit(points_count, &evaluate, &next_chunk));
+    }
+
+    pool.waitForDone();
+}
+
+/**
+ * @brief PropagationModel::receivedPowerBands
+ * @param emitter       : The index of the emitter
+ * @param re            : The receiver
+ * @param band_emitters : The emitter at each frequency of the sweep (see bandEmitters())
+ * @param results       : The sums where to add the powers of the ray paths (one per band)
+ *
+ * This function computes the power of all the ray paths from the emitter to the receiver
+ * for each band of a frequency sweep. Each ray path is traced once, and only its
+ * coefficients and electric field are computed again for each band.
+ * There is no pruning here, since the power bound of a branch depends on the frequency.
+ */
+void PropagationModel::receivedPowerBands(
+        int emitter,
+        const CompiledReceiver &re,
+        const vector<CompiledEmitter> &band_emitters,
+        vector<ReceivedPower> *results) const
+{
+    results->resize(band_emitters.size());
+
+    forEachPath(emitter, re, [&](const PathGeometry &path) {
+        for (size_t b = 0 ; b < band_emitters.size() ; b++) {
+            (*results)[b].power += pathPower(band_emitters[b], re, path);
+            (*results)[b].paths_count++;
+        }
+    });
+}
+
+/**
+ * @brief PropagationModel::forEachPath
+ * @param emitter : The index of the emitter
+ * @param re      : The receiver
+ * @param f       : The function called with the geometry of each valid ray path
+ *
+ * This function traces all the ray paths from the emitter to the receiver (direct
+ * and reflected, without pruning), and gives them one by one to the function.
+ */
+void PropagationModel::forEachPath(
+        int emitter,
+        const CompiledReceiver &re,
+        const std::function<void(const PathGeometry&)> &f) const
+{
+    const ImageTree *tree = m_image_trees.at(emitter);
+    const vector<ImageNode> &nodes = tree->getNodes();
+    const vector<CompiledWall> &walls = m_scene->getWalls();
+    const CompiledEmitter &em = m_scene->getEmitters()[emitter];
+
+    // The buffers are reused by each thread to avoid allocations
+    static thread_local vector<QPointF> images_chain;
+    static thread_local vector<int> walls_chain;
+    static thread_local PathGeometry path;
+
+    // Direct ray path (index -1), then a ray path for each node of the image tree
+    for (int i = -1 ; i < (int) nodes.size() ; i++) {
+        if (i < 0) {
+            images_chain.clear();
+            walls_chain.clear();
+        }
+        else {
+            if (!walls[nodes[i].wall].crossedBy(nodes[i].image, re.position)) {
+                continue;
+            }
+
+            tree->getChain(i, &images_chain, &walls_chain);
+        }
+
+        if (tracePathGeometry(em, re, images_chain, walls_chain, &path)) {
+            f(path);
+        }
+    }
+}
+
+/**
+ * @brief PropagationModel::receivedChannel
+ * @param emitter : The index of the emitter
+ * @param re      : The receiver
+ * @param metrics : The metrics where to add the ray paths
+ *
+ * This function adds all the ray paths from the emitter to the receiver to the wideband
+ * metrics of the channel, as they are traced (the ray paths are not stored).
+ */
+void PropagationModel::receivedChannel(int emitter, const CompiledReceiver &re, ChannelMetrics *metrics) const {
+    const CompiledEmitter &em = m_scene->getEmitters()[emitter];
+
+    forEachPath(emitter, re, [&](const PathGeometry &path) {
+        metrics->addPath(pathAmplitude(em, re, path), path.length / LIGHT_SPEED);
+    });
+}
+
+/**
+ * @brief PropagationModel::evaluateChannel
+ * @param pos     : The position of the point (in meters)
+ * @param antenna : The antenna of the receiver at this point
+ * @param metrics : The metrics to fill (their channel is kept)
+ *
+ * This function computes the wideband metrics of the channel at a point, from all the
+ * emitters (they are considered as emitting the same signal).
+ */
+void PropagationModel::evaluateChannel(const QPointF &pos, const Antenna *antenna, ChannelMetrics *metrics) const {
+    CompiledReceiver re;
+    re.position = pos;
+    re.rotation = 0;
+    re.antenna = antenna;
+
+    metrics->reset();
+
+    for (int e = 0 ; e < (int) m_scene->getEmitters().size() ; e++) {
+        receivedChannel(e, re, metrics);
+    }
+
+    metrics->finish();
+}
+
+/**
+ * @brief PropagationModel::evaluatePointsChannel
+ * @param points        : The positions of the points (in meters)
+ * @param antenna       : The antenna of the receivers at these points
+ * @param channel       : The OFDM channel of the metrics (bandwidth and subcarriers)
+ * @param results       : The list to fill with the metrics of each point (same order as the points)
+ * @param threads_count : The number of threads to use (0 for the number of processor cores)
+ *
+ * This function computes the wideband metrics of a batch of points, with several threads.
+ */
+void PropagationModel::evaluatePointsChannel(
+        const vector<QPointF> &points,
+        const Antenna *antenna,
+        const ChannelMetrics &channel,
+        vector<ChannelMetrics> *results,
+        int threads_count) const
+{
+    results->assign(points.size(), ChannelMetrics(channel.bandwidth(), channel.subcarriersCount()));
+
+    runPointsBatch((qint64) points.size(), threads_count, [&](qint64 i) {
+        evaluateChannel(points[i], antenna, &(*results)[i]);
+    });
+}
+
+/**
+ * @brief PropagationModel::bandEmitters
+ * @param emitter       : The index of the emitter
+ * @param frequencies   : The frequencies of the sweep (in Hz)
+ * @param band_emitters : The list to fill with the emitter at each frequency
+ * @return              : False if a frequency is not in the scene
+ *
+ * This function makes a copy of the emitter for each frequency of the sweep.
+ * The frequencies must have been added to the scene before it was finalized
+ * (see CompiledScene::addFrequency()), so the coefficients of the materials are known.
+ */
+bool PropagationModel::bandEmitters(int emitter, const vector<double> &frequencies, vector<CompiledEmitter> *band_emitters) const {
+    band_emitters->clear();
+
+    for (double frequency : frequencies) {
+        CompiledEmitter em = m_scene->getEmitters()[emitter];
+        em.frequency = frequency;
+        em.frequency_index = m_scene->getFrequencyIndex(frequency);
+
+        // The coefficients of the materials are not known at this frequency
+        if (em.frequency_index < 0) {
+            band_emitters->clear();
+            return false;
+        }
+
+        band_emitters->push_back(em);
+    }
+
+    return true;
+}
+
+/**
+ * @brief PropagationModel::evaluatePointBands
+ * @param pos           : The position of the point (in meters)
+ * @param antenna       : The antenna of the receiver at this point
+ * @param band_emitters : The band emitters of each emitter of the scene (see bandEmitters())
+ * @param results       : The list to fill with the result of each band
+ *
+ * This function computes the power received at a point from all the emitters,
+ * for each band of a frequency sweep.
+ */
+void PropagationModel::evaluatePointBands(
+        const QPointF &pos,
+        const Antenna *antenna,
+        const vector<vector<CompiledEmitter>> &band_emitters,
+        vector<PointResult> *results) const
+{
+    CompiledReceiver re;
+    re.position = pos;
+    re.rotation = 0;
+    re.antenna = antenna;
+
+    const size_t bands_count = band_emitters.empty() ? 0 : band_emitters.front().size();
+
+    static thread_local vector<ReceivedPower> received;
+    received.assign(bands_count, ReceivedPower());
+
+    for (int e = 0 ; e < (int) band_emitters.size() ; e++) {
+        receivedPowerBands(e, re, band_emitters[e], &received);
+    }
+
+    results->resize(bands_count);
+
+    for (size_t b = 0 ; b < bands_count ; b++) {
+        (*results)[b].power = received[b].power;
+        (*results)[b].bitrate = bitRate(received[b].power);
+        (*results)[b].paths_count = received[b].paths_count;
+    }
+}
+
+/**
+ * @brief PropagationModel::evaluatePointsBands
+ * @param points        : The positions of the points (in meters)
+ * @param antenna       : The antenna of the receivers at these points
+ * @param frequencies   : The frequencies of the sweep (in Hz, added to the scene before finalize)
+ * @param layers        : Set to one list of results per frequency (same order as the points)
+ * @param threads_count : The number of threads to use (0 for the number of processor cores)
+ * @return              : False if a frequency was not added to the scene (nothing is evaluated)
+ *
+ * This function evaluates a batch of points for each frequency of a sweep, with the
+ * emitters at these frequencies (same power and antenna). The ray paths are traced
+ * once per point, whatever the number of frequencies.
+ */
+bool PropagationModel::evaluatePointsBands(
+        const vector<QPointF> &points,
+        const Antenna *antenna,
+        const vector<double> &frequencies,
+        vector<vector<PointResult>> *layers,
+        int threads_count) const
+{
+    layers->clear();
+
+    // Copies of the emitters at each frequency
+    vector<vector<CompiledEmitter>> band_emitters(m_scene->getEmitters().size());
+
+    for (int e = 0 ; e < (int) band_emitters.size() ; e++) {
+        if (!bandEmitters(e, frequencies, &band_emitters[e])) {
+            return false;
+        }
+    }
+
+    layers->assign(frequencies.size(), vector<PointResult>(points.size()));
+
+    runPointsBatch((qint64) points.size(), threads_count, [&](qint64 i) {
+        static thread_local vector<PointResult> results;
+        evaluatePointBands(points[i], antenna, band_emitters, &results);
+
+        for (size_t b = 0 ; b < results.size() ; b++) {
+            (*layers)[b][i] = results[b];
+        }
+    });
+
+    return true;
+}
+
+/**
+ * @brief PropagationModel::bitRate
+ * @param power : The received power (in Watts)
+ * @return
+ *
+ * This function returns the bitrate (in Mb/s) for a received power
+ */
+double PropagationModel::bitRate(double power) {
+    double bit_rate = 0;
+    double dbm_power = 10 * log10(power / 0.001);
+
+    // Under -82 dBm, the bitrate is 0 Mb/s
+    if (dbm_power >= -82) {
+        // Limit the power to -51 dBm (the bit rate cannot be greater)
+        dbm_power = min(dbm_power, -51.0);
+
+        // Linearisation between the two boundary values :
+        //   -82 dBm        54 Mb/s
+        //   -51 dBm        433 Mb/s
+        bit_rate = (433.0 - 54.0) / (-51.0 + 82.0) * (dbm_power + 51.0) + 433.0;
+    }
+
+    return bit_rate;
+}
+
+/**
+ * @brief PropagationModel::evaluateReceiver
+ * @param re                : The receiver
+ * @param pruning_threshold : The power under which the branches are pruned (in Watts, 0 to disable)
+ * @param result            : The result to fill
+ *
+ * This function computes the power received by a receiver from all the emitters.
+ */
+void PropagationModel::evaluateReceiver(const CompiledReceiver &re, double pruning_threshold, PointResult *result) const {
+    ReceivedPower received;
+
+    for (int e = 0 ; e < (int) m_scene->getEmitters().size() ; e++) {
+        receivedPower(e, re, pruning_threshold, &received);
+    }
+
+    result->power = received.power;
+    result->bitrate = bitRate(received.power);
+    result->paths_count = received.paths_count;
+}
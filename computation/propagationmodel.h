@@ -0,0 +1,187 @@
+#ifndef PROPAGATIONMODEL_H
+#define PROPAGATIONMODEL_H
+
+#include <QPointF>
+#include <QLineF>
+#include <QList>
+
+#include "constants.h"
+#include "antennas.h"
+#include "compiledscene.h"
+#include "imagetree.h"
+#include "channelmetrics.h"
+
+#include <functional>
+
+// Number of points given at once to a thread when evaluating a batch of points
+#define POINTS_CHUNK_SIZE 16
+
+// Sum of the powers of the ray paths from an emitter to a receiver, and pruning report
+struct ReceivedPower
+{
+    double power = 0;
+    int paths_count = 0;
+
+    // Branches of reflections cut by the pruning (and count of their nodes),
+    // and estimated max of their total power at the receiver (in Watts)
+    qint64 pruned_branches = 0;
+    qint64 pruned_nodes = 0;
+    double pruned_power = 0;
+};
+
+// Terms of a ray path that don't depend on the powers and antennas of its emitter and
+// receiver: the rays leaving the emitter and reaching the receiver (the departure and
+// arrival angles depend on the rotations of the antennas), the total length and the
+// product of the reflection and transmission coefficients (per polarization)
+struct PathTerms
+{
+    QLineF e_ray;
+    QLineF r_ray;
+    double length;
+    cvector3 coeff;
+};
+
+// Geometry of a ray path: it doesn't depend on the frequency, so it can be traced once and
+// evaluated for several frequencies (the angles are the incidence angles on the walls)
+struct PathGeometry
+{
+    vector<QLineF> rays;                // Lines of the ray path (from the receiver)
+    double length;                      // Total length of the ray path
+    vector<int> reflection_walls;
+    vector<double> reflection_angles;
+    vector<int> transmission_walls;
+    vector<double> transmission_angles;
+};
+
+// Result of the evaluation of a point (from all the emitters)
+struct PointResult
+{
+    double power;       // Received power [W]
+    double bitrate;     // Bitrate [Mb/s]
+    int paths_count;    // Number of ray paths to this point
+};
+
+
+/**
+ * This class is the computation core of the simulation: it computes the ray paths
+ * and the received powers from a compiled scene. It doesn't use any graphics item,
+ * so it can be used without the interface (read or build a CompiledScene, finalize it,
+ * and evaluate any batch of points).
+ *
+ * The image trees of the emitters are built once by the constructor. All the other
+ * functions are const, so they can be called from several threads at the same time.
+ */
+class PropagationModel
+{
+public:
+    PropagationModel(const CompiledScene *scene);
+    ~PropagationModel();
+
+    const CompiledScene *compiledScene() const;
+    const ImageTree *imageTree(int emitter) const;
+
+    cvector3 computeReflection(const CompiledEmitter &em, int w, const QLineF &in_ray) const;
+    cvector3 computeTransmissons(const CompiledEmitter &em, const QLineF &ray, int origin_wall = -1, int target_wall = -1) const;
+    cvector3 computeNominalElecField(const CompiledEmitter &em, const QLineF &e_ray, const QLineF &r_ray, double dn) const;
+
+    double computeRayPower(const CompiledEmitter &em, const CompiledReceiver &re, const QLineF &ray, const cvector3 &En) const;
+    complex computeRayAmplitude(const CompiledEmitter &em, const CompiledReceiver &re, const QLineF &ray, const cvector3 &En) const;
+
+    bool traceRayPath(
+            const CompiledEmitter &em,
+            const CompiledReceiver &re,
+            const vector<QPointF> &images,
+            const vector<int> &walls,
+            vector<QLineF> *rays,
+            double *power,
+            PathTerms *terms = nullptr) const;
+    double termsPower(const CompiledEmitter &em, const CompiledReceiver &re, const PathTerms &terms) const;
+
+    bool tracePathGeometry(
+            const CompiledEmitter &em,
+            const CompiledReceiver &re,
+            const vector<QPointF> &images,
+            const vector<int> &walls,
+            PathGeometry *path) const;
+    double pathPower(const CompiledEmitter &em, const CompiledReceiver &re, const PathGeometry &path) const;
+    complex pathAmplitude(const CompiledEmitter &em, const CompiledReceiver &re, const PathGeometry &path) const;
+
+    double powerBound(const CompiledEmitter &em, const CompiledReceiver &re) const;
+    static double nodePowerBound(const ImageNode &node, const QPointF &pos, double power_bound);
+    static int prunedAncestor(
+            const vector<ImageNode> &nodes,
+            int node,
+            const QPointF &pos,
+            double power_bound,
+            double pruning_threshold);
+
+    void directPower(int emitter, const CompiledReceiver &re, ReceivedPower *result) const;
+    void reflectionsPower(
+            int emitter,
+            const CompiledReceiver &re,
+            int first,
+            int last,
+            double pruning_threshold,
+            ReceivedPower *result,
+            int min_order = 0,
+            ReceivedPower *orders = nullptr) const;
+    void receivedPower(int emitter, const CompiledReceiver &re, double pruning_threshold, ReceivedPower *result) const;
+
+    PointResult evaluatePoint(const QPointF &pos, const Antenna *antenna, double pruning_threshold = 0) const;
+    void evaluatePoints(
+            const vector<QPointF> &points,
+            const Antenna *antenna,
+            vector<PointResult> *results,
+            double pruning_threshold = 0,
+            int threads_count = 0) const;
+
+    void receivedPowerBands(
+            int emitter,
+            const CompiledReceiver &re,
+            const vector<CompiledEmitter> &band_emitters,
+            vector<ReceivedPower> *results) const;
+    bool bandEmitters(int emitter, const vector<double> &frequencies, vector<CompiledEmitter> *band_emitters) const;
+    void evaluatePointBands(
+            const QPointF &pos,
+            const Antenna *antenna,
+            const vector<vector<CompiledEmitter>> &band_emitters,
+            vector<PointResult> *results) const;
+    bool evaluatePointsBands(
+            const vector<QPointF> &points,
+            const Antenna *antenna,
+            const vector<double> &frequencies,
+            vector<vector<PointResult>> *layers,
+            int threads_count = 0) const;
+
+    void receivedChannel(int emitter, const CompiledReceiver &re, ChannelMetrics *metrics) const;
+    void evaluateChannel(const QPointF &pos, const Antenna *antenna, ChannelMetrics *metrics) const;
+    void evaluatePointsChannel(
+            const vector<QPointF> &points,
+            const Antenna *antenna,
+            const ChannelMetrics &channel,
+            vector<ChannelMetrics> *results,
+            int threads_count = 0) const;
+
+    static double bitRate(double power);
+
+private:
+    Q_DISABLE_COPY(PropagationModel)
+
+    bool traceReflections(
+            const CompiledEmitter &em,
+            const CompiledReceiver &re,
+            const vector<QPointF> &images,
+            const vector<int> &walls,
+            vector<QLineF> *rays,
+            double *length) const;
+
+    void forEachPath(int emitter, const CompiledReceiver &re, const std::function<void(const PathGeometry&)> &f) const;
+    void runPointsBatch(qint64 points_count, int threads_count, const std::function<void(qint64)> &evaluate) const;
+
+    void evaluateReceiver(const CompiledReceiver &re, double pruning_threshold, PointResult *result) const;
+
+    const CompiledScene *m_scene;
+    QList<ImageTree*> m_image_trees;
+};
+
+#endif // PROPAGATIONMODEL_H
@@ -28,8 +28,21 @@ QList<QLineF> RayPath::getRays() {
     return m_rays;
 }
 
+/**
+ * @brief RayPath::colorRatio
+ * @param power : The power of a ray path (in Watts)
+ * @return
+ *
+ * Returns the ratio of the color scale of a ray path with this power
+ * (0 at -160 dBm, 1 at -60 dBm)
+ */
+double RayPath::colorRatio(double power) {
+    const double dbm_power = SimulationData::convertPowerTodBm(power);
+    return 1.0 - (dbm_power+60)/-100.0;
+}
+
 QLineF RayPath::getScaledLine(QLineF r) const {
-    const qreal sim_scale = simulationScene()->simulationScale();
+    const qreal sim_scale = simulationScale();
     return QLineF(r.p1() * sim_scale, r.p2() * sim_scale);
 }
 
@@ -59,9 +72,7 @@ QPainterPath RayPath::shape() const {
 
 void RayPath::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) {
     // Get the pen color (function of the power)
-    const double dbm_power = SimulationData::convertPowerTodBm(getPower());
-    //TODO: clean this colour computation...
-    const QColor pen_color(SimulationData::ratioToColor(1.0 - (dbm_power+60)/-100.0));
+    const QColor pen_color(SimulationData::ratioToColor(colorRatio(getPower())));
 
     // Set the pen for this raypath
     painter->setPen(QPen(pen_color, PEN_WIDTH));
@@ -15,6 +15,8 @@ public:
     QList<QLineF> getRays();
     double getPower();
 
+    static double colorRatio(double power);
+
     QRectF boundingRect() const override;
     QPainterPath shape() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
@@ -0,0 +1,325 @@
+#include "raypathsindex.h"
+#include "raypath.h"
+
+#include <algorithm>
+
+RayPathsIndex::RayPathsIndex()
+{
+    m_columns_count = 0;
+    m_rows_count = 0;
+    m_cell_size = RAYS_INDEX_CELL_SIZE;
+}
+
+/**
+ * @brief RayPathsIndex::build
+ * @param ray_paths : The ray paths to index
+ * @param sim_scale : The scale of the lines of the index (pixels per meter)
+ *
+ * This function replaces the content of the index by these ray paths
+ */
+void RayPathsIndex::build(QList<RayPath*> ray_paths, qreal sim_scale) {
+    clear();
+
+    // Sort the ray paths by decreasing power
+    std::stable_sort(ray_paths.begin(), ray_paths.end(), [](RayPath *a, RayPath *b) {
+        return a->getPower() > b->getPower();
+    });
+
+    m_paths.reserve(ray_paths.size());
+
+    foreach (RayPath *rp, ray_paths) {
+        const QList<QLineF> rays = rp->getRays();
+
+        IndexedRayPath path;
+        path.power = rp->getPower();
+        path.emitter = rp->getEmitter();
+        path.reflections = max(rays.size() - 1, 0);
+        path.first_line = (int) m_lines.size();
+        path.lines_count = rays.size();
+
+        foreach (const QLineF &ray, rays) {
+            const QLineF line(ray.p1() * sim_scale, ray.p2() * sim_scale);
+
+            m_lines.push_back(line);
+            m_line_paths.push_back((int) m_paths.size());
+            path.rect = path.rect.united(QRectF(line.p1(), line.p2()).normalized());
+        }
+
+        m_paths.push_back(path);
+        m_bounding_rect = m_bounding_rect.united(path.rect);
+    }
+
+    buildGrid();
+}
+
+/**
+ * @brief RayPathsIndex::buildGrid
+ *
+ * This function adds each line to the cells of the grid it crosses. The cells are
+ * larger than RAYS_INDEX_CELL_SIZE if the bounding rect needs too many of them.
+ */
+void RayPathsIndex::buildGrid() {
+    const double extent = max(m_bounding_rect.width(), m_bounding_rect.height());
+    m_cell_size = max((double) RAYS_INDEX_CELL_SIZE, extent / RAYS_INDEX_MAX_CELLS);
+
+    m_columns_count = (int) floor(m_bounding_rect.width() / m_cell_size) + 1;
+    m_rows_count = (int) floor(m_bounding_rect.height() / m_cell_size) + 1;
+    m_cells.assign(m_columns_count * m_rows_count, vector<int>());
+
+    for (int i = 0 ; i < (int) m_lines.size() ; i++) {
+        const QLineF &l = m_lines[i];
+        const QRect cells = cellsRect(QRectF(l.p1(), l.p2()).normalized());
+
+        for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+            // Rows crossed by the line in this column
+            double y1 = l.y1();
+            double y2 = l.y2();
+
+            if (l.dx() != 0) {
+                const double x_left = m_bounding_rect.left() + cx * m_cell_size;
+                const double t1 = max(0.0, min(1.0, (x_left - l.x1()) / l.dx()));
+                const double t2 = max(0.0, min(1.0, (x_left + m_cell_size - l.x1()) / l.dx()));
+
+                y1 = l.y1() + t1 * l.dy();
+                y2 = l.y1() + t2 * l.dy();
+            }
+
+            const QRect rows = cellsRect(QRectF(QPointF(l.x1(), min(y1, y2)), QPointF(l.x1(), max(y1, y2))));
+
+            for (int cy = max(rows.top(), cells.top()) ; cy <= min(rows.bottom(), cells.bottom()) ; cy++) {
+                m_cells[cx * m_rows_count + cy].push_back(i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief RayPathsIndex::cellsRect
+ * @param rect : A rect of the scene
+ * @return
+ *
+ * Returns the cells of the grid covered by this rect (clipped to the grid)
+ */
+QRect RayPathsIndex::cellsRect(const QRectF &rect) const {
+    const int left   = max(0, (int) floor((rect.left() - m_bounding_rect.left()) / m_cell_size));
+    const int top    = max(0, (int) floor((rect.top() - m_bounding_rect.top()) / m_cell_size));
+    const int right  = min(m_columns_count - 1, (int) floor((rect.right() - m_bounding_rect.left()) / m_cell_size));
+    const int bottom = min(m_rows_count - 1, (int) floor((rect.bottom() - m_bounding_rect.top()) / m_cell_size));
+
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+/**
+ * @brief RayPathsIndex::clear
+ *
+ * This function removes all the ray paths from the index
+ */
+void RayPathsIndex::clear() {
+    m_paths.clear();
+    m_lines.clear();
+    m_line_paths.clear();
+    m_bounding_rect = QRectF();
+
+    m_cells.clear();
+    m_columns_count = 0;
+    m_rows_count = 0;
+}
+
+int RayPathsIndex::size() const {
+    return (int) m_paths.size();
+}
+
+/**
+ * @brief RayPathsIndex::path
+ * @param i
+ * @return
+ *
+ * Returns the i-th most powerful ray path
+ */
+const IndexedRayPath &RayPathsIndex::path(int i) const {
+    return m_paths[i];
+}
+
+const vector<QLineF> &RayPathsIndex::lines() const {
+    return m_lines;
+}
+
+QRectF RayPathsIndex::boundingRect() const {
+    return m_bounding_rect;
+}
+
+/**
+ * @brief RayPathsIndex::countOver
+ * @param threshold : A power (in Watts)
+ * @return
+ *
+ * Returns the number of ray paths with a power greater than the threshold
+ * (they are the first ones of the index)
+ */
+int RayPathsIndex::countOver(double threshold) const {
+    auto it = std::partition_point(m_paths.begin(), m_paths.end(), [&](const IndexedRayPath &p) {
+        return p.power > threshold;
+    });
+
+    return (int) (it - m_paths.begin());
+}
+
+/**
+ * @brief RayPathsIndex::linesCount
+ * @param count : A number of ray paths
+ * @return
+ *
+ * Returns the number of lines of the 'count' most powerful ray paths
+ * (they are the first lines of the index)
+ */
+int RayPathsIndex::linesCount(int count) const {
+    if (count >= (int) m_paths.size()) {
+        return (int) m_lines.size();
+    }
+
+    return (count > 0 ? m_paths[count].first_line : 0);
+}
+
+/**
+ * @brief RayPathsIndex::pathsRect
+ * @param first           : The index of the first ray path
+ * @param last            : The index after the last ray path
+ * @param emitter         : Only the ray paths from this emitter (nullptr for all)
+ * @param max_reflections : Only the ray paths with at most this number of reflections (-1 for all)
+ * @return
+ *
+ * Returns the bounding rect of the matching ray paths in this range
+ */
+QRectF RayPathsIndex::pathsRect(int first, int last, Emitter *emitter, int max_reflections) const {
+    QRectF rect;
+
+    for (int i = first ; i < last ; i++) {
+        if (matches(m_paths[i], emitter, max_reflections)) {
+            rect = rect.united(m_paths[i].rect);
+        }
+    }
+
+    return rect;
+}
+
+/**
+ * @brief RayPathsIndex::matches
+ * @param path
+ * @param emitter         : The emitter of the ray path (nullptr for any)
+ * @param max_reflections : The max number of reflections of the ray path (-1 for any)
+ * @return
+ *
+ * Returns true if the ray path matches these filters
+ */
+bool RayPathsIndex::matches(const IndexedRayPath &path, Emitter *emitter, int max_reflections) {
+    if (emitter != nullptr && path.emitter != emitter) {
+        return false;
+    }
+
+    return max_reflections < 0 || path.reflections <= max_reflections;
+}
+
+/**
+ * @brief RayPathsIndex::topPaths
+ * @param count           : The max number of ray paths (-1 for all)
+ * @param threshold       : The min power of the ray paths (in Watts)
+ * @param emitter         : Only the ray paths from this emitter (nullptr for all)
+ * @param max_reflections : Only the ray paths with at most this number of reflections (-1 for all)
+ * @return
+ *
+ * Returns the indexes of the most powerful ray paths matching these filters
+ * (by decreasing power, only among the ray paths over the threshold)
+ */
+QList<int> RayPathsIndex::topPaths(int count, double threshold, Emitter *emitter, int max_reflections) const {
+    QList<int> result;
+
+    const int over_count = countOver(threshold);
+
+    for (int i = 0 ; i < over_count && result.size() != count ; i++) {
+        if (matches(m_paths[i], emitter, max_reflections)) {
+            result.append(i);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief RayPathsIndex::lineCrosses
+ * @param l
+ * @param rect
+ * @return
+ *
+ * Returns true if the bounding rect of the line crosses this rect
+ * (a horizontal or vertical line has an empty bounding rect)
+ */
+bool RayPathsIndex::lineCrosses(const QLineF &l, const QRectF &rect) {
+    return max(l.x1(), l.x2()) >= rect.left() && min(l.x1(), l.x2()) <= rect.right() &&
+           max(l.y1(), l.y2()) >= rect.top() && min(l.y1(), l.y2()) <= rect.bottom();
+}
+
+/**
+ * @brief RayPathsIndex::linesIn
+ * @param rect            : A rect of the scene
+ * @param count           : Only the lines of the 'count' most powerful ray paths
+ * @param lines           : Set to the indexes of the lines which can cross the rect (by decreasing power)
+ * @param emitter         : Only the lines of the ray paths from this emitter (nullptr for all)
+ * @param max_reflections : Only the lines of the ray paths with at most this number of reflections (-1 for all)
+ *
+ * This function finds the lines which can cross a rect from the cells of the grid. If the
+ * rect covers most of the grid, the lines of the ray paths are tested one by one instead.
+ */
+void RayPathsIndex::linesIn(
+        const QRectF &rect,
+        int count,
+        vector<int> *lines,
+        Emitter *emitter,
+        int max_reflections) const
+{
+    lines->clear();
+
+    const bool filtered = emitter != nullptr || max_reflections >= 0;
+    const int lines_count = linesCount(count);
+    const QRect cells = cellsRect(rect);
+
+    if (lines_count == 0 || cells.isEmpty()) {
+        return;
+    }
+
+    if (2 * cells.width() * cells.height() >= m_columns_count * m_rows_count) {
+        for (int i = 0 ; i < lines_count ; i++) {
+            if (filtered && !matches(m_paths[m_line_paths[i]], emitter, max_reflections)) {
+                continue;
+            }
+
+            if (lineCrosses(m_lines[i], rect)) {
+                lines->push_back(i);
+            }
+        }
+
+        return;
+    }
+
+    for (int cx = cells.left() ; cx <= cells.right() ; cx++) {
+        for (int cy = cells.top() ; cy <= cells.bottom() ; cy++) {
+            for (int i : m_cells[cx * m_rows_count + cy]) {
+                // The lines of a cell are sorted, so the next ones are of hidden ray paths
+                if (i >= lines_count) {
+                    break;
+                }
+
+                if (filtered && !matches(m_paths[m_line_paths[i]], emitter, max_reflections)) {
+                    continue;
+                }
+
+                if (lineCrosses(m_lines[i], rect)) {
+                    lines->push_back(i);
+                }
+            }
+        }
+    }
+
+    // A line crossing several cells is found once per cell
+    std::sort(lines->begin(), lines->end());
+    lines->erase(std::unique(lines->begin(), lines->end()), lines->end());
+}
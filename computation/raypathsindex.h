@@ -0,0 +1,85 @@
+#ifndef RAYPATHSINDEX_H
+#define RAYPATHSINDEX_H
+
+#include <QLineF>
+#include <QRect>
+#include <QRectF>
+#include <QList>
+
+#include "constants.h"
+
+// Size of the cells of the grid of the lines (in pixels), and max number of cells in each dimension
+#define RAYS_INDEX_CELL_SIZE 64
+#define RAYS_INDEX_MAX_CELLS 256
+
+class Emitter;
+class RayPath;
+
+// Record of a ray path in the index (its lines are copied in the lines of the index)
+struct IndexedRayPath
+{
+    double power;
+    Emitter *emitter;
+    int reflections;    // Number of reflections of the ray path (number of lines - 1)
+    int first_line;     // Index of the first line of the ray path
+    int lines_count;
+    QRectF rect;        // Bounding rect of the lines of the ray path
+};
+
+
+/**
+ * This class indexes the ray paths of a simulation by decreasing power.
+ *
+ * The ray paths over a power threshold are a prefix of the index (found by a binary
+ * search), so a change of the threshold only concerns the ray paths between the
+ * previous and the new prefix. The lines of all the ray paths are kept in a single
+ * list, in the same order, so the lines of a prefix are also a prefix of the lines.
+ * A uniform grid over the lines gives the lines which can cross a rect.
+ * The ray paths can also be filtered by emitter and by number of reflections.
+ *
+ * The data of the ray paths are copied, so the ray paths can be deleted.
+ */
+class RayPathsIndex
+{
+public:
+    RayPathsIndex();
+
+    void build(QList<RayPath*> ray_paths, qreal sim_scale);
+    void clear();
+
+    int size() const;
+    const IndexedRayPath &path(int i) const;
+    const vector<QLineF> &lines() const;
+    QRectF boundingRect() const;
+
+    int countOver(double threshold) const;
+    int linesCount(int count) const;
+    QRectF pathsRect(int first, int last, Emitter *emitter = nullptr, int max_reflections = -1) const;
+    void linesIn(
+            const QRectF &rect,
+            int count,
+            vector<int> *lines,
+            Emitter *emitter = nullptr,
+            int max_reflections = -1) const;
+
+    static bool matches(const IndexedRayPath &path, Emitter *emitter, int max_reflections);
+    QList<int> topPaths(int count, double threshold = 0, Emitter *emitter = nullptr, int max_reflections = -1) const;
+
+private:
+    void buildGrid();
+    QRect cellsRect(const QRectF &rect) const;
+    static bool lineCrosses(const QLineF &l, const QRectF &rect);
+
+    vector<IndexedRayPath> m_paths;
+    vector<QLineF> m_lines;
+    vector<int> m_line_paths;   // Index of the ray path of each line
+    QRectF m_bounding_rect;
+
+    // Grid over the bounding rect: indexes of the lines crossing each cell (increasing)
+    vector<vector<int>> m_cells;
+    int m_columns_count;
+    int m_rows_count;
+    double m_cell_size;
+};
+
+#endif // RAYPATHSINDEX_H
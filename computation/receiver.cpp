@@ -2,24 +2,33 @@
 #include "receiver.h"
 #include "interface/simulationscene.h"
 #include "simulationdata.h"
+#include "propagationmodel.h"
 
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QGraphicsSceneHoverEvent>
+
+#include <algorithm>
+#include <climits>
 
 // We want a receiver that is a square of 1 meter side
-#define RECEIVER_SIZE (1.0 * simulationScene()->simulationScale())
+#define RECEIVER_SIZE (1.0 * simulationScale())
 #define RECEIVER_CIRCLE_SIZE 8 // Size of the circle at the center (in pixels)
 
+// Min size of the receivers of an area on the screen to write their values (in pixels)
+#define AREA_VALUES_MIN_SIZE 28
+
+// Color of the receivers of an area without any ray path
+#define AREA_NO_DATA_COLOR qRgb(220,220,220)
+
 Receiver::Receiver(Antenna *antenna) : SimulationItem()
 {
     // The default angle for the emitter is PI/2 (incidence to top)
-    m_rotation_angle = M_PI_2;
+    m_rotation_angle = RECEIVER_ROTATION;
 
     // Create the associated antenna of right type
     m_antenna = antenna;
 
-    // The receiver is shaped or flat
-    m_flat = false;
-
     // If the results must be shown or not
     m_show_result = false;
 
@@ -117,7 +126,7 @@ double Receiver::getResistance() const {
     return m_antenna->getResistance();
 }
 
-vector<complex> Receiver::getEffectiveHeight(double phi, double frequency) const {
+cvector3 Receiver::getEffectiveHeight(double phi, double frequency) const {
     return m_antenna->getEffectiveHeight(M_PI_2, phi, frequency);
 }
 
@@ -138,6 +147,7 @@ void Receiver::reset() {
 
     m_received_rays.clear();
     m_received_power = 0;
+    m_received_paths_count = 0;
 
     // Hide the results
     m_show_result = false;
@@ -150,22 +160,39 @@ void Receiver::reset() {
     update();
 }
 
+/**
+ * @brief Receiver::addRayPath
+ * @param rp
+ *
+ * This function adds a ray path to this receiver.
+ * It is not thread-safe: the computation threads keep their own results, and
+ * the simulation handler adds them to the receivers when the computation is done.
+ */
 void Receiver::addRayPath(RayPath *rp) {
     // Don't add an invalid RayPath
     if (rp == nullptr)
         return;
 
-    // Lock the mutex to ensure that only one thread write in the list at a time
-    m_mutex.lock();
-
     // Append the new ray path to the list
     m_received_rays.append(rp);
 
     // Add the power of this ray to the received power
     m_received_power += rp->getPower();
+    m_received_paths_count++;
+}
 
-    // Unlock the mutex to allow others threads to write
-    m_mutex.unlock();
+/**
+ * @brief Receiver::addReceivedPower
+ * @param power       : The sum of the powers of the ray paths
+ * @param paths_count : The number of ray paths
+ *
+ * This function adds the power of ray paths to this receiver, without keeping the
+ * ray paths themselves (used for a receiver without any ray path in the cache).
+ * It is not thread-safe (same as addRayPath).
+ */
+void Receiver::addReceivedPower(double power, int paths_count) {
+    m_received_power += power;
+    m_received_paths_count += paths_count;
 }
 
 QList<RayPath*> Receiver::getRayPaths() {
@@ -176,22 +203,12 @@ double Receiver::receivedPower() {
     return m_received_power;
 }
 
-double Receiver::getBitRate() {
-    double bit_rate = 0;
-    double dbm_power = SimulationData::convertPowerTodBm(m_received_power);
-
-    // Under -82 dBm, the bitrate is 0 Mb/s
-    if (dbm_power >= -82) {
-        // Limit the power to -51 dBm (the bit rate cannot be greater)
-        dbm_power = min(dbm_power, -51.0);
-
-        // Linearisation between the two boundary values :
-        //   -82 dBm        54 Mb/s
-        //   -51 dBm        433 Mb/s
-        bit_rate = (433.0 - 54.0) / (-51.0 + 82.0) * (dbm_power + 51.0) + 433.0;
-    }
+int Receiver::receivedPathsCount() {
+    return m_received_paths_count;
+}
 
-    return bit_rate;
+double Receiver::getBitRate() {
+    return PropagationModel::bitRate(m_received_power);
 }
 
 
@@ -206,29 +223,12 @@ QRectF Receiver::boundingRect() const {
 
 QPainterPath Receiver::shape() const {
     QPainterPath path;
-    path.addRect(-RECEIVER_SIZE/2 - 2, -RECEIVER_SIZE/2 - 2,
-                 RECEIVER_SIZE + 4, RECEIVER_SIZE + 4);
+    path.addRect(boundingRect());
     return path;
 }
 
 void Receiver::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) {
-    if (!m_flat) {
-        paintShaped(painter);
-    }
-    else {
-        paintFlat(painter);
-    }
-}
-
-void Receiver::setFlat(bool flat) {
-    m_flat = flat;
-
-    if (flat) {
-        setZValue(0);
-    }
-    else {
-        setZValue(2000);
-    }
+    paintShaped(painter);
 }
 
 void Receiver::paintShaped(QPainter *painter) {
@@ -250,55 +250,6 @@ void Receiver::paintShaped(QPainter *painter) {
                 RECEIVER_CIRCLE_SIZE);
 }
 
-void Receiver::paintFlat(QPainter *painter) {
-    double data = 0;
-
-    // Nothing to paint
-    if (!m_show_result) {
-        return;
-    }
-
-    if (m_res_type == ResultType::Bitrate) {
-        data = getBitRate();
-    }
-    else {
-        data = SimulationData::convertPowerTodBm(receivedPower());
-    }
-
-    QColor background_color;
-
-    if (data != 0 && !isinf(data)) {
-        double data_ratio = (data - m_res_min) / (double)(m_res_max - m_res_min);
-
-        // Use the light color profile
-        background_color = SimulationData::ratioToColor(data_ratio, true);
-    }
-    else {
-        // Gray background
-        background_color = qRgb(220,220,220);
-    }
-
-    painter->fillRect(
-                -RECEIVER_SIZE/2, -RECEIVER_SIZE/2,
-                RECEIVER_SIZE, RECEIVER_SIZE,
-                background_color);
-
-    QString data_str = QString("%1").arg(data, 0, 'f', 0);
-    const QRect text_rect(-RECEIVER_SIZE/2, -RECEIVER_SIZE/2, RECEIVER_SIZE, RECEIVER_SIZE);
-
-    int light_level = qGray(background_color.rgb());
-
-    // Paint a white or black text (function of the light level of the background)
-    if (light_level > 125) {
-        painter->setPen(Qt::black);
-    }
-    else {
-        painter->setPen(Qt::white);
-    }
-
-    painter->drawText(text_rect, Qt::AlignCenter | Qt::AlignHCenter, data_str);
-}
-
 void Receiver::showResults(ResultType::ResultType type, int min, int max) {
     // Result type and range
     m_res_type = type;
@@ -334,7 +285,7 @@ void Receiver::generateResultsTooltip() {
                        "<b>Puissance&nbsp;:</b> %3&nbsp;dBm<br>"
                        "<b>Débit&nbsp;:</b> %4&nbsp;Mb/s")
                .arg(m_antenna->getAntennaName())
-               .arg(getRayPaths().size())
+               .arg(receivedPathsCount())
                .arg(SimulationData::convertPowerTodBm(receivedPower()), 0, 'f', 2)
                .arg(getBitRate(), 0, 'f', 2));
 }
@@ -365,19 +316,153 @@ QDataStream &operator<<(QDataStream &out, Receiver *r) {
 ReceiversArea::ReceiversArea() : QGraphicsRectItem(), SimulationItem()
 {
     QGraphicsRectItem::setZValue(-10);
+
+    // The antenna of the cells is set with the area
+    m_antenna = nullptr;
+
+    // The default angle of the receivers is PI/2 (incidence to top)
+    m_rotation_angle = RECEIVER_ROTATION;
+
+    m_rows_count = 0;
+    m_columns_count = 0;
+    m_results_dirty = false;
+
+    // Default type and range of the results
+    m_res_type = ResultType::Bitrate;
+    m_res_min = 54;
+    m_res_max = 433;
+
+    // The tooltip of the hovered cell is made from its results, and only the
+    // exposed cells are painted
+    SimulationItem::setAcceptHoverEvents(true);
+    SimulationItem::setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
 }
 
 ReceiversArea::~ReceiversArea() {
-    deleteReceivers();
+    deleteCells();
+}
+
+Antenna *ReceiversArea::getAntenna() {
+    return m_antenna;
+}
+
+double ReceiversArea::getRotation() {
+    return m_rotation_angle;
+}
+
+int ReceiversArea::cellsCount() const {
+    return m_rows_count * m_columns_count;
+}
+
+/**
+ * @brief ReceiversArea::cellIndex
+ * @param x : The column of the cell
+ * @param y : The row of the cell
+ * @return
+ *
+ * Returns the index of a cell in the grids of the area
+ */
+int ReceiversArea::cellIndex(int x, int y) const {
+    return x * m_rows_count + y;
+}
+
+/**
+ * @brief ReceiversArea::cellRealPos
+ * @param cell
+ * @return
+ *
+ * Returns the position of the center of a cell (in meters)
+ */
+QPointF ReceiversArea::cellRealPos(int cell) const {
+    const QRectF area = QGraphicsRectItem::rect();
+    const QPointF pos = area.topLeft() + QPointF(
+                (cell / m_rows_count + 0.5) * RECEIVER_SIZE,
+                (cell % m_rows_count + 0.5) * RECEIVER_SIZE);
+
+    return pos / simulationScale();
+}
+
+/**
+ * @brief ReceiversArea::getCellsList
+ * @return
+ *
+ * Returns the indexes of all the cells of the area
+ */
+vector<int> ReceiversArea::getCellsList() {
+    return getCellsList(1);
+}
+
+/**
+ * @brief ReceiversArea::getCellsList
+ * @param step : The step of the grid (in cells)
+ * @return
+ *
+ * This function returns the cells of a coarser grid: one cell every 'step'
+ * cells in each dimension (starting from the top left corner). The cells
+ * of a grid are also in the grids of the smaller steps.
+ */
+vector<int> ReceiversArea::getCellsList(int step) {
+    step = max(step, 1);
+
+    vector<int> cells;
+    for (int x = 0 ; x < m_columns_count ; x += step) {
+        for (int y = 0 ; y < m_rows_count ; y += step) {
+            cells.push_back(cellIndex(x, y));
+        }
+    }
+
+    return cells;
+}
+
+/**
+ * @brief ReceiversArea::getRefinedCellsList
+ * @param step : The step of the grid (in cells)
+ * @return
+ *
+ * This function returns the cells of a grid that are not in the grid of twice its
+ * step (the cells to compute to refine the previous grid of a progressive simulation).
+ */
+vector<int> ReceiversArea::getRefinedCellsList(int step) {
+    step = max(step, 1);
+
+    vector<int> cells;
+    for (int x = 0 ; x < m_columns_count ; x += step) {
+        for (int y = 0 ; y < m_rows_count ; y += step) {
+            // Cell of the previous grid
+            if (x % (2 * step) == 0 && y % (2 * step) == 0) {
+                continue;
+            }
+
+            cells.push_back(cellIndex(x, y));
+        }
+    }
+
+    return cells;
 }
 
-QList<Receiver*> ReceiversArea::getReceiversList() {
-    return m_receivers_list;
+/**
+ * @brief ReceiversArea::setGridSize
+ * @param step : The step of the grid (in cells)
+ *
+ * This function sets the size of the squares drawn by the cells of a grid: each cell
+ * of a coarse grid covers the cells that are not computed yet (the square is extended
+ * to the bottom right). With a step of 1, each cell only covers itself.
+ */
+void ReceiversArea::setGridSize(int step) {
+    step = max(step, 1);
+
+    for (int x = 0 ; x < m_columns_count ; x += step) {
+        for (int y = 0 ; y < m_rows_count ; y += step) {
+            m_sizes[cellIndex(x, y)] = step;
+        }
+    }
+
+    resultsChanged();
 }
 
 void ReceiversArea::setArea(AntennaType::AntennaType type, QRectF area) {
     // Compute the area as a rect of size multiple of 1m²
-    qreal sim_scale = simulationScene()->simulationScale();
+    qreal sim_scale = simulationScale();
 
     // Compute the 1m² fitted rect
     QSizeF fit_size(round(area.width() / sim_scale) * sim_scale,
@@ -389,48 +474,557 @@ void ReceiversArea::setArea(AntennaType::AntennaType type, QRectF area) {
                                      diff_sz.width()/2,  diff_sz.height()/2);
 
     // Draw the area rectangle
+    SimulationItem::prepareGeometryChange();
     setPen(QPen(Qt::darkGray, 1, Qt::DashDotDotLine));
     setBrush(QBrush(qRgba(225, 225, 255, 255), Qt::DiagCrossPattern));
     QGraphicsRectItem::setRect(fit_area);
 
-    // Delete and recreate the receivers list
-    deleteReceivers();
-    createReceivers(type, fit_area);
+    // Delete and recreate the cells
+    deleteCells();
+    createCells(type, fit_area);
 }
 
-void ReceiversArea::createReceivers(AntennaType::AntennaType type, QRectF area) {
-    if (!simulationScene())
+/**
+ * @brief ReceiversArea::resetSampling
+ *
+ * This function resets the interpolated cells and the sample state of all the
+ * cells (the computed cells are reset by the simulation handler).
+ */
+void ReceiversArea::resetSampling() {
+    for (size_t i = 0 ; i < m_samples.size() ; i++) {
+        if (m_samples[i] == SampleState::Interpolated) {
+            resetCell((int) i);
+        }
+    }
+
+    m_samples.assign(cellsCount(), SampleState::None);
+}
+
+/**
+ * @brief ReceiversArea::cancelSampling
+ * @param step : The step of the cancelled grid (in cells)
+ *
+ * This function cancels the sampling of a grid: the cells of this grid that are not
+ * in the previous one (twice the step) are not sampled anymore, and the ones interpolated
+ * for this grid are reset. The sample state is then the one of the previous grid.
+ */
+void ReceiversArea::cancelSampling(int step) {
+    if (m_samples.size() != (size_t) cellsCount()) {
         return;
+    }
 
-    // Get the count of receivers in each dimension
-    QSize num_rcv = (area.size() / simulationScene()->simulationScale()).toSize();
+    step = max(step, 1);
 
-    // Get the initial position of the receivers
-    QPointF init_pos = area.topLeft() + QPointF(RECEIVER_SIZE/2, RECEIVER_SIZE/2);
+    for (int x = 0 ; x < m_columns_count ; x += step) {
+        for (int y = 0 ; y < m_rows_count ; y += step) {
+            // Cell of the previous grid
+            if (x % (2 * step) == 0 && y % (2 * step) == 0) {
+                continue;
+            }
 
-    // Add a receiver to each m² on the area
-    for (int x = 0 ; x < num_rcv.width() ; x++) {
-        for (int y = 0 ; y < num_rcv.height() ; y++) {
-            QPointF delta_pos(x * RECEIVER_SIZE, y * RECEIVER_SIZE);
-            QPointF rcv_pos = init_pos + delta_pos;
+            const int i = cellIndex(x, y);
 
-            Receiver *rcv = new Receiver(type, 1.0);
-            simulationScene()->addItem(rcv);
+            if (m_samples[i] == SampleState::Interpolated) {
+                resetCell(i);
+            }
 
-            rcv->setFlat(true);
-            rcv->setPos(rcv_pos);
+            m_samples[i] = SampleState::None;
+        }
+    }
+}
 
-            m_receivers_list.append(rcv);
+/**
+ * @brief ReceiversArea::getSampledCellsList
+ * @param step      : The step of the grid to sample (in cells)
+ * @param tolerance : The max difference of power over a cell to interpolate it (in dB)
+ * @return          : The new cells to compute (the ones of the previous grids are computed)
+ *
+ * This function samples the cells of a grid (adaptive sampling). The first grid is
+ * fully computed. For the next grids (step halved each time), the results of the
+ * previous grid must be known: a new cell is only computed if a square of the
+ * previous grid around it is not uniform (power difference over the tolerance, or
+ * different bitrate class between its corners). Else, its power is interpolated.
+ * This way, only the cells near the walls and the coverage edges are computed.
+ */
+vector<int> ReceiversArea::getSampledCellsList(int step, double tolerance) {
+    if (m_samples.size() != (size_t) cellsCount()) {
+        resetSampling();
+    }
+
+    vector<int> cells;
+
+    if (m_rows_count <= 0) {
+        return cells;
+    }
+
+    step = max(step, 1);
+
+    const int size = 2 * step;
+    const bool first = std::find(m_samples.begin(), m_samples.end(), SampleState::Computed) == m_samples.end();
+
+    for (int x = 0 ; x < m_columns_count ; x += step) {
+        for (int y = 0 ; y < m_rows_count ; y += step) {
+            const int i = cellIndex(x, y);
+
+            if (m_samples[i] != SampleState::None) {
+                continue;
+            }
+
+            if (first) {
+                m_samples[i] = SampleState::Computed;
+                cells.push_back(i);
+                continue;
+            }
+
+            // Squares of the previous grid around this cell (two squares if it is on their edge)
+            const int cell_x = x - x % size;
+            const int cell_y = y - y % size;
+            const int cells_x[2] = {cell_x, (x % size == 0 ? cell_x - size : -1)};
+            const int cells_y[2] = {cell_y, (y % size == 0 ? cell_y - size : -1)};
+
+            bool uniform = true;
+            int interp_x = -1;
+            int interp_y = -1;
+
+            for (int cx : cells_x) {
+                for (int cy : cells_y) {
+                    if (cx < 0 || cy < 0 || !uniform) {
+                        continue;
+                    }
+
+                    uniform = uniformCell(cx, cy, size, tolerance);
+                    interp_x = cx;
+                    interp_y = cy;
+                }
+            }
+
+            if (uniform && interp_x >= 0) {
+                resetCell(i);
+                addReceivedPower(i, interpolatedPower(x, y, interp_x, interp_y, size), 0);
+
+                m_samples[i] = SampleState::Interpolated;
+            }
+            else {
+                m_samples[i] = SampleState::Computed;
+                cells.push_back(i);
+            }
         }
     }
+
+    return cells;
 }
 
-void ReceiversArea::deleteReceivers() {
-    foreach(Receiver *r, m_receivers_list) {
-        delete r;
+/**
+ * @brief ReceiversArea::uniformCell
+ * @param x         : The column of the top left corner of the square
+ * @param y         : The row of the top left corner of the square
+ * @param size      : The size of the square (in cells)
+ * @param tolerance : The max difference of power over the square (in dB)
+ * @return
+ *
+ * This function returns true if the power at the corners of a square are close
+ * enough to be interpolated, and all in the same bitrate class (no coverage,
+ * linear bitrate, or max bitrate). A square out of the area is never uniform.
+ */
+bool ReceiversArea::uniformCell(int x, int y, int size, double tolerance) {
+    if (x + size >= m_columns_count || y + size >= m_rows_count) {
+        return false;
+    }
+
+    double min_dbm = 0;
+    double max_dbm = 0;
+    int zero_count = 0;
+    int bitrate_class = -1;
+
+    for (int k = 0 ; k < 4 ; k++) {
+        const int cx = x + (k % 2) * size;
+        const int cy = y + (k / 2) * size;
+        const double power = m_powers[cellIndex(cx, cy)];
+
+        if (power <= 0) {
+            zero_count++;
+            continue;
+        }
+
+        const double dbm = SimulationData::convertPowerTodBm(power);
+        const int c = (dbm < -82 ? 0 : (dbm < -51 ? 1 : 2));
+
+        if (bitrate_class >= 0 && c != bitrate_class) {
+            return false;
+        }
+
+        min_dbm = (bitrate_class < 0 ? dbm : min(min_dbm, dbm));
+        max_dbm = (bitrate_class < 0 ? dbm : max(max_dbm, dbm));
+        bitrate_class = c;
     }
 
-    m_receivers_list.clear();
+    // A square without any ray path is uniform, but not a square partially covered
+    if (zero_count > 0) {
+        return zero_count == 4;
+    }
+
+    return max_dbm - min_dbm <= tolerance;
+}
+
+/**
+ * @brief ReceiversArea::interpolatedPower
+ * @return
+ *
+ * This function interpolates the power at a cell (x, y) from the corners of
+ * a square (bilinear interpolation of the power in dBm).
+ */
+double ReceiversArea::interpolatedPower(int x, int y, int cell_x, int cell_y, int size) {
+    const double fx = (x - cell_x) / (double) size;
+    const double fy = (y - cell_y) / (double) size;
+
+    double dbm = 0;
+
+    for (int k = 0 ; k < 4 ; k++) {
+        const int cx = cell_x + (k % 2) * size;
+        const int cy = cell_y + (k / 2) * size;
+        const double power = m_powers[cellIndex(cx, cy)];
+
+        // Square without any ray path
+        if (power <= 0) {
+            return 0;
+        }
+
+        const double wx = (k % 2 ? fx : 1 - fx);
+        const double wy = (k / 2 ? fy : 1 - fy);
+        dbm += wx * wy * SimulationData::convertPowerTodBm(power);
+    }
+
+    return SimulationData::convertPowerToWatts(dbm);
+}
+
+/**
+ * @brief ReceiversArea::showInterpolatedResults
+ *
+ * This function shows the results of the interpolated cells
+ * (the computed cells are shown by the simulation handler)
+ */
+void ReceiversArea::showInterpolatedResults(ResultType::ResultType type, int min, int max) {
+    vector<int> cells;
+
+    for (size_t i = 0 ; i < m_samples.size() ; i++) {
+        if (m_samples[i] == SampleState::Interpolated) {
+            cells.push_back((int) i);
+        }
+    }
+
+    showResults(cells, type, min, max);
+}
+
+/**
+ * @brief ReceiversArea::interpolatedCount
+ * @return
+ *
+ * Returns the number of interpolated cells of the last adaptive sampling
+ */
+int ReceiversArea::interpolatedCount() {
+    return (int) std::count(m_samples.begin(), m_samples.end(), SampleState::Interpolated);
+}
+
+void ReceiversArea::createCells(AntennaType::AntennaType type, QRectF area) {
+    // Get the count of cells in each dimension
+    QSize num_rcv = (area.size() / simulationScale()).toSize();
+    m_rows_count = num_rcv.height();
+    m_columns_count = num_rcv.width();
+
+    // All the cells have the same antenna
+    m_antenna = Antenna::createAntenna(type, 1.0);
+
+    // A cell per m² on the area, without any result
+    m_powers.assign(cellsCount(), 0.0);
+    m_paths_counts.assign(cellsCount(), 0);
+    m_shown.assign(cellsCount(), false);
+    m_sizes.assign(cellsCount(), 1);
+
+    // One pixel per cell
+    m_results_image = QImage(m_columns_count, m_rows_count, QImage::Format_ARGB32_Premultiplied);
+    m_values.assign(cellsCount(), NAN);
+    resultsChanged();
+}
+
+void ReceiversArea::deleteCells() {
+    delete m_antenna;
+    m_antenna = nullptr;
+
+    m_powers.clear();
+    m_paths_counts.clear();
+    m_shown.clear();
+    m_sizes.clear();
+    m_samples.clear();
+
+    m_rows_count = 0;
+    m_columns_count = 0;
+    m_results_image = QImage();
+    m_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ----------------------------------- CELLS RESULTS FUNCTIONS -----------------------------------//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief ReceiversArea::resetCell
+ * @param cell
+ *
+ * This function erases the results of a cell, and hides it
+ */
+void ReceiversArea::resetCell(int cell) {
+    // The cells of a previous simulation may have been recreated by setArea()
+    if (cell < 0 || cell >= cellsCount()) {
+        return;
+    }
+
+    m_powers[cell] = 0;
+    m_paths_counts[cell] = 0;
+    m_shown[cell] = false;
+
+    resultsChanged();
+}
+
+/**
+ * @brief ReceiversArea::addReceivedPower
+ * @param cell        : The index of the cell
+ * @param power       : The sum of the powers of the ray paths
+ * @param paths_count : The number of ray paths
+ *
+ * This function adds the power of ray paths to a cell.
+ * It is not thread-safe: the simulation handler adds the results of the
+ * computation threads when the computation is done.
+ */
+void ReceiversArea::addReceivedPower(int cell, double power, int paths_count) {
+    m_powers[cell] += power;
+    m_paths_counts[cell] += paths_count;
+}
+
+double ReceiversArea::receivedPower(int cell) const {
+    return m_powers[cell];
+}
+
+int ReceiversArea::receivedPathsCount(int cell) const {
+    return m_paths_counts[cell];
+}
+
+/**
+ * @brief ReceiversArea::showResults
+ * @param cells : The cells to show
+ * @param type  : The type of the results
+ * @param min   : The min of the range of the results
+ * @param max   : The max of the range of the results
+ *
+ * This function shows the results of cells. The type and the range of the results
+ * are the same for all the shown cells.
+ */
+void ReceiversArea::showResults(const vector<int> &cells, ResultType::ResultType type, int min, int max) {
+    m_res_type = type;
+    m_res_min = min;
+    m_res_max = max;
+
+    for (int cell : cells) {
+        m_shown[cell] = true;
+    }
+
+    resultsChanged();
+}
+
+/**
+ * @brief ReceiversArea::resultValue
+ * @param cell
+ * @return
+ *
+ * Returns the shown result of a cell (bitrate in Mb/s, or power in dBm)
+ */
+double ReceiversArea::resultValue(int cell) const {
+    if (m_res_type == ResultType::Bitrate) {
+        return PropagationModel::bitRate(m_powers[cell]);
+    }
+
+    return SimulationData::convertPowerTodBm(m_powers[cell]);
+}
+
+/**
+ * @brief ReceiversArea::resultsChanged
+ *
+ * This function is called when the results of the cells change,
+ * so the image of the results is made again before the next paint.
+ */
+void ReceiversArea::resultsChanged() {
+    if (!m_results_dirty) {
+        m_results_dirty = true;
+        SimulationItem::update();
+    }
+}
+
+/**
+ * @brief ReceiversArea::colorTable
+ * @return
+ *
+ * Returns the colors of the results for 256 ratios from 0 to 1 (light color profile)
+ */
+const QVector<QRgb> &ReceiversArea::colorTable() {
+    static QVector<QRgb> table;
+
+    if (table.isEmpty()) {
+        for (int i = 0 ; i < 256 ; i++) {
+            table.append(SimulationData::ratioToColor(i / 255.0, true));
+        }
+    }
+
+    return table;
+}
+
+/**
+ * @brief ReceiversArea::updateResultsImage
+ *
+ * This function makes the image of the results of the cells (one pixel per cell).
+ * A cell of a coarse grid colors the square of cells it covers (see setGridSize()),
+ * unless they are covered by a cell of a finer grid.
+ */
+void ReceiversArea::updateResultsImage() {
+    m_results_dirty = false;
+
+    if (m_results_image.isNull()) {
+        return;
+    }
+
+    const QVector<QRgb> &table = colorTable();
+
+    m_results_image.fill(Qt::transparent);
+    m_values.assign(cellsCount(), NAN);
+
+    // Size of the square of the cell that colors each pixel
+    vector<int> pixel_size(cellsCount(), INT_MAX);
+
+    for (int i = 0 ; i < cellsCount() ; i++) {
+        if (!m_shown[i]) {
+            continue;
+        }
+
+        // No result without any ray path (or without any bitrate)
+        const double value = resultValue(i);
+        QRgb color = AREA_NO_DATA_COLOR;
+
+        if (value != 0 && !isinf(value)) {
+            const double ratio = (value - m_res_min) / (double)(m_res_max - m_res_min);
+            color = table[(int) round(max(0.0, min(1.0, ratio)) * 255)];
+        }
+
+        m_values[i] = value;
+
+        const int x = i / m_rows_count;
+        const int y = i % m_rows_count;
+        const int size = m_sizes[i];
+
+        for (int px = x ; px < min(x + size, m_columns_count) ; px++) {
+            for (int py = y ; py < min(y + size, m_rows_count) ; py++) {
+                const int j = cellIndex(px, py);
+
+                if (size > pixel_size[j]) {
+                    continue;
+                }
+
+                pixel_size[j] = size;
+                ((QRgb*) m_results_image.scanLine(py))[px] = color;
+            }
+        }
+    }
+}
+
+/**
+ * @brief ReceiversArea::paintValues
+ * @param p            : The painter
+ * @param exposed_rect : The part of the area to paint
+ *
+ * This function writes the values of the shown cells in the exposed rect
+ */
+void ReceiversArea::paintValues(QPainter *p, const QRectF &exposed_rect) {
+    const QRectF area = QGraphicsRectItem::rect();
+    const QRectF rect = exposed_rect.intersected(area);
+
+    if (rect.isEmpty() || m_rows_count <= 0) {
+        return;
+    }
+
+    const int first_x = max(0, (int) floor((rect.left() - area.left()) / RECEIVER_SIZE));
+    const int last_x = min(m_columns_count - 1, (int) floor((rect.right() - area.left()) / RECEIVER_SIZE));
+    const int first_y = max(0, (int) floor((rect.top() - area.top()) / RECEIVER_SIZE));
+    const int last_y = min(m_rows_count - 1, (int) floor((rect.bottom() - area.top()) / RECEIVER_SIZE));
+
+    for (int x = first_x ; x <= last_x ; x++) {
+        for (int y = first_y ; y <= last_y ; y++) {
+            const float value = m_values[cellIndex(x, y)];
+
+            if (isnan(value)) {
+                continue;
+            }
+
+            const QRectF text_rect(
+                        area.left() + x * RECEIVER_SIZE,
+                        area.top() + y * RECEIVER_SIZE,
+                        RECEIVER_SIZE,
+                        RECEIVER_SIZE);
+
+            // Paint a white or black text (function of the light level of the background)
+            const int light_level = qGray(m_results_image.pixel(x, y));
+            p->setPen(light_level > 125 ? Qt::black : Qt::white);
+
+            p->drawText(text_rect, Qt::AlignCenter | Qt::AlignHCenter, QString("%1").arg(value, 0, 'f', 0));
+        }
+    }
+}
+
+/**
+ * @brief ReceiversArea::cellIndexAt
+ * @param pos : The position in the item
+ * @return
+ *
+ * Returns the index of the cell at a position, or -1 if there is none
+ */
+int ReceiversArea::cellIndexAt(QPointF pos) {
+    const QRectF area = QGraphicsRectItem::rect();
+    const int x = (int) floor((pos.x() - area.left()) / RECEIVER_SIZE);
+    const int y = (int) floor((pos.y() - area.top()) / RECEIVER_SIZE);
+
+    if (x < 0 || y < 0 || x >= m_columns_count || y >= m_rows_count) {
+        return -1;
+    }
+
+    return cellIndex(x, y);
+}
+
+/**
+ * @brief ReceiversArea::hoverMoveEvent
+ * @param event
+ *
+ * This function sets the tooltip of the area to the one of the hovered cell
+ */
+void ReceiversArea::hoverMoveEvent(QGraphicsSceneHoverEvent *event) {
+    const int i = cellIndexAt(event->pos());
+
+    if (i < 0) {
+        SimulationItem::setToolTip(QString());
+        return;
+    }
+
+    if (!m_shown[i]) {
+        SimulationItem::setToolTip(QString("<b><u>Récepteur</u></b><br/>"
+                                           "<b><i>%1</i></b>")
+                                   .arg(m_antenna->getAntennaName()));
+        return;
+    }
+
+    SimulationItem::setToolTip(QString("<b><u>Récepteur</u></b><br/>"
+                                       "<b><i>%1</i></b><br/>"
+                                       "<b>Rayons incidents&nbsp;:</b> %2<br>"
+                                       "<b>Puissance&nbsp;:</b> %3&nbsp;dBm<br>"
+                                       "<b>Débit&nbsp;:</b> %4&nbsp;Mb/s")
+                               .arg(m_antenna->getAntennaName())
+                               .arg(m_paths_counts[i])
+                               .arg(SimulationData::convertPowerTodBm(m_powers[i]), 0, 'f', 2)
+                               .arg(PropagationModel::bitRate(m_powers[i]), 0, 'f', 2));
 }
 
 
@@ -444,4 +1038,25 @@ QPainterPath ReceiversArea::shape() const {
 
 void ReceiversArea::paint(QPainter *p, const QStyleOptionGraphicsItem *s, QWidget *w) {
     QGraphicsRectItem::paint(p, s, w);
+
+    if (m_results_dirty) {
+        updateResultsImage();
+    }
+
+    if (m_results_image.isNull()) {
+        return;
+    }
+
+    // Draw all the cells at once (without smoothing between them)
+    p->save();
+    p->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    p->drawImage(QGraphicsRectItem::rect(), m_results_image);
+    p->restore();
+
+    // Write the values only if they can be read
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(p->worldTransform());
+
+    if (RECEIVER_SIZE * lod >= AREA_VALUES_MIN_SIZE) {
+        paintValues(p, s->exposedRect);
+    }
 }
@@ -2,7 +2,7 @@
 #define RECEIVER_H
 
 #include <QGraphicsItem>
-#include <QMutex>
+#include <QImage>
 
 #include "interface/simulationitem.h"
 #include "raypath.h"
@@ -35,22 +35,22 @@ public:
 
     double getEfficiency() const;
     double getResistance() const;
-    vector<complex> getEffectiveHeight(double phi, double frequency) const;
+    cvector3 getEffectiveHeight(double phi, double frequency) const;
     double getGain(double phi) const;
 
     QRectF boundingRect() const override;
     QPainterPath shape() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
 
-    void setFlat(bool flat);
     void paintShaped(QPainter *painter);
-    void paintFlat(QPainter *painter);
 
     void reset();
     void addRayPath(RayPath *rp);
+    void addReceivedPower(double power, int paths_count);
     QList<RayPath*> getRayPaths();
 
     double receivedPower();
+    int receivedPathsCount();
     double getBitRate();
 
     void showResults(ResultType::ResultType type, int min, int max);
@@ -64,15 +64,13 @@ private:
 
     QList<RayPath*> m_received_rays;
     double m_received_power;
+    int m_received_paths_count;
 
     ResultType::ResultType m_res_type;
     int m_res_min;
     int m_res_max;
 
-    bool m_flat;
     bool m_show_result;
-
-    QMutex m_mutex;
 };
 
 // Operator overload to write objects from the Receiver class into a files
@@ -80,24 +78,104 @@ QDataStream &operator>>(QDataStream &in, Receiver *&r);
 QDataStream &operator<<(QDataStream &out, Receiver *r);
 
 
+// State of a cell of an area in an adaptive sampling
+namespace SampleState {
+enum SampleState {
+    None,           // Not sampled yet
+    Computed,       // Computed by the simulation
+    Interpolated    // Interpolated from the corners of its cell
+};
+}
+
+/**
+ * This item is the area of a simulation, with a receiver per square meter (a cell).
+ *
+ * The cells are not Receiver objects: the area keeps the results of all of them in
+ * grids (index x * rows + y, see cellIndex()), with the same antenna for every cell.
+ * They are drawn at once from a raster image (one pixel per cell, colored from a color
+ * table). The values of the cells are only written when the view is zoomed enough
+ * to read them, and the tooltip of a cell is made when the mouse hovers it.
+ */
 class ReceiversArea : public QGraphicsRectItem, public SimulationItem
 {
 public:
     ReceiversArea();
     ~ReceiversArea();
 
-    QList<Receiver*> getReceiversList();
+    Antenna *getAntenna();
+    double getRotation();
+
+    int cellsCount() const;
+    int cellIndex(int x, int y) const;
+    QPointF cellRealPos(int cell) const;
+
+    vector<int> getCellsList();
+    vector<int> getCellsList(int step);
+    vector<int> getRefinedCellsList(int step);
+    void setGridSize(int step);
+
+    void resetSampling();
+    void cancelSampling(int step);
+    vector<int> getSampledCellsList(int step, double tolerance);
+    void showInterpolatedResults(ResultType::ResultType type, int min, int max);
+    int interpolatedCount();
     void setArea(AntennaType::AntennaType type, QRectF area);
 
+    void resetCell(int cell);
+    void addReceivedPower(int cell, double power, int paths_count);
+    double receivedPower(int cell) const;
+    int receivedPathsCount(int cell) const;
+    void showResults(const vector<int> &cells, ResultType::ResultType type, int min, int max);
+
     QRectF boundingRect() const override;
     QPainterPath shape() const override;
     void paint(QPainter *p, const QStyleOptionGraphicsItem *s, QWidget *w) override;
 
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
+
 private:
-    void createReceivers(AntennaType::AntennaType type, QRectF area);
-    void deleteReceivers();
+    void createCells(AntennaType::AntennaType type, QRectF area);
+    void deleteCells();
+
+    void resultsChanged();
+    static const QVector<QRgb> &colorTable();
+    double resultValue(int cell) const;
+    void updateResultsImage();
+    void paintValues(QPainter *p, const QRectF &exposed_rect);
+    int cellIndexAt(QPointF pos);
+
+    bool uniformCell(int x, int y, int size, double tolerance);
+    double interpolatedPower(int x, int y, int cell_x, int cell_y, int size);
+
+    // Antenna of all the cells
+    Antenna *m_antenna;
+    double m_rotation_angle;
+
+    int m_rows_count;
+    int m_columns_count;
+
+    // Results of the cells: received power, number of ray paths, if they are shown,
+    // and size of the square of cells they cover (a cell of a coarse grid covers the
+    // cells that are not computed yet)
+    vector<double> m_powers;
+    vector<int> m_paths_counts;
+    vector<bool> m_shown;
+    vector<int> m_sizes;
+
+    // Type and range of the shown results
+    ResultType::ResultType m_res_type;
+    int m_res_min;
+    int m_res_max;
+
+    // Color of each cell (one pixel per cell, a coarse cell colors the pixels it covers),
+    // value of each shown cell (NaN if not shown)
+    QImage m_results_image;
+    vector<float> m_values;
+    bool m_results_dirty;
 
-    QList<Receiver*> m_receivers_list;
+    // Sample state of each cell
+    vector<unsigned char> m_samples;
 };
 
 #endif // RECEIVER_H
@@ -0,0 +1,263 @@
+#include "resultscache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+// Identifier at the start of the results files ("RTRS")
+#define RESULTS_CACHE_MAGIC 0x52545253
+
+// Extension of the results files
+#define RESULTS_CACHE_SUFFIX "rtres"
+
+
+ResultsCache::ResultsCache()
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results";
+    m_max_size = RESULTS_CACHE_MAX_SIZE;
+}
+
+QString ResultsCache::directory() const {
+    return m_directory;
+}
+
+void ResultsCache::setDirectory(QString dir) {
+    m_directory = dir;
+}
+
+qint64 ResultsCache::maxSize() const {
+    return m_max_size;
+}
+
+/**
+ * @brief ResultsCache::setMaxSize
+ * @param size
+ *
+ * This function sets the max total size of the results files (in bytes),
+ * and removes the least recently used files over this size.
+ */
+void ResultsCache::setMaxSize(qint64 size) {
+    m_max_size = size;
+    evict();
+}
+
+/**
+ * @brief ResultsCache::filePath
+ * @param key
+ * @return
+ *
+ * Returns the path of the results file of this key
+ */
+QString ResultsCache::filePath(const QByteArray &key) const {
+    return QDir(m_directory).filePath(QString::fromLatin1(key.toHex()) + "." + RESULTS_CACHE_SUFFIX);
+}
+
+/**
+ * @brief ResultsCache::contains
+ * @param key
+ * @return
+ *
+ * Returns true if there is a results file for this key (without checking its content)
+ */
+bool ResultsCache::contains(const QByteArray &key) const {
+    return QFile::exists(filePath(key));
+}
+
+/**
+ * @brief ResultsCache::isValid
+ * @param key
+ * @return
+ *
+ * Returns true if the results file of this key can be loaded: it was written by
+ * the same version of the engine, for the same key, and its checksum is correct.
+ */
+bool ResultsCache::isValid(const QByteArray &key) const {
+    QByteArray payload;
+    return readFile(key, &payload);
+}
+
+/**
+ * @brief ResultsCache::readFile
+ * @param key     : The key of the results
+ * @param payload : Set to the serialized results
+ * @return        : False if there is no valid file for this key
+ *
+ * This function reads and checks the results file of a key.
+ */
+bool ResultsCache::readFile(const QByteArray &key, QByteArray *payload) const {
+    QFile file(filePath(key));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+
+    quint32 magic;
+    qint32 version;
+    QByteArray file_key;
+    QByteArray checksum;
+
+    in >> magic >> version >> file_key >> *payload >> checksum;
+    file.close();
+
+    return in.status() == QDataStream::Ok &&
+            magic == RESULTS_CACHE_MAGIC &&
+            version == ENGINE_VERSION &&
+            file_key == key &&
+            checksum == QCryptographicHash::hash(*payload, QCryptographicHash::Sha1);
+}
+
+/**
+ * @brief ResultsCache::load
+ * @param key     : The key of the results
+ * @param results : Set to the cached results
+ * @return        : False if there are no valid results for this key
+ *
+ * This function loads the results of a key. An invalid results file is removed.
+ */
+bool ResultsCache::load(const QByteArray &key, CachedResults *results) {
+    QByteArray payload;
+
+    if (!readFile(key, &payload)) {
+        if (contains(key)) {
+            QFile::remove(filePath(key));
+        }
+        return false;
+    }
+
+    QDataStream in(payload);
+
+    qint32 receivers_count;
+    in >> results->pruned_branches >> results->pruned_nodes >> receivers_count;
+
+    results->receivers.clear();
+
+    for (int r = 0 ; r < receivers_count && in.status() == QDataStream::Ok ; r++) {
+        CachedReceiver re;
+        qint32 paths_count;
+        qint32 ray_paths_count;
+
+        in >> re.power >> paths_count >> re.pruned_power >> ray_paths_count;
+        re.paths_count = paths_count;
+
+        for (int i = 0 ; i < ray_paths_count && in.status() == QDataStream::Ok ; i++) {
+            CachedRayPath rp;
+            qint32 emitter;
+
+            in >> emitter >> rp.power >> rp.rays;
+            rp.emitter = emitter;
+
+            re.ray_paths.append(rp);
+        }
+
+        results->receivers.append(re);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        results->receivers.clear();
+        return false;
+    }
+
+    // Mark this file as recently used
+    QFile file(filePath(key));
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+
+    return true;
+}
+
+/**
+ * @brief ResultsCache::store
+ * @param key     : The key of the results
+ * @param results : The results to store
+ * @return        : False if the file can't be written
+ *
+ * This function writes the results of a key (the file is replaced at once, so a file
+ * is never partially written), then removes the least recently used files if needed.
+ */
+bool ResultsCache::store(const QByteArray &key, const CachedResults &results) {
+    if (!QDir().mkpath(m_directory)) {
+        return false;
+    }
+
+    // Serialize the results
+    QByteArray payload;
+    QDataStream data(&payload, QIODevice::WriteOnly);
+
+    data << results.pruned_branches << results.pruned_nodes << (qint32) results.receivers.size();
+
+    foreach (const CachedReceiver &re, results.receivers) {
+        data << re.power << (qint32) re.paths_count << re.pruned_power << (qint32) re.ray_paths.size();
+
+        foreach (const CachedRayPath &rp, re.ray_paths) {
+            data << (qint32) rp.emitter << rp.power << rp.rays;
+        }
+    }
+
+    // Write the file
+    QSaveFile file(filePath(key));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << (quint32) RESULTS_CACHE_MAGIC << (qint32) ENGINE_VERSION << key << payload;
+    out << QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+
+    if (!file.commit()) {
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+/**
+ * @brief ResultsCache::evict
+ *
+ * This function removes the least recently used results files, so the total size
+ * of the kept files is not more than the max size.
+ */
+void ResultsCache::evict() {
+    // Files sorted from the most recently used
+    const QFileInfoList files = QDir(m_directory).entryInfoList(
+                QStringList() << QString("*.") + RESULTS_CACHE_SUFFIX,
+                QDir::Files,
+                QDir::Time);
+
+    qint64 total_size = 0;
+
+    foreach (const QFileInfo &info, files) {
+        // Only the kept files count in the total size
+        if (total_size + info.size() > m_max_size) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+
+        total_size += info.size();
+    }
+}
+
+/**
+ * @brief ResultsCache::clear
+ *
+ * This function removes all the results files
+ */
+void ResultsCache::clear() {
+    const QFileInfoList files = QDir(m_directory).entryInfoList(
+                QStringList() << QString("*.") + RESULTS_CACHE_SUFFIX,
+                QDir::Files);
+
+    foreach (const QFileInfo &info, files) {
+        QFile::remove(info.absoluteFilePath());
+    }
+}
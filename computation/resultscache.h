@@ -0,0 +1,77 @@
+#ifndef RESULTSCACHE_H
+#define RESULTSCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QLineF>
+#include <QList>
+
+#include "constants.h"
+
+// Max total size of the cached results files (in bytes)
+#define RESULTS_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+// Ray path of a cached receiver (lines in meters)
+struct CachedRayPath
+{
+    int emitter;            // Index of the emitter in the compiled scene
+    double power;
+    QList<QLineF> rays;
+};
+
+// Results of a receiver (ray paths only if they are shown)
+struct CachedReceiver
+{
+    double power;
+    int paths_count;
+    double pruned_power;    // Estimated pruning error of this receiver
+    QList<CachedRayPath> ray_paths;
+};
+
+// Results of a simulation (same order of receivers as the compiled scene)
+struct CachedResults
+{
+    qint64 pruned_branches = 0;
+    qint64 pruned_nodes = 0;
+    QList<CachedReceiver> receivers;
+};
+
+
+/**
+ * This class stores the results of the simulations in a cache directory, one file per
+ * simulation, named by its key (hash of the compiled scene and of the simulation settings).
+ *
+ * Each file starts with the version of the engine and its key, and ends with a checksum
+ * of the results, so a stale or damaged file is never loaded (it is removed instead).
+ * When the total size of the files goes over the max size, the least recently used
+ * ones are removed (the modification time of a file is updated when it is loaded).
+ */
+class ResultsCache
+{
+public:
+    ResultsCache();
+
+    QString directory() const;
+    void setDirectory(QString dir);
+
+    qint64 maxSize() const;
+    void setMaxSize(qint64 size);
+
+    bool contains(const QByteArray &key) const;
+    bool isValid(const QByteArray &key) const;
+
+    bool load(const QByteArray &key, CachedResults *results);
+    bool store(const QByteArray &key, const CachedResults &results);
+
+    void clear();
+
+private:
+    QString filePath(const QByteArray &key) const;
+    bool readFile(const QByteArray &key, QByteArray *payload) const;
+    void evict();
+
+    QString m_directory;
+    qint64 m_max_size;
+};
+
+#endif // RESULTSCACHE_H
@@ -1,5 +1,9 @@
 #include "simulationdata.h"
 
+#include <QSet>
+
+#include <algorithm>
+
 // The max amplitude for the data's color
 #define PEAK_COLOR_LIGHT 255
 #define PEAK_COLOR_DARK 240
@@ -7,11 +11,16 @@
 // The default max number of reflections
 #define MAX_REFLECTIONS_COUNT_DEFAULT 3
 
+// The default power under which the ray paths can be pruned (in dBm)
+#define PRUNING_THRESHOLD_DEFAULT -120.0
+
 
 SimulationData::SimulationData() : QObject()
 {
     m_reflections_count = MAX_REFLECTIONS_COUNT_DEFAULT;
     m_simulation_type = SimType::PointReceiver;
+    m_pruning_enabled = false;
+    m_pruning_threshold = PRUNING_THRESHOLD_DEFAULT;
 }
 
 SimulationData::SimulationData(QList<Wall*> w_l, QList<Emitter*> e_l, QList<Receiver*> r_l) : SimulationData()
@@ -20,9 +29,17 @@ SimulationData::SimulationData(QList<Wall*> w_l, QList<Emitter*> e_l, QList<Rece
 }
 
 void SimulationData::setInitData(QList<Wall*> w_l, QList<Emitter*> e_l, QList<Receiver*> r_l) {
-    m_wall_list = w_l;
-    m_emitter_list = e_l;
-    m_receiver_list = r_l;
+    reset();
+
+    foreach (Wall *w, w_l) {
+        attachWall(w);
+    }
+    foreach (Emitter *e, e_l) {
+        attachEmitter(e);
+    }
+    foreach (Receiver *r, r_l) {
+        attachReceiver(r);
+    }
 }
 
 // ---------------------------------------------------------------------------------------------- //
@@ -97,46 +114,194 @@ QRgb SimulationData::ratioToColor(qreal ratio, bool light) {
 
 // +++++++++++++++++++ WALLS / EMITTERS / RECEIVER LISTS MANAGEMENT FUNCTIONS +++++++++++++++++++ //
 
+/**
+ * @brief attachItem
+ * @param items : The items of this type
+ * @param item  : The item to add at the end of the list
+ */
+template<class T> static void attachItem(AttachedItems<T> &items, T *item) {
+    if (items.positions.contains(item)) {
+        return;
+    }
+
+    items.positions.insert(item, items.list.size());
+    items.orders.insert(item, items.next_order++);
+    items.list.append(item);
+}
+
+/**
+ * @brief detachItem
+ * @param items : The items of this type
+ * @param item  : The item to remove from the list
+ *
+ * The list is not searched, and the last item is moved to the position of the removed
+ * one, so only its position changes. The list is then out of the attach order until
+ * it is read (see sortedItems()).
+ */
+template<class T> static void detachItem(AttachedItems<T> &items, T *item) {
+    auto it = items.positions.find(item);
+
+    if (it == items.positions.end()) {
+        return;
+    }
+
+    const int i = it.value();
+    const int last = items.list.size() - 1;
+    items.positions.erase(it);
+    items.orders.remove(item);
+
+    if (i != last) {
+        T *moved = items.list.at(last);
+        items.list[i] = moved;
+        items.positions[moved] = i;
+        items.sorted = false;
+    }
+
+    items.list.removeLast();
+}
+
+/**
+ * @brief detachItems
+ * @param items   : The items of this type
+ * @param removed : The items to remove from the list
+ *
+ * Same as detachItem() for each item (the cost doesn't depend on the size of the list).
+ */
+template<class T> static void detachItems(AttachedItems<T> &items, const QSet<T*> &removed) {
+    foreach (T *item, removed) {
+        detachItem(items, item);
+    }
+}
+
+/**
+ * @brief sortedItems
+ * @param items : The items of this type
+ * @return
+ *
+ * Returns the list of the items in the order they were attached (the order of the
+ * saved files and of the compiled scene). The list is only sorted back (and the
+ * positions updated) if an item was detached from its middle since the last read.
+ */
+template<class T> static const QList<T*> &sortedItems(AttachedItems<T> &items) {
+    if (items.sorted) {
+        return items.list;
+    }
+
+    std::sort(items.list.begin(), items.list.end(), [&](T *a, T *b) {
+        return items.orders.value(a) < items.orders.value(b);
+    });
+
+    for (int i = 0 ; i < items.list.size() ; i++) {
+        items.positions[items.list.at(i)] = i;
+    }
+
+    items.sorted = true;
+    return items.list;
+}
+
 void SimulationData::attachWall(Wall *w) {
-    m_wall_list.append(w);
+    attachItem(m_walls, w);
+    m_editor_index.insert(w);
 }
 
 void SimulationData::attachEmitter(Emitter *e) {
-    m_emitter_list.append(e);
+    attachItem(m_emitters, e);
+    m_editor_index.insert(e);
 }
 
 void SimulationData::attachReceiver(Receiver *r) {
-    m_receiver_list.append(r);
+    attachItem(m_receivers, r);
+    m_editor_index.insert(r);
 }
 
 void SimulationData::detachWall(Wall *w) {
-    m_wall_list.removeAll(w);
+    detachItem(m_walls, w);
+    m_editor_index.remove(w);
 }
 
 void SimulationData::detachEmitter(Emitter *e) {
-    m_emitter_list.removeAll(e);
+    detachItem(m_emitters, e);
+    m_editor_index.remove(e);
 }
 
 void SimulationData::detachReceiver(Receiver *r) {
-    m_receiver_list.removeAll(r);
+    detachItem(m_receivers, r);
+    m_editor_index.remove(r);
+}
+
+/**
+ * @brief SimulationData::detachItems
+ * @param items
+ *
+ * This function removes these items (walls, emitters or receivers) from the
+ * simulation data. The other items of the list are ignored.
+ */
+void SimulationData::detachItems(QList<SimulationItem*> items) {
+    QSet<Wall*> walls;
+    QSet<Emitter*> emitters;
+    QSet<Receiver*> receivers;
+
+    foreach (SimulationItem *item, items) {
+        if (dynamic_cast<Wall*>(item)) {
+            walls.insert((Wall*) item);
+        }
+        else if (dynamic_cast<Emitter*>(item)) {
+            emitters.insert((Emitter*) item);
+        }
+        else if (dynamic_cast<Receiver*>(item)) {
+            receivers.insert((Receiver*) item);
+        }
+        else {
+            continue;
+        }
+
+        m_editor_index.remove(item);
+    }
+
+    ::detachItems(m_walls, walls);
+    ::detachItems(m_emitters, emitters);
+    ::detachItems(m_receivers, receivers);
+}
+
+/**
+ * @brief SimulationData::updateItem
+ * @param item
+ *
+ * This function must be called when the bounding rect of an attached item changes
+ * without moving it (as the antenna of an emitter), so it is indexed again.
+ */
+void SimulationData::updateItem(SimulationItem *item) {
+    m_editor_index.update(item);
 }
 
 void SimulationData::reset() {
-    m_wall_list.clear();
-    m_emitter_list.clear();
-    m_receiver_list.clear();
+    m_walls = AttachedItems<Wall>();
+    m_emitters = AttachedItems<Emitter>();
+    m_receivers = AttachedItems<Receiver>();
+
+    m_editor_index.clear();
 }
 
 QList<Wall*> SimulationData::getWallsList() {
-    return m_wall_list;
+    return sortedItems(m_walls);
 }
 
 QList<Emitter*> SimulationData::getEmittersList() {
-    return m_emitter_list;
+    return sortedItems(m_emitters);
 }
 
 QList<Receiver*> SimulationData::getReceiverList() {
-    return m_receiver_list;
+    return sortedItems(m_receivers);
+}
+
+/**
+ * @brief SimulationData::editorIndex
+ * @return
+ *
+ * Returns the spatial index of the walls, emitters and receivers
+ */
+const EditorIndex *SimulationData::editorIndex() const {
+    return &m_editor_index;
 }
 
 int SimulationData::maxReflectionsCount() {
@@ -159,6 +324,35 @@ void SimulationData::setSimulationType(SimType::SimType t) {
     m_simulation_type = t;
 }
 
+/**
+ * @brief SimulationData::pruningEnabled
+ * @return
+ *
+ * Returns true if the branches of reflections whose power can't reach
+ * the pruning threshold are skipped during the simulation
+ */
+bool SimulationData::pruningEnabled() {
+    return m_pruning_enabled;
+}
+
+void SimulationData::setPruningEnabled(bool enabled) {
+    m_pruning_enabled = enabled;
+}
+
+/**
+ * @brief SimulationData::pruningThreshold
+ * @return
+ *
+ * Returns the power under which the ray paths can be pruned (in dBm)
+ */
+double SimulationData::pruningThreshold() {
+    return m_pruning_threshold;
+}
+
+void SimulationData::setPruningThreshold(double threshold) {
+    m_pruning_threshold = threshold;
+}
+
 // ---------------------------------------------------------------------------------------------- //
 
 // +++++++++++++++++++++++++++ SIMULATION DATA FILE WRITING FUNCTIONS +++++++++++++++++++++++++++ //
@@ -178,9 +372,20 @@ QDataStream &operator>>(QDataStream &in, SimulationData *sd) {
     in >> max_refl_count;
     in >> sim_type;
 
+    // The pruning settings are not in the files saved by the previous versions
+    bool pruning_enabled = false;
+    double pruning_threshold = PRUNING_THRESHOLD_DEFAULT;
+
+    if (!in.atEnd()) {
+        in >> pruning_enabled;
+        in >> pruning_threshold;
+    }
+
     sd->setInitData(walls_list, emitters_list, receiver_list);
     sd->setReflectionsCount(max_refl_count);
     sd->setSimulationType((SimType::SimType) sim_type);
+    sd->setPruningEnabled(pruning_enabled);
+    sd->setPruningThreshold(pruning_threshold);
 
     return in;
 }
@@ -191,6 +396,8 @@ QDataStream &operator<<(QDataStream &out, SimulationData *sd) {
     out << sd->getReceiverList();
     out << sd->maxReflectionsCount();
     out << (int) sd->simulationType();
+    out << sd->pruningEnabled();
+    out << sd->pruningThreshold();
 
     return out;
 }
@@ -2,10 +2,12 @@
 #define SIMULATIONDATA_H
 
 #include <QObject>
+#include <QHash>
 
 #include "walls.h"
 #include "emitter.h"
 #include "receiver.h"
+#include "editorindex.h"
 
 
 namespace SimType {
@@ -15,6 +17,18 @@ enum SimType {
 };
 }
 
+// Items of a type, with the position of each item in the list (to detach it without
+// searching the list) and the order they were attached in. The list is out of the attach
+// order after an item is detached from its middle (the last item is moved there).
+template<class T> struct AttachedItems
+{
+    QList<T*> list;
+    QHash<T*, int> positions;
+    QHash<T*, quint64> orders;
+    quint64 next_order = 0;
+    bool sorted = true;
+};
+
 class SimulationData : public QObject
 {
     Q_OBJECT
@@ -37,6 +51,8 @@ public:
     void detachWall(Wall *w);
     void detachEmitter(Emitter *e);
     void detachReceiver(Receiver *r);
+    void detachItems(QList<SimulationItem*> items);
+    void updateItem(SimulationItem *item);
 
     void reset();
 
@@ -44,21 +60,34 @@ public:
     QList<Emitter*> getEmittersList();
     QList<Receiver*> getReceiverList();
 
+    const EditorIndex *editorIndex() const;
+
     int maxReflectionsCount();
     SimType::SimType simulationType();
 
+    bool pruningEnabled();
+    double pruningThreshold();
+
 public slots:
     void setReflectionsCount(int cnt);
     void setSimulationType(SimType::SimType t);
 
+    void setPruningEnabled(bool enabled);
+    void setPruningThreshold(double threshold);
+
 private:
     // Lists of all walls/emitters/recivers on the map
-    QList<Wall*> m_wall_list;
-    QList<Emitter*> m_emitter_list;
-    QList<Receiver*> m_receiver_list;
+    AttachedItems<Wall> m_walls;
+    AttachedItems<Emitter> m_emitters;
+    AttachedItems<Receiver> m_receivers;
+
+    EditorIndex m_editor_index;
 
     int m_reflections_count;
     SimType::SimType m_simulation_type;
+
+    bool m_pruning_enabled;
+    double m_pruning_threshold;
 };
 
 // Operator overload to write the simulation data into a file
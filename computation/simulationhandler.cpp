@@ -1,19 +1,77 @@
 #include "simulationhandler.h"
 
 #include <QDebug>
+#include <QDataStream>
+#include <QCryptographicHash>
+
+#include <algorithm>
+
+// Smallest number of work items given to a computation unit at once
+#define WORK_MIN_CHUNK 64
+// Number of chunks per thread in which the remaining work is split
+#define WORK_CHUNKS_PER_THREAD 4
 
 SimulationHandler::SimulationHandler()
 {
     m_simulation_data = new SimulationData();
+    m_compiled_scene = nullptr;
+    m_model = nullptr;
+    m_area = nullptr;
     m_sim_started = false;
     m_sim_cancelling = false;
-    m_init_cu_count = 0;
+    m_work_total = 0;
+    m_pruning_threshold = 0;
+    m_power_only = false;
+    m_pruned_branches = 0;
+    m_pruned_nodes = 0;
+    m_incremental = false;
+    m_keep_paths = false;
+    m_incremental_run = false;
+    m_kept_reflections = 0;
+    m_paths_valid = false;
+    m_paths_pruning_threshold = 0;
+    m_orders_count = 0;
+    m_orders_valid = false;
+    m_refined_cells_count = -1;
+    m_refined_pruned_branches = 0;
+    m_refined_pruned_nodes = 0;
+    m_work_pairs_total = 0;
+    m_cache_enabled = false;
+    m_results_cached = false;
+}
+
+SimulationHandler::~SimulationHandler()
+{
+    delete m_model;
+    delete m_compiled_scene;
 }
 
 SimulationData *SimulationHandler::simulationData() {
     return m_simulation_data;
 }
 
+/**
+ * @brief SimulationHandler::compiledScene
+ * @return
+ *
+ * This function returns the read-only snapshot of the scene used by the current
+ * (or last) simulation, or nullptr if no simulation was started.
+ */
+const CompiledScene *SimulationHandler::compiledScene() {
+    return m_compiled_scene;
+}
+
+/**
+ * @brief SimulationHandler::propagationModel
+ * @return
+ *
+ * This function returns the computation core used by the current (or last) simulation,
+ * or nullptr if no simulation was started.
+ */
+const PropagationModel *SimulationHandler::propagationModel() {
+    return m_model;
+}
+
 /**
  * @brief SimulationHandler::getRayPathsList
  * @return
@@ -31,6 +89,101 @@ QList<RayPath*> SimulationHandler::getRayPathsList() {
     return ray_paths;
 }
 
+/**
+ * @brief SimulationHandler::setThreadsCount
+ * @param count
+ *
+ * This function sets the max number of threads used by the simulation
+ * (the default is the number of processor cores)
+ */
+void SimulationHandler::setThreadsCount(int count) {
+    m_threadpool.setMaxThreadCount(max(count, 1));
+}
+
+int SimulationHandler::threadsCount() {
+    return m_threadpool.maxThreadCount();
+}
+
+/**
+ * @brief SimulationHandler::setIncrementalUpdates
+ * @param enabled
+ *
+ * This function enables the incremental updates: the ray paths of a simulation are kept
+ * (with the walls they touch), so the next simulation only computes the ray paths
+ * affected by the changes of the scene (disabled by default).
+ * Only the ray paths of the point receivers are kept. The cells of an area only keep
+ * their received power for each order of reflection (finding the ray paths affected by
+ * a wall needs their lines), so an area simulation is only updated when the reflections
+ * count changes, and is computed again after any change of the scene.
+ */
+void SimulationHandler::setIncrementalUpdates(bool enabled) {
+    m_incremental = enabled;
+
+    if (!enabled) {
+        resetComputedData();
+    }
+}
+
+bool SimulationHandler::incrementalUpdates() {
+    return m_incremental;
+}
+
+/**
+ * @brief SimulationHandler::lastUpdateIncremental
+ * @return
+ *
+ * Returns true if the last simulation only updated the ray paths of the previous one
+ */
+bool SimulationHandler::lastUpdateIncremental() {
+    return m_incremental_run;
+}
+
+/**
+ * @brief SimulationHandler::setResultsCacheEnabled
+ * @param enabled
+ *
+ * This function enables the cache of the results: the results of each simulation are
+ * written into the cache directory, and a simulation of the same scene (with the same
+ * settings) loads them instead of computing them (disabled by default)
+ */
+void SimulationHandler::setResultsCacheEnabled(bool enabled) {
+    m_cache_enabled = enabled;
+}
+
+bool SimulationHandler::resultsCacheEnabled() {
+    return m_cache_enabled;
+}
+
+ResultsCache *SimulationHandler::resultsCache() {
+    return &m_results_cache;
+}
+
+/**
+ * @brief SimulationHandler::lastResultsCached
+ * @return
+ *
+ * Returns true if the results of the last simulation were loaded from the cache
+ */
+bool SimulationHandler::lastResultsCached() {
+    return m_results_cached;
+}
+
+/**
+ * @brief SimulationHandler::receivedPathsCount
+ * @return
+ *
+ * This function returns the number of ray paths received by all the receivers
+ */
+int SimulationHandler::receivedPathsCount() {
+    int count = 0;
+
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        count += receivedPathsCount(r);
+    }
+
+    return count;
+}
+
 /**
  * @brief SimulationHandler::isRunning
  * @return
@@ -47,534 +200,523 @@ bool SimulationHandler::isRunning() {
 /**************************************************************************************************/
 
 /**
- * @brief SimulationHandler::mirror
- *
- * This function returns the coordinates of the image of the 'source' point
- * after an axial symmetry through the wall.
+ * @brief SimulationHandler::computeRayPath
  *
- * WARNING: the y axis is upside down in the graphics scene !
+ * This function computes the ray path for a combination reflections, and adds it to the
+ * results. Its lines are appended to the lines of the results (no object is allocated
+ * per ray path, the RayPath objects are created in the GUI thread by the merge).
  *
- * @param source : The position of the source whose image is calculated
- * @param wall   : The wall over which compute the image
- * @return       : The coordinates of the image
+ * @param emitter  : The index of the emitter for this ray path
+ * @param receiver : The index of the receiver for this ray path
+ * @param item     : The work item index of this ray path
+ * @param results  : The results to fill
+ * @param images   : The list of reflection images computed for this ray path
+ * @param walls    : The list of walls indexes that form a combination of reflections
+ * @return         : False if the ray path is invalid
  */
-QPointF SimulationHandler::mirror(QPointF source, Wall *wall) {
-    // Get the angle of the wall to the horizontal axis
-    double theta = wall->getRealLine().angle() * M_PI / 180.0 - M_PI / 2.0;
+bool SimulationHandler::computeRayPath(
+        int emitter,
+        int receiver,
+        qint64 item,
+        ComputationResults *results,
+        const vector<QPointF> &images,
+        const vector<int> &walls)
+{
+    // The lines buffer is reused by each thread to avoid allocations
+    static thread_local vector<QLineF> rays;
+    double power;
 
-    // Translate the origin of the coordinates system on the base of the wall
-    double x = source.x() - wall->getRealLine().p1().x();
-    double y = source.y() - wall->getRealLine().p1().y();
+    const CompiledEmitter &em = m_compiled_scene->getEmitters()[emitter];
+    const CompiledReceiver &re = m_compiled_scene->getReceivers()[receiver];
 
-    // We use a rotation matrix :
-    //   x' =  x*cos(θ) - y*sin(θ)
-    //   y' = -x*sin(θ) - y*cos(θ)
-    // to set the y' axis along the wall, so the image is at the opposite of the x' coordinate
-    // in the new coordinates system.
-    double x_p =  x*cos(theta) - y*sin(theta);
-    double y_p = -x*sin(theta) - y*cos(theta);
+    if (!m_model->traceRayPath(em, re, images, walls, &rays, &power)) {
+        return false;
+    }
 
-    // Rotate back to the original coordinates system
-    QPointF rel_pos = QPointF(-x_p*cos(theta) - y_p*sin(theta), x_p*sin(theta) - y_p*cos(theta));
+    results->ray_paths.push_back({item, receiver, emitter, power, (int) results->rays.size(), (int) rays.size()});
+    results->rays.insert(results->rays.end(), rays.begin(), rays.end());
 
-    // Translate back to the original coordinates system
-    return rel_pos + wall->getRealLine().p1();
+    return true;
 }
 
-
 /**
- * @brief SimulationHandler::computeReflection
+ * @brief SimulationHandler::computeReflections
  *
- * This function computes the reflection coefficient for the reflection of
- * an incident ray on a wall.
- * The coefficient returned is 3-dimensionnal:
- *  - the two first components are the same and are the coefficient
- *    for a parallel polarization
- *  - the last component is the coefficient for the othogonal polarization
+ * This function computes the ray path to the receiver for each node in the range
+ * [first, last) of the emitter's image tree.
+ * The computed ray paths are appended to the 'results' list, with their work item index
  *
- * @param em     : The emitter (source of this ray)
- * @param w      : The reflection wall
- * @param ray_in : The incident ray
- * @return       : The reflection coefficient for this reflection
+ * @param emitter  : The index of the emitter for these ray paths
+ * @param receiver : The index of the receiver for these ray paths
+ * @param first    : The index of the first node in the emitter's image tree
+ * @param last     : The index after the last node in the emitter's image tree
+ * @param item     : The work item index of the node 'first'
+ * @param results  : The results to fill (ray paths and pruning report)
  */
-vector<complex> SimulationHandler::computeReflection(Emitter *em, Wall *w, QLineF in_ray) {
-    // Get the pulsation of the emitter
-    double omega = em->getFrequency()*2*M_PI;
+void SimulationHandler::computeReflections(
+        int emitter,
+        int receiver,
+        int first,
+        int last,
+        qint64 item,
+        ComputationResults *results)
+{
+    const CompiledReceiver &re = m_compiled_scene->getReceivers()[receiver];
 
-    // Get the properties of the reflection wall
-    double e_r = w->getRelPermitivity();
-    double sigma = w->getConductivity();
+    const int pair = receiver * (int) m_compiled_scene->getEmitters().size() + emitter;
 
-    // Compute the properties of the mediums (air and wall)
-    complex epsilon_tilde = e_r*EPSILON_0 - 1i*sigma/omega;
-    complex Z1 = Z_0;
-    complex Z2 = sqrt(MU_0/epsilon_tilde);
+    // Only sum the power of the ray paths of each order in an area simulation (the ray
+    // paths are neither shown nor kept, a partial update only computes the new orders)
+    if (m_power_only) {
+        static thread_local vector<ReceivedPower> orders;
+        orders.assign(m_compiled_scene->reflectionsCount() + 1, ReceivedPower());
 
-    // Compute the incident and transmission angles
-    double theta_i = w->getNormalAngleTo(in_ray);
-    double theta_t = asin(real(Z2/Z1) * sin(theta_i));
+        const int min_order = (m_pairs_update[pair] == PairUpdate::Partial ? m_kept_reflections : 0);
 
-    // Length of the travel of the ray in the wall
-    double s = w->getThickness() / cos(theta_t);
+        ReceivedPower received;
+        m_model->reflectionsPower(emitter, re, first, last, m_pruning_threshold, &received, min_order, orders.data());
 
-    // Compute the reflection coefficient for an orthogonal
-    // polarization (equation 8.39)
-    complex Gamma_orth = (Z2*cos(theta_i) - Z1*cos(theta_t)) / (Z2*cos(theta_i) + Z1*cos(theta_t));
-    // Compute the reflection coefficient for a parallel
-    // polarization (equation 8.32)
-    complex Gamma_para = (Z2*cos(theta_t) - Z1*cos(theta_i)) / (Z2*cos(theta_t) + Z1*cos(theta_i));
+        // Keep the sums of the powers of this range in the results
+        for (int k = 1 ; k < (int) orders.size() ; k++) {
+            if (orders[k].paths_count > 0) {
+                results->powers.push_back({item, receiver, k, orders[k].power, orders[k].paths_count});
+            }
+        }
 
-    // Propagation constants (m -> in wall, 0 -> in air)
-    complex gamma_m = 1i*omega*sqrt(MU_0*epsilon_tilde);
-    complex gamma_0 = 1i*omega*sqrt(MU_0*EPSILON_0);
+        addPruningReport(receiver, received, results);
+        return;
+    }
 
-    // Compute the reflection coefficient for the orthogonal polarization (equation 8.43)
-    complex reflection_orth =
-            Gamma_orth +
-            (1.0 - pow(Gamma_orth, 2.0)) *
-            Gamma_orth * exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)) /
-            (1.0 - pow(Gamma_orth, 2.0) *
-             exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)));
+    const ImageTree *tree = m_model->imageTree(emitter);
+    const vector<ImageNode> &nodes = tree->getNodes();
+    const vector<CompiledWall> &walls = m_compiled_scene->getWalls();
+    const CompiledEmitter &em = m_compiled_scene->getEmitters()[emitter];
+    const double power_bound = m_model->powerBound(em, re);
 
-    // Compute the reflection coefficient for the parallel polarization (equation 8.43)
-    complex reflection_para =
-            Gamma_para +
-            (1.0 - pow(Gamma_para, 2.0)) *
-            Gamma_para * exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)) /
-            (1.0 - pow(Gamma_para, 2.0) *
-             exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)));
+    // For a partial update, only the new nodes (reflected on a new wall, or of a new
+    // reflection order) are computed (the other ray paths are kept)
+    const vector<bool> *new_nodes = nullptr;
 
-    // Return as a 3-D vector
-    return {
-        reflection_para,
-        reflection_para,
-        reflection_orth
-    };
-}
-
-/**
- * @brief SimulationHandler::computeTransmissons
- *
- * This function computes all the transmissions undergone by the 'ray', and returns
- * the total transmission coefficient.
- * The coefficient returned is 3-dimensionnal:
- *  - the two first components are the same and are the coefficient
- *    for a parallel polarization
- *  - the last component is the coefficient for the othogonal polarization
- *
- * @param em          : The emitter (source of this ray)
- * @param ray         : The ray for which to compute the transmissions
- * @param origin_wall : The wall from which this ray come from (reflection), or nullptr
- * @param target_wall : The wall to which this ray go to (reflection), or nullptr
- * @return            : The total transmission coefficient for all undergone transmissions
- */
-vector<complex> SimulationHandler::computeTransmissons(
-        Emitter *em,
-        QLineF ray,
-        Wall *origin_wall,
-        Wall *target_wall)
-{
-    // Get pulsation from the emitter
-    double omega = em->getFrequency()*2*M_PI;
+    if (m_pairs_update[pair] == PairUpdate::Partial) {
+        new_nodes = &m_new_nodes[emitter];
+    }
 
-    // Propagation constant (air)
-    complex gamma_0 = 1i*omega*sqrt(MU_0*EPSILON_0);
+    // The buffers are reused by each thread, so nothing is allocated per node once they
+    // reached the length of the longest chain (the results only grow by amortized steps).
+    static thread_local vector<QPointF> images_chain;
+    static thread_local vector<int> walls_chain;
+    static thread_local vector<QLineF> rays;
 
-    // Total transmission coefficient (for this ray)
-    vector<complex> total_coeff = {1,1,1};
+    // Pruning report of this range
+    ReceivedPower pruned;
 
-    // Loop over all walls of the scene and look for transmissions (intersection with ray)
-    foreach(Wall *w, simulationData()->getWallsList()) {
-        // No transmission through the origin or target wall (where this ray is reflected)
-        if (w == origin_wall || w == target_wall) {
-            continue;
-        }
+    // Skip the nodes of a branch pruned by a previous chunk (it is only counted there)
+    int start = first;
 
-        // Get the transmission point
-        QPointF pt;
-        QLineF::IntersectionType i_t = ray.intersects(w->getRealLine(), &pt);
+    if (m_pruning_threshold > 0 && first < last) {
+        const int ancestor = PropagationModel::prunedAncestor(nodes, first, re.position, power_bound, m_pruning_threshold);
 
-        // There is transmission if the intersection with the ray is
-        // on the wall (not on its extension)
-        if (i_t != QLineF::BoundedIntersection) {
-            continue;
+        if (ancestor >= 0) {
+            start = min(nodes[ancestor].end, last);
         }
+    }
 
-        // Get properties from the transmission wall
-        double e_r = w->getRelPermitivity();
-        double sigma = w->getConductivity();
-
-        // Compute the properties of the mediums (air and wall)
-        complex epsilon_tilde = e_r*EPSILON_0 - 1i*sigma/omega;
-        complex Z1 = Z_0;
-        complex Z2 = sqrt(MU_0/epsilon_tilde);
+    for (int i = start ; i < last ; i++) {
+        const ImageNode &node = nodes[i];
 
-        // Propagation constant (in this wall)
-        complex gamma_m = 1i*omega*sqrt(MU_0*epsilon_tilde);
+        // Power-bound pruning of the node's subtree
+        if (m_pruning_threshold > 0) {
+            const double bound = PropagationModel::nodePowerBound(node, re.position, power_bound);
 
-        // Compute the incident and transmission angles
-        double theta_i = w->getNormalAngleTo(ray);
-        double theta_t = asin(real(Z2/Z1)*sin(theta_i));
+            if (bound < m_pruning_threshold) {
+                // Count the whole subtree once, and skip its nodes in this chunk
+                // (the next chunks skip the rest of it)
+                pruned.pruned_branches++;
+                pruned.pruned_nodes += node.end - i;
+                pruned.pruned_power += bound * (node.end - i);
 
-        // Length of the travel of the ray in the wall
-        double s = w->getThickness() / cos(theta_t);
+                i = min(node.end, last) - 1;
+                continue;
+            }
+        }
 
-        // Compute the reflection coefficient for an orthogonal polarization (equation 8.39).
-        // The transmission coefficient is deduced from the reflection coefficient (equation 8.37).
-        complex Gamma_orth = (Z2*cos(theta_i)-Z1*cos(theta_t))/(Z2*cos(theta_i)+Z1*cos(theta_t));
+        if (new_nodes != nullptr && !(*new_nodes)[i]) {
+            continue;
+        }
 
-        // Compute the reflection coefficient for a parallel polarization (equation 8.32)
-        complex Gamma_para = (Z2*cos(theta_t)-Z1*cos(theta_i))/(Z2*cos(theta_t)+Z1*cos(theta_i));
+        // Compute the complete ray path only if the line from the image to the receiver
+        // crosses the wall of the last reflection (so the receiver is on the side of the source)
+        if (!walls[node.wall].crossedBy(node.image, re.position)) {
+            continue;
+        }
 
-        // Compute the transmission coefficient for the orthogonal polarization (equation 8.44)
-        complex transmission_orth =
-                (1.0 - pow(Gamma_orth, 2.0)) * exp(-gamma_m*s) /
-                (1.0 - pow(Gamma_orth, 2.0) *
-                 exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)));
+        // Get the sequence of images and walls of this node
+        tree->getChain(i, &images_chain, &walls_chain);
 
-        // Compute the transmission coefficient for the orthogonal polarization (equation 8.44)
-        complex transmission_para =
-                (1.0 - pow(Gamma_para, 2.0)) * exp(-gamma_m*s) /
-                (1.0 - pow(Gamma_para, 2.0) *
-                 exp(-2.0*gamma_m*s + 2.0*gamma_0*s * sin(theta_t) * sin(theta_i)));
+        // Keep the ray path with its node for the incremental updates
+        if (m_keep_paths) {
+            double power;
+            PathTerms terms;
 
-        // Return as a 3-D vector
-        vector<complex> coeff = {
-            transmission_para,
-            transmission_para,
-            transmission_orth
-        };
+            if (m_model->traceRayPath(em, re, images_chain, walls_chain, &rays, &power, &terms)) {
+                addComputedPath(item + (i - first), receiver, emitter, i, -1, power, terms, rays, results);
+            }
+            continue;
+        }
 
-        // Multiply the total transmission coefficient with this one
-        // The multiplication is made component by component (not a cross product).
-        total_coeff *= coeff;
+        // Compute the complete ray path for this set of reflections (kept in the results if valid)
+        computeRayPath(emitter, receiver, item + (i - first), results, images_chain, walls_chain);
     }
 
-    return total_coeff;
+    addPruningReport(receiver, pruned, results);
 }
 
 /**
- * @brief SimulationHandler::computeNominalElecField
- *
- * This function computes the "Nominal" electric field (equation 8.77).
- * So this is the electric field as if there were no reflection or transmission.
- * The electric field is returned in a 3-dimentionnal vector.
+ * @brief SimulationHandler::recomputePath
+ * @param index   : The index of the kept ray path in the list of ray paths to recompute
+ * @param item    : The work item index of this ray path
+ * @param results : The results to fill
  *
- * @param em    : The emitter (source of this ray)
- * @param e_ray : The ray coming out from the emitter
- * @param r_ray : The ray coming to the receiver
- * @param dn    : The total length of the ray path
- * @return      : The "Nominal" electric field
+ * This function recomputes a kept ray path whose lines cross a new or a removed wall
+ * (its reflections don't change, but its transmissions do).
  */
-vector<complex> SimulationHandler::computeNominalElecField(
-        Emitter *em,
-        QLineF e_ray,
-        QLineF r_ray,
-        double dn)
-{
-    // Incidence angle of the ray from the emitter
-    double phi = em->getIncidentRayAngle(e_ray);
+void SimulationHandler::recomputePath(int index, qint64 item, ComputationResults *results) {
+    const int path_index = m_recomputed_paths[index];
+    const SimulationPath &path = m_paths[path_index];
+    const CompiledEmitter &em = m_compiled_scene->getEmitters()[path.emitter];
+    const CompiledReceiver &re = m_compiled_scene->getReceivers()[path.receiver];
 
-    // Get the polarization vector of the emitter
-    vector<complex> polarization = em->getPolarization();
+    // The buffers are reused by each thread to avoid allocations
+    static thread_local vector<QPointF> images_chain;
+    static thread_local vector<int> walls_chain;
+    static thread_local vector<QLineF> rays;
 
-    // Get properties from the emitter
-    double GTX = em->getGain(phi);
-    double PTX = em->getPower();
-    double omega = em->getFrequency()*2*M_PI;
+    images_chain.clear();
+    walls_chain.clear();
 
-    // Compute the direction of the parallel component of the electric field at the receiver.
-    // This direction is a unit vector normal to the propagation vector in the incidence plane.
-    QLineF E_unit = r_ray.normalVector().unitVector();
+    // Compute the images of the emitter over the walls of the reflections
+    QPointF source = em.position;
 
-    // Propagation constant (air)
-    complex gamma_0 = 1i*omega*sqrt(MU_0*EPSILON_0);
+    for (int k = 0 ; k < path.chain_length ; k++) {
+        const int w = m_path_chains[path.chain + k];
 
-    // Direct (nominal) electric field (equation 8.77)
-    complex E = sqrt(60.0*GTX*PTX) * exp(-gamma_0*dn) / dn;
+        source = m_compiled_scene->mirror(source, w);
+        images_chain.push_back(source);
+        walls_chain.push_back(w);
+    }
+    double power;
+    PathTerms terms;
 
-    // The first component of the polarization vector is the parallel component, the second
-    // is the orthogonal one.
-    // E_unit is the direction vector of the electric field in the incidence plane.
-    return {
-        E * polarization[0] * E_unit.dx(),
-        E * polarization[0] * E_unit.dy(),
-        E * polarization[1]
-    };
+    if (m_model->traceRayPath(em, re, images_chain, walls_chain, &rays, &power, &terms)) {
+        addComputedPath(item, path.receiver, path.emitter, -1, path_index, power, terms, rays, results);
+    }
 }
 
 /**
- * @brief SimulationHandler::computeRayPower
- *
- * This function computes the power of a ray path from an emitter to a receiver
- * (equation 8.83, applyed to one ray)
+ * @brief SimulationHandler::addComputedPath
  *
- * @param em  : The emitter (source of the ray path)
- * @param re  : The receiver (destination of the ray path)
- * @param ray : The ray coming to the receiver
- * @param En  : The electric field of the ray
- * @return    : The power of the ray path to the receiver
+ * This function adds a ray path to the results of a computation unit, with the
+ * rectangle containing its lines (used to find the ray paths affected by a new wall)
+ * and the terms of its power (used to update it when only the antennas change).
  */
-double SimulationHandler::computeRayPower(
-        Emitter *em,
-        Receiver *re,
-        QLineF ray,
-        vector<complex> En)
+void SimulationHandler::addComputedPath(
+        qint64 item,
+        int receiver,
+        int emitter,
+        int node,
+        int path,
+        double power,
+        const PathTerms &terms,
+        const vector<QLineF> &rays,
+        ComputationResults *results)
 {
-    // Incidence angle of the ray to the receiver
-    double phi = re->getIncidentRayAngle(ray);
+    ComputedPath c;
+    c.item = item;
+    c.receiver = receiver;
+    c.emitter = emitter;
+    c.node = node;
+    c.path = path;
+    c.power = power;
+    c.terms = terms;
+
+    for (const QLineF &r : rays) {
+        c.bounds = c.bounds.united(QRectF(r.p1(), r.p2()).normalized());
+    }
+
+    c.rays = rays;
+
+    results->paths.push_back(std::move(c));
+}
 
-    // Get the frequency from the emitter
-    double frequency = em->getFrequency();
+/**
+ * @brief SimulationHandler::addPruningReport
+ * @param receiver : The index of the receiver
+ * @param pruned   : The pruning report of a range of nodes for this receiver
+ * @param results  : The results where to add the report
+ */
+void SimulationHandler::addPruningReport(int receiver, const ReceivedPower &pruned, ComputationResults *results) {
+    if (pruned.pruned_branches == 0) {
+        return;
+    }
 
-    // Get the antenna's resistance and effective height
-    double Ra = re->getResistance();
-    vector<complex> he = re->getEffectiveHeight(phi, frequency);
+    results->pruned_branches += pruned.pruned_branches;
+    results->pruned_nodes += pruned.pruned_nodes;
 
-    // norm() = square of modulus
-    return norm(dotProduct(he, En)) / (8.0 * Ra);
+    if (results->pruned_power.size() <= (size_t) receiver) {
+        results->pruned_power.resize(m_compiled_scene->getReceivers().size(), 0.0);
+    }
+    results->pruned_power[receiver] += pruned.pruned_power;
 }
 
+/**************************************************************************************************/
+// ---------------------------- SIMULATION MANAGEMENT FUNCTIONS --------------------------------- //
+/**************************************************************************************************/
+
 /**
- * @brief SimulationHandler::computeRayPath
- *
- * This function computes the ray path for a combination reflections.
+ * @brief SimulationHandler::computeAllRays
  *
- * @param emitter  : The emitter for this ray path
- * @param receiver : The receiver for this ray path
- * @param images   : The list of reflection images computed for this ray path
- * @param walls    : The list of walls that form a combination of reflections
- * @return         : A pointer to the new RayPath object computed (or nullptr if invalid)
- */
-RayPath *SimulationHandler::computeRayPath(
-        Emitter *emitter,
-        Receiver *receiver,
-        QList<QPointF> images,
-        QList<Wall*> walls)
-{
-    // We run backward in this function (from receiver to emitter)
+ * This function computes the rays from every emitters to every receivers.
+ * This is an asynchronous function that adds computation units to the thread pool.
+ */
+void SimulationHandler::computeAllRays() {
+    // Start the time counter
+    m_computation_timer.start();
 
-    // The first target point is the receiver
-    QPointF target_point = receiver->getRealPos();
+    const int receivers_count = (int) m_compiled_scene->getReceivers().size();
+    const int emitters_count = (int) m_compiled_scene->getEmitters().size();
 
-    // This list will contain the lines forming the ray path
-    QList<QLineF> rays;
+    // Build the image tree of each emitter (the images don't depend on the receivers)
+    m_model = new PropagationModel(m_compiled_scene);
 
-    // This coefficient will contain the product of all reflection and
-    // transmission coefficients for this ray path
-    vector<complex> coeff = {1,1,1};
+    // Update the power of the kept ray paths whose emitter or receiver only changed
+    // of power, antenna or rotation (from their terms, without any geometry)
+    for (int i : m_reweighted_paths) {
+        SimulationPath &path = m_paths[i];
 
-    // Total length of the ray path
-    double dn;
+        path.power = m_model->termsPower(
+                    m_compiled_scene->getEmitters()[path.emitter],
+                    m_compiled_scene->getReceivers()[path.receiver],
+                    path.terms);
+    }
+
+    // For an incremental update, get the nodes of each image tree that are not in the kept
+    // ray paths: the nodes reflected on a new wall (a node is reflected on the walls of all
+    // its parents), and the nodes deeper than the reflections count of the kept ray paths
+    m_new_nodes.assign(emitters_count, vector<bool>());
 
-    // Wall of the next reflection (towards the receiver)
-    Wall *target_wall = nullptr;
+    const bool new_walls = std::find(m_new_walls.begin(), m_new_walls.end(), true) != m_new_walls.end();
 
-    // Loop over the images (backward)
-    for (int i = images.size()-1; i >= 0 ; i--) {
-        Wall *reflect_wall = walls[i];
-        QPointF src_image = images[i];
+    // (an area simulation only computes the new orders, from the order of each node)
+    if (!m_power_only && (new_walls || m_kept_reflections < m_compiled_scene->reflectionsCount())) {
+        for (int e = 0 ; e < emitters_count ; e++) {
+            const vector<ImageNode> &nodes = m_model->imageTree(e)->getNodes();
+            vector<bool> &new_nodes = m_new_nodes[e];
+            new_nodes.resize(nodes.size());
 
-        // Compute the virtual ray (line from the image to te target point)
-        QLineF virtual_ray (src_image, target_point);
+            for (size_t i = 0 ; i < nodes.size() ; i++) {
+                const int parent = nodes[i].parent;
 
-        // If this is the virtual ray from the last image to the receiver,
-        // it length is the total ray path length dn.
-        if (src_image == images.last()) {
-            dn = virtual_ray.length();
+                new_nodes[i] =
+                        m_new_walls[nodes[i].wall] ||
+                        nodes[i].order > m_kept_reflections ||
+                        (parent >= 0 && new_nodes[parent]);
+            }
         }
+    }
 
-        // Get the reflection point (intersection of the virtual ray and the wall)
-        QPointF reflection_pt;
-        QLineF::IntersectionType i_t =
-                virtual_ray.intersects(reflect_wall->getRealLine(), &reflection_pt);
+    // The work items of each couple (receiver, emitter) are its direct ray path followed
+    // by the nodes of the emitter's image tree. They are put end to end, so a chunk of
+    // work can be any range of items (small subtrees are batched together, and big ones
+    // are split between the threads).
+    // The couples that didn't change since the last simulation have no work item.
+    m_work_offsets.assign(1, 0);
 
-        // The ray path is valid if the reflection is on the wall (not on its extension)
-        if (i_t != QLineF::BoundedIntersection) {
-            return nullptr; // Return an invalid ray path
-        }
+    // Loop over the receivers
+    for (int r = 0 ; r < receivers_count ; r++)
+    {
+        // Loop over the emitters
+        for (int e = 0 ; e < emitters_count ; e++)
+        {
+            qint64 items = 0;
+
+            if (m_pairs_update[r * emitters_count + e] != PairUpdate::None) {
+                items = 1 + (qint64) m_model->imageTree(e)->getNodes().size();
+            }
 
-        // If the target point is the same as the reflection point
-        //  -> not a physics situation -> invalid raypath
-        if (reflection_pt == target_point) {
-            return nullptr;
+            m_work_offsets.push_back(m_work_offsets.back() + items);
         }
+    }
 
-        // Add this ray line to the list of lines forming the ray path
-        QLineF ray(reflection_pt, target_point);
-        rays.append(ray);
+    // The last work items are the kept ray paths to recompute
+    m_work_pairs_total = m_work_offsets.back();
+    m_work_total = m_work_pairs_total + (qint64) m_recomputed_paths.size();
+    splitWorkChunks();
 
-        // Compute the reflection coefficient for this reflection
-        // The multiplication is made component by component (not a cross product).
-        coeff *= computeReflection(emitter, reflect_wall, ray);
+    // Start one computation unit per thread, each one takes chunks of work until done
+    if (m_work_total > 0) {
+        for (int i = 0 ; i < m_threadpool.maxThreadCount() ; i++) {
+            startComputationUnit();
+        }
+    }
+    else {
+        // Call it once (in the case we don't have any computation unit created)
+        computationUnitFinished();
+    }
+}
 
-        // Compute the transmission coefficient for all transmissions undergone by the ray line.
-        coeff *= computeTransmissons(emitter, ray, reflect_wall, target_wall);
+/**
+ * @brief SimulationHandler::startComputationUnit
+ *
+ * This function creates a computation unit and adds it to the queue of the thread pool.
+ */
+void SimulationHandler::startComputationUnit() {
+    // Create a computation unit
+    ComputationUnit *cu = new ComputationUnit(this);
 
-        // The next target point is the current reflection point
-        target_point = reflection_pt;
-        target_wall = reflect_wall;
-    }
+    // One thread can write in this list at a time (mutex)
+    m_mutex.lock();
+    m_computation_units.append(cu);
+    m_mutex.unlock();
 
-    // If the target point is the same as the emitter point
-    //  -> not a physics situation -> invalid raypath
-    if (emitter->getRealPos() == target_point) {
-        return nullptr;
-    }
+    // Connect the computation unit to the simulation handler
+    connect(cu, SIGNAL(computationProgress()), this, SLOT(computationUnitProgress()));
+    connect(cu, SIGNAL(computationFinished()), this, SLOT(computationUnitFinished()));
+
+    // Add this computation unit to the queue of the thread pool
+    m_threadpool.start(cu);
+}
 
-    // The last ray line is from the emitter to the target point
-    QLineF ray(emitter->getRealPos(), target_point);
-    rays.append(ray);
+/**
+ * @brief SimulationHandler::splitWorkChunks
+ *
+ * This function splits the work items in chunks of decreasing size (guided scheduling):
+ * the large chunks at the start keep the scheduling overhead low, and the small chunks
+ * at the end keep all the threads busy until the end of the simulation.
+ * The boundaries of the chunks only depend on the work total and the threads count
+ * (not on the threads timing), so the partial sums and the pruning report of each
+ * chunk are the same for each run of the same simulation.
+ */
+void SimulationHandler::splitWorkChunks() {
+    const qint64 threads_count = max(m_threadpool.maxThreadCount(), 1);
+    m_work_chunks.assign(1, 0);
 
-    // Compute all the transmissions undergone by the ray line.
-    coeff *= computeTransmissons(emitter, ray, nullptr, target_wall);
+    while (m_work_chunks.back() < m_work_total) {
+        const qint64 remaining = m_work_total - m_work_chunks.back();
+        const qint64 chunk = max(remaining / (WORK_CHUNKS_PER_THREAD * threads_count), (qint64) WORK_MIN_CHUNK);
 
-    // If there were no images in the list, we are computing the direct ray, so the length
-    // of the ray path (dn) is the length of the ray line from emitter to receiver.
-    if (images.size() == 0) {
-        dn = ray.length();
+        m_work_chunks.push_back(min(m_work_chunks.back() + chunk, m_work_total));
     }
 
-    // Compute the electric field for this ray path (equation 8.78)
-    // rays.last() is the ray coming out from the emitter
-    // rays.first() is the ray coming to the receiver
-    // The multiplication is made component by component (not a cross product).
-    vector<complex> En = coeff * computeNominalElecField(emitter, rays.last(), rays.first(), dn);
+    m_work_next.store(0);
+    m_work_done.store(0);
+}
+
+/**
+ * @brief SimulationHandler::nextWorkChunk
+ * @param first : Set to the first work item of the chunk
+ * @param last  : Set to the item after the last one of the chunk
+ * @return      : False if there is no more work to do
+ *
+ * This function gives the next chunk of work items to a computation unit.
+ * This function is lock-free and can be called from any thread.
+ */
+bool SimulationHandler::nextWorkChunk(qint64 *first, qint64 *last) {
+    const qint64 chunks_count = (qint64) m_work_chunks.size() - 1;
+    const qint64 chunk = m_work_next.fetchAndAddOrdered(1);
 
-    // Compute the power of the ray coming to the receiver (first ray in the list)
-    double power = computeRayPower(emitter, receiver, rays.first(), En);
+    if (chunk >= chunks_count) {
+        return false;
+    }
 
-    // Return a new RayPath object
-    RayPath *rp = new RayPath(emitter, rays, power);
-    return rp;
+    *first = m_work_chunks[chunk];
+    *last = m_work_chunks[chunk + 1];
+    return true;
 }
 
 /**
- * @brief SimulationHandler::recursiveReflection
- *
- * This function gets the image of the source (emitter of previous image) over the 'reflect_wall'
- * and compute the ray path recursively.
- * The computed ray paths are added to the RayPaths list of the receiver
+ * @brief SimulationHandler::computeWorkChunk
+ * @param first   : The first work item of the chunk
+ * @param last    : The item after the last one of the chunk
+ * @param results : The results to fill (owned by the calling thread)
  *
- * @param emitter      : The emitter for this ray path
- * @param receiver     : The receiver for this ray path
- * @param reflect_wall : The wall on which we will compute the reflection
- * @param images       : The list of images for the previous reflections
- * @param walls        : The list of walls for the previous reflections
- * @param level        : The recursion level
+ * This function computes the ray paths of a chunk of work items.
+ * A chunk can overlap several couples (receiver, emitter).
  */
-void SimulationHandler::recursiveReflection(
-        Emitter *emitter,
-        Receiver *receiver,
-        Wall *reflect_wall,
-        QList<QPointF> images,
-        QList<Wall *> walls,
-        int level)
-{
-    // Position of the image of the source
-    QPointF src_image;
+void SimulationHandler::computeWorkChunk(qint64 first, qint64 last, ComputationResults *results) {
+    const int emitters_count = (int) m_compiled_scene->getEmitters().size();
+    const qint64 chunk_size = last - first;
 
-    if (images.size() == 0) {
-        // If there is no previous reflection, the source is the emitter
-        src_image = mirror(emitter->getRealPos(), reflect_wall);
-    }
-    else {
-        // If there are previous reflections, the source is the last image
-        src_image = mirror(images.last(), reflect_wall);
+    // The items after the couples are the kept ray paths to recompute
+    for (qint64 i = max(first, m_work_pairs_total) ; i < last ; i++) {
+        recomputePath((int) (i - m_work_pairs_total), i, results);
     }
 
-    // Keep the list of walls and images for the next recursions
-    images.append(src_image);
-    walls.append(reflect_wall);
+    last = min(last, m_work_pairs_total);
 
-    // Compute the complete ray path for this set of reflections
-    RayPath *rp = computeRayPath(emitter, receiver, images, walls);
+    // Find the couple (receiver, emitter) of the first item of the chunk
+    int pair = (int) (std::upper_bound(m_work_offsets.begin(), m_work_offsets.end(), first) - m_work_offsets.begin()) - 1;
 
-    // Add this ray path to his receiver
-    receiver->addRayPath(rp);
+    while (first < last) {
+        // Skip the couples without work item
+        if (m_pairs_update[pair] == PairUpdate::None) {
+            pair++;
+            continue;
+        }
 
-    // If the level of recursion is under the max number of reflections
-    if (level < simulationData()->maxReflectionsCount())
-    {
-        // Compute the reflection from the 'reflect_wall' to all other walls of the scene
-        foreach (Wall *w, simulationData()->getWallsList())
-        {
-            // We don't have to compute any reflection from the 'reflect_wall' to itself
-            if (w == reflect_wall){
-                continue;
-            }
+        const int r = pair / emitters_count;
+        const int e = pair % emitters_count;
 
-            // Recursive call for each wall of the scene (and increase the recusion level)
-            recursiveReflection(emitter, receiver, w, images, walls, level+1);
-        }
-    }
-}
+        // Range of the chunk in the items of this couple
+        const qint64 begin = first - m_work_offsets[pair];
+        const qint64 end = min(last, m_work_offsets[pair + 1]) - m_work_offsets[pair];
 
-/**************************************************************************************************/
-// ---------------------------- SIMULATION MANAGEMENT FUNCTIONS --------------------------------- //
-/**************************************************************************************************/
+        // The first item is the direct ray path (only computed for a new receiver or emitter)
+        if (begin == 0 && m_pairs_update[pair] == PairUpdate::Full) {
+            if (m_power_only) {
+                ReceivedPower received;
+                m_model->directPower(e, m_compiled_scene->getReceivers()[r], &received);
 
-/**
- * @brief SimulationHandler::computeAllRays
- *
- * This function computes the rays from every emitters to every receivers.
- * This is an asynchronous function that adds computation units to the thread pool.
- */
-void SimulationHandler::computeAllRays() {
-    // Start the time counter
-    m_computation_timer.start();
+                if (received.paths_count > 0) {
+                    results->powers.push_back({m_work_offsets[pair], r, 0, received.power, 1});
+                }
+            }
+            else if (m_keep_paths) {
+                static thread_local vector<QLineF> rays;
+                double power;
+                PathTerms terms;
 
-    // Loop over the receivers
-    foreach(Receiver *r, m_receivers_list)
-    {
-        // Loop over the emitters
-        foreach(Emitter *e, simulationData()->getEmittersList())
-        {
-            // Compute the direct ray path and add it to his receiver
-            r->addRayPath(computeRayPath(e, r));
-
-            // For each wall in the scene, compute the reflections recursively
-            foreach(Wall *w, simulationData()->getWallsList())
-            {
-                // Don't compute any reflection if not needed
-                if (simulationData()->maxReflectionsCount() > 0) {
-                    // Compute the ray paths recursively (in a thread)
-                    recursiveReflectionThreaded(e, r, w);
+                const CompiledEmitter &em = m_compiled_scene->getEmitters()[e];
+                const CompiledReceiver &re = m_compiled_scene->getReceivers()[r];
+
+                if (m_model->traceRayPath(em, re, vector<QPointF>(), vector<int>(), &rays, &power, &terms)) {
+                    addComputedPath(m_work_offsets[pair], r, e, -1, -1, power, terms, rays, results);
                 }
             }
+            else {
+                computeRayPath(e, r, m_work_offsets[pair], results);
+            }
         }
+
+        // The next items are the nodes of the emitter's image tree
+        const qint64 first_node = max(begin, (qint64) 1) - 1;
+        computeReflections(e, r, (int) first_node, (int) end - 1, m_work_offsets[pair] + 1 + first_node, results);
+
+        first = m_work_offsets[pair] + end;
+        pair++;
     }
 
-    // Call it once (in the case we don't have any computation unit created)
-    computationUnitFinished();
+    m_work_done.fetchAndAddOrdered(chunk_size);
 }
 
 /**
- * @brief SimulationHandler::recursiveReflectionThreaded
- * @param e
- * @param r
- * @param w
+ * @brief SimulationHandler::computationUnitProgress
  *
- * This function creates a computation unit to compute the reflections
- * recursively in a thread.
+ * This slot is called when a computation unit finished to compute a chunk of work
  */
-void SimulationHandler::recursiveReflectionThreaded(Emitter *e, Receiver *r, Wall *w) {
-    // Create a computation unit for the recursive computation of the reflections
-    ComputationUnit *cu = new ComputationUnit(this, e, r, w);
-
-    // One thread can write in this list at a time (mutex)
-    m_mutex.lock();
-    m_computation_units.append(cu);
-    m_mutex.unlock();
-
-    // Connect the computation unit to the simulation handler
-    connect(cu, SIGNAL(computationFinished()), this, SLOT(computationUnitFinished()));
-
-    // Add this computation unit to the queue of the thread pool
-    m_threadpool.start(cu);
-
-    // Increase the computation units counter
-    m_init_cu_count++;
+void SimulationHandler::computationUnitProgress() {
+    if (m_work_total > 0) {
+        emit simulationProgress((double) m_work_done.load() / (double) m_work_total);
+    }
 }
 
 /**
@@ -588,6 +730,32 @@ void SimulationHandler::computationUnitFinished() {
 
     // If a computation unit is the origin of the call to this function
     if (cu != nullptr) {
+        // Keep the results of this unit (its thread is done with them)
+        ComputationResults &results = cu->getResults();
+
+        // The lines of the ray paths are moved after the ones of the other units
+        const int rays_offset = (int) m_computed_rays.size();
+
+        for (ComputedRayPath c : results.ray_paths) {
+            c.first_ray += rays_offset;
+            m_computed_ray_paths.push_back(c);
+        }
+
+        m_computed_rays.insert(m_computed_rays.end(), results.rays.begin(), results.rays.end());
+        m_computed_powers.insert(m_computed_powers.end(), results.powers.begin(), results.powers.end());
+        std::move(results.paths.begin(), results.paths.end(), std::back_inserter(m_computed_paths));
+        results.ray_paths.clear();
+        results.rays.clear();
+        results.powers.clear();
+        results.paths.clear();
+
+        m_pruned_branches += results.pruned_branches;
+        m_pruned_nodes += results.pruned_nodes;
+
+        for (size_t r = 0 ; r < results.pruned_power.size() ; r++) {
+            m_pruned_power[r] += results.pruned_power[r];
+        }
+
         // One thread can write in this list at a time (mutex)
         m_mutex.lock();
         m_computation_units.removeOne(cu);
@@ -597,20 +765,50 @@ void SimulationHandler::computationUnitFinished() {
         cu->deleteLater();
     }
 
-    // Compute the progression and send the progression signal
-    double progress = 1.0 - (double) m_computation_units.size() / (double) m_init_cu_count;
-    emit simulationProgress(progress);
+    // Send the progression signal
+    computationUnitProgress();
 
     // All computations done
     if (m_computation_units.size() == 0){
+        // Add the computed ray paths to their receivers
+        if (m_keep_paths) {
+            mergeComputedPaths();
+        }
+        else {
+            mergeComputedRayPaths();
+        }
+
+        // A cancelled refinement gives back the last grid of the area (with its report)
+        if (m_sim_cancelling && m_refined_cells_count >= 0) {
+            for (int r = m_refined_cells_count ; r < receiversCount() ; r++) {
+                resetReceiver(r);
+            }
+
+            m_area_cells.resize(m_refined_cells_count);
+            m_pruned_power.resize(m_refined_cells_count);
+            m_pruned_branches = m_refined_pruned_branches;
+            m_pruned_nodes = m_refined_pruned_nodes;
+        }
+
+        m_refined_cells_count = -1;
+
         qDebug() << "Time (ms):" << m_computation_timer.nsecsElapsed() / 1e6;
-        qDebug() << "Count:" << getRayPathsList().size();
-        qDebug() << "Receivers:" << m_receivers_list.size();
-        qDebug() << "Walls:" << m_simulation_data->getWallsList().size();
+        qDebug() << "Count:" << receivedPathsCount();
+        qDebug() << "Receivers:" << receiversCount();
+        qDebug() << "Walls:" << m_compiled_scene->getWalls().size();
 
         // Mark the simulation as stopped
         m_sim_started = false;
 
+        // Keep the results for the next simulations of the same scene. With the pruning,
+        // the report of an incremental update only counts the branches of the computed
+        // ray paths, so its results are not stored (they would load with a partial report).
+        const bool partial_report = m_incremental_run && m_pruning_threshold > 0;
+
+        if (!m_sim_cancelling && m_cache_enabled && !partial_report) {
+            storeResults();
+        }
+
         if (!m_sim_cancelling) {
             // Emit the simulation finished signal
             emit simulationFinished();
@@ -626,46 +824,619 @@ void SimulationHandler::computationUnitFinished() {
 }
 
 /**
- * @brief SimulationHandler::startSimulationComputation
- * @param rcv_list
+ * @brief SimulationHandler::mergeComputedRayPaths
  *
- * This function starts a computation of all rays to a list of receivers
+ * This function adds the ray paths (or the powers) computed by all the computation units
+ * to their receivers. The results are sorted by work item, so the order of the ray paths
+ * (and the sums of their powers) doesn't depend on the threads that computed them.
  */
-void SimulationHandler::startSimulationComputation(QList<Receiver*> rcv_list) {
-    // Don't start a new computation if already running
-    if (isRunning())
-        return;
+void SimulationHandler::mergeComputedRayPaths() {
+    std::sort(
+            m_computed_ray_paths.begin(),
+            m_computed_ray_paths.end(),
+            [](const ComputedRayPath &a, const ComputedRayPath &b) {
+                return a.item < b.item;
+            });
+
+    for (const ComputedRayPath &c : m_computed_ray_paths) {
+        QList<QLineF> rays_list;
+        rays_list.reserve(c.rays_count);
+
+        for (int i = c.first_ray ; i < c.first_ray + c.rays_count ; i++) {
+            rays_list.append(m_computed_rays[i]);
+        }
 
-    // Reset the previously computed data (if one)
-    resetComputedData();
+        m_receivers_list.at(c.receiver)->addRayPath(new RayPath(m_emitters_list.at(c.emitter), rays_list, c.power));
+    }
 
-    // Setup the receivers list
-    m_receivers_list = rcv_list;
+    m_computed_ray_paths.clear();
+    m_computed_rays.clear();
 
-    // Mark the simulation as running
-    m_sim_started = true;
+    std::sort(
+            m_computed_powers.begin(),
+            m_computed_powers.end(),
+            [](const ComputedPower &a, const ComputedPower &b) {
+                return a.item < b.item || (a.item == b.item && a.order < b.order);
+            });
 
-    // Reset the counter of computation units
-    m_init_cu_count = 0;
+    for (const ComputedPower &c : m_computed_powers) {
+        addReceivedPower(c.receiver, c.power, c.paths_count);
 
-    // Emit the simulation started signal
-    emit simulationStarted();
-    emit simulationProgress(0);
+        // Keep the sums of each order for the next update of the reflections count
+        if (!m_order_powers.empty()) {
+            m_order_powers[c.receiver * m_orders_count + c.order] += c.power;
+            m_order_paths_counts[c.receiver * m_orders_count + c.order] += c.paths_count;
+        }
+    }
 
-    // Compute all rays
-    computeAllRays();
+    m_computed_powers.clear();
+
+    // These sums can be updated by the next simulation
+    if (m_power_only) {
+        m_orders_valid = !m_order_powers.empty() && !m_sim_cancelling;
+        m_paths_pruning_threshold = m_pruning_threshold;
+    }
 }
 
 /**
- * @brief SimulationHandler::stopSimulationComputation
+ * @brief SimulationHandler::mergeComputedPaths
  *
- * This function cancel the current simulation.
- * The cancel operation must wait for all threads to finish.
+ * This function updates the kept ray paths with the ray paths computed by all the
+ * computation units (incremental updates), and adds all of them to their receivers.
+ * The new ray paths are sorted by work item, so their order doesn't depend on the threads.
  */
-void SimulationHandler::stopSimulationComputation() {
-    // Clear the queue of the thread pool
+void SimulationHandler::mergeComputedPaths() {
+    std::sort(
+            m_computed_paths.begin(),
+            m_computed_paths.end(),
+            [](const ComputedPath &a, const ComputedPath &b) {
+                return a.item < b.item;
+            });
+
+    // The recomputed ray paths that are not in the results are no longer valid
+    vector<bool> removed(m_paths.size(), false);
+
+    for (int i : m_recomputed_paths) {
+        removed[i] = true;
+    }
+
+    for (ComputedPath &c : m_computed_paths) {
+        // Update a recomputed ray path
+        if (c.path >= 0) {
+            SimulationPath &path = m_paths[c.path];
+            path.power = c.power;
+            path.terms = c.terms;
+            path.bounds = c.bounds;
+            path.rays = std::move(c.rays);
+
+            removed[c.path] = false;
+            continue;
+        }
+
+        // Add a new ray path, with the walls of its reflections (from the emitter)
+        SimulationPath path;
+        path.receiver = c.receiver;
+        path.emitter = c.emitter;
+        path.chain = (int) m_path_chains.size();
+        path.chain_length = 0;
+        path.power = c.power;
+        path.terms = c.terms;
+        path.bounds = c.bounds;
+        path.rays = std::move(c.rays);
+
+        const vector<ImageNode> &nodes = m_model->imageTree(c.emitter)->getNodes();
+
+        for (int i = c.node ; i >= 0 ; i = nodes[i].parent) {
+            m_path_chains.push_back(nodes[i].wall);
+            path.chain_length++;
+        }
+
+        std::reverse(m_path_chains.begin() + path.chain, m_path_chains.end());
+
+        m_paths.push_back(std::move(path));
+    }
+
+    m_computed_paths.clear();
+
+    // Remove the invalid ray paths
+    if (std::find(removed.begin(), removed.end(), true) != removed.end()) {
+        size_t kept = 0;
+
+        for (size_t i = 0 ; i < m_paths.size() ; i++) {
+            if (i >= removed.size() || !removed[i]) {
+                m_paths[kept++] = std::move(m_paths[i]);
+            }
+        }
+
+        m_paths.resize(kept);
+    }
+
+    // Add the ray paths to their receivers
+    // (the receivers whose results didn't change already have them)
+    for (const SimulationPath &path : m_paths) {
+        if (m_clean_receivers[path.receiver]) {
+            continue;
+        }
+
+        Receiver *re = m_receivers_list.at(path.receiver);
+
+        QList<QLineF> rays_list;
+        rays_list.reserve((int) path.rays.size());
+
+        for (const QLineF &r : path.rays) {
+            rays_list.append(r);
+        }
+
+        re->addRayPath(new RayPath(m_emitters_list.at(path.emitter), rays_list, path.power));
+    }
+
+    // These ray paths can be updated by the next simulation
+    m_paths_valid = !m_sim_cancelling;
+    m_paths_pruning_threshold = m_pruning_threshold;
+}
+
+/**
+ * @brief SimulationHandler::startSimulationComputation
+ * @param rcv_list
+ *
+ * This function starts a computation of all rays to a list of receivers
+ */
+void SimulationHandler::startSimulationComputation(QList<Receiver*> rcv_list) {
+    startComputation(rcv_list, nullptr, vector<int>());
+}
+
+/**
+ * @brief SimulationHandler::startSimulationComputation
+ * @param area  : The area of the simulation
+ * @param cells : The indexes of the cells of the area to compute
+ *
+ * This function starts a computation of the power received by cells of an area
+ */
+void SimulationHandler::startSimulationComputation(ReceiversArea *area, const vector<int> &cells) {
+    startComputation(QList<Receiver*>(), area, cells);
+}
+
+/**
+ * @brief SimulationHandler::startComputation
+ * @param rcv_list : The receivers to compute (empty for an area)
+ * @param area     : The area whose cells are computed (or nullptr)
+ * @param cells    : The indexes of the cells of the area to compute
+ *
+ * This function starts a computation of all rays to a list of receivers, or to cells of an area
+ */
+void SimulationHandler::startComputation(QList<Receiver*> rcv_list, ReceiversArea *area, const vector<int> &cells) {
+    // Don't start a new computation if already running
+    if (isRunning())
+        return;
+
+    // Keep the scene of the last simulation to compare it with the new one, if its
+    // ray paths can be updated. Else, reset the previously computed data (if one).
+    CompiledScene *previous_scene = nullptr;
+    QList<Wall*> previous_walls;
+    QList<Emitter*> previous_emitters;
+    QList<Receiver*> previous_receivers;
+
+    if (m_incremental && (m_paths_valid || m_orders_valid)) {
+        previous_scene = m_compiled_scene;
+        previous_walls = m_walls_list;
+        previous_emitters = m_emitters_list;
+        previous_receivers = m_receivers_list;
+
+        m_compiled_scene = nullptr;
+
+        delete m_model;
+        m_model = nullptr;
+    }
+    else {
+        resetComputedData();
+    }
+
+    // Setup the receivers list
+    m_refined_cells_count = -1;
+    m_receivers_list = rcv_list;
+    m_area = area;
+    m_area_cells = cells;
+
+    // Build the read-only snapshot of the scene used by the computation threads
+    compileScene();
+
+    // Load the results if the same simulation was already done
+    CachedResults cached_results;
+    m_results_cached = m_cache_enabled && loadCachedResults(&cached_results);
+
+    if (m_results_cached) {
+        delete previous_scene;
+
+        // The kept ray paths (if any) can't be updated to these results
+        m_paths.clear();
+        m_path_chains.clear();
+        m_paths_valid = false;
+        m_order_powers.clear();
+        m_order_paths_counts.clear();
+        m_orders_valid = false;
+
+        m_clean_receivers.assign(receiversCount(), false);
+        resetReceivers(previous_receivers);
+        applyCachedResults(cached_results);
+
+        emit simulationStarted();
+        emit simulationProgress(1);
+        emit simulationFinished();
+        return;
+    }
+
+    // Find the work to do from the changes since the last simulation (all if none)
+    prepareIncrementalUpdate(previous_scene, previous_walls, previous_emitters, previous_receivers);
+    delete previous_scene;
+
+    // Reset the receivers whose results change
+    resetReceivers(previous_receivers);
+
+    // The cells of an updated area get back the power of their kept orders
+    if (m_power_only && m_incremental_run) {
+        addKeptOrdersPowers();
+    }
+
+    // Mark the simulation as running
+    m_sim_started = true;
+
+    // Emit the simulation started signal
+    emit simulationStarted();
+    emit simulationProgress(0);
+
+    // Compute all rays
+    computeAllRays();
+}
+
+/**
+ * @brief SimulationHandler::refineSimulationComputation
+ * @param area  : The area of the last simulation
+ * @param cells : The indexes of the new cells of the area to compute
+ *
+ * This function adds cells to the last area simulation (next grid of a progressive
+ * simulation) and only computes them: the cells already computed keep their results
+ * (and their pruning report). The scene must not have changed since the last simulation.
+ * If it is cancelled, the new cells are reset and the area is back to its last grid.
+ * If the last simulation is not of this area, only these cells are computed.
+ */
+void SimulationHandler::refineSimulationComputation(ReceiversArea *area, const vector<int> &cells) {
+    // Don't start a new computation if already running
+    if (isRunning())
+        return;
+
+    if (area == nullptr || area != m_area || m_compiled_scene == nullptr) {
+        startSimulationComputation(area, cells);
+        return;
+    }
+
+    // Keep the pruning report of the computed cells
+    const int kept_count = (int) m_area_cells.size();
+    const vector<double> pruned_power = m_pruned_power;
+    m_refined_pruned_branches = m_pruned_branches;
+    m_refined_pruned_nodes = m_pruned_nodes;
+    m_refined_cells_count = kept_count;
+
+    delete m_model;
+    m_model = nullptr;
+
+    // The new cells are added after the computed ones in the compiled scene
+    m_area_cells.insert(m_area_cells.end(), cells.begin(), cells.end());
+    compileScene();
+
+    m_pruned_branches = m_refined_pruned_branches;
+    m_pruned_nodes = m_refined_pruned_nodes;
+    std::copy(pruned_power.begin(), pruned_power.end(), m_pruned_power.begin());
+
+    // Only the couples of the new cells are computed (the report of the run is complete,
+    // so its results can be stored into the cache)
+    const int receivers_count = receiversCount();
+    const int emitters_count = (int) m_compiled_scene->getEmitters().size();
+
+    m_results_cached = false;
+    m_incremental_run = false;
+    m_new_walls.assign(m_compiled_scene->getWalls().size(), false);
+    m_recomputed_paths.clear();
+    m_reweighted_paths.clear();
+    m_kept_reflections = m_compiled_scene->reflectionsCount();
+
+    m_pairs_update.assign(receivers_count * emitters_count, PairUpdate::Full);
+    m_clean_receivers.assign(receivers_count, false);
+
+    for (int r = 0 ; r < kept_count ; r++) {
+        std::fill_n(m_pairs_update.begin() + r * emitters_count, emitters_count, PairUpdate::None);
+        m_clean_receivers[r] = true;
+    }
+
+    // The sums of each order of the new cells start from zero
+    if (m_orders_valid && m_orders_count == m_compiled_scene->reflectionsCount() + 1) {
+        m_order_powers.resize(receivers_count * m_orders_count, 0.0);
+        m_order_paths_counts.resize(receivers_count * m_orders_count, 0);
+    }
+    else {
+        m_order_powers.clear();
+        m_order_paths_counts.clear();
+    }
+
+    m_orders_valid = false;
+
+    // Reset the new cells
+    resetReceivers(QList<Receiver*>());
+
+    // Mark the simulation as running
+    m_sim_started = true;
+
+    // Emit the simulation started signal
+    emit simulationStarted();
+    emit simulationProgress(0);
+
+    // Compute the rays of the new cells
+    computeAllRays();
+}
+
+/**
+ * @brief SimulationHandler::resultsKey
+ * @return
+ *
+ * This function returns the key of the results of the current simulation in the cache:
+ * the hash of the compiled scene and of the settings that change the results.
+ */
+QByteArray SimulationHandler::resultsKey() {
+    QByteArray data = m_compiled_scene->contentHash();
+    QDataStream out(&data, QIODevice::Append);
+    out << m_power_only << m_pruning_threshold;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/**
+ * @brief SimulationHandler::loadCachedResults
+ * @param results : Set to the cached results
+ * @return
+ *
+ * This function loads the cached results of the current simulation, and checks that
+ * they can be applied to the current receivers and emitters.
+ */
+bool SimulationHandler::loadCachedResults(CachedResults *results) {
+    if (!m_results_cache.load(resultsKey(), results)) {
+        return false;
+    }
+
+    if (results->receivers.size() != receiversCount()) {
+        return false;
+    }
+
+    foreach (const CachedReceiver &c, results->receivers) {
+        foreach (const CachedRayPath &rp, c.ray_paths) {
+            if (rp.emitter < 0 || rp.emitter >= m_emitters_list.size()) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief SimulationHandler::applyCachedResults
+ * @param results
+ *
+ * This function adds the cached results (ray paths or powers) to the receivers.
+ */
+void SimulationHandler::applyCachedResults(const CachedResults &results) {
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        const CachedReceiver &c = results.receivers.at(r);
+
+        if (c.ray_paths.isEmpty()) {
+            addReceivedPower(r, c.power, c.paths_count);
+        }
+
+        foreach (const CachedRayPath &rp, c.ray_paths) {
+            m_receivers_list.at(r)->addRayPath(new RayPath(m_emitters_list.at(rp.emitter), rp.rays, rp.power));
+        }
+
+        m_pruned_power[r] = c.pruned_power;
+    }
+
+    m_pruned_branches = results.pruned_branches;
+    m_pruned_nodes = results.pruned_nodes;
+}
+
+/**
+ * @brief SimulationHandler::resetReceivers
+ * @param previous_receivers : The receivers of the last simulation
+ *
+ * This function resets the receivers of the last simulation that are not in the current
+ * one, and the current receivers whose results change (the others keep their results).
+ */
+void SimulationHandler::resetReceivers(QList<Receiver*> previous_receivers) {
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        if (!m_clean_receivers[r]) {
+            resetReceiver(r);
+        }
+    }
+
+    QSet<Receiver*> current;
+
+    foreach (Receiver *re, m_receivers_list) {
+        current.insert(re);
+    }
+
+    foreach (Receiver *re, previous_receivers) {
+        if (!current.contains(re)) {
+            re->reset();
+        }
+    }
+}
+
+/**
+ * @brief SimulationHandler::receiversCount
+ * @return
+ *
+ * Returns the number of receivers of the simulation (receivers, or cells of the area)
+ */
+int SimulationHandler::receiversCount() {
+    if (m_area != nullptr) {
+        return (int) m_area_cells.size();
+    }
+
+    return m_receivers_list.size();
+}
+
+/**
+ * @brief SimulationHandler::resetReceiver
+ * @param receiver : The index of the receiver in the compiled scene
+ *
+ * This function erases the results of a receiver (or of a cell of the area)
+ */
+void SimulationHandler::resetReceiver(int receiver) {
+    if (m_area != nullptr) {
+        m_area->resetCell(m_area_cells[receiver]);
+    }
+    else {
+        m_receivers_list.at(receiver)->reset();
+    }
+}
+
+/**
+ * @brief SimulationHandler::addReceivedPower
+ * @param receiver    : The index of the receiver in the compiled scene
+ * @param power       : The sum of the powers of the ray paths
+ * @param paths_count : The number of ray paths
+ *
+ * This function adds the power of ray paths to a receiver (or to a cell of the area)
+ */
+void SimulationHandler::addReceivedPower(int receiver, double power, int paths_count) {
+    if (m_area != nullptr) {
+        m_area->addReceivedPower(m_area_cells[receiver], power, paths_count);
+    }
+    else {
+        m_receivers_list.at(receiver)->addReceivedPower(power, paths_count);
+    }
+}
+
+double SimulationHandler::receivedPower(int receiver) {
+    if (m_area != nullptr) {
+        return m_area->receivedPower(m_area_cells[receiver]);
+    }
+
+    return m_receivers_list.at(receiver)->receivedPower();
+}
+
+int SimulationHandler::receivedPathsCount(int receiver) {
+    if (m_area != nullptr) {
+        return m_area->receivedPathsCount(m_area_cells[receiver]);
+    }
+
+    return m_receivers_list.at(receiver)->receivedPathsCount();
+}
+
+/**
+ * @brief SimulationHandler::storeResults
+ *
+ * This function writes the results of the receivers into the cache.
+ */
+void SimulationHandler::storeResults() {
+    CachedResults results;
+    results.pruned_branches = m_pruned_branches;
+    results.pruned_nodes = m_pruned_nodes;
+
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        CachedReceiver c;
+        c.power = receivedPower(r);
+        c.paths_count = receivedPathsCount(r);
+        c.pruned_power = m_pruned_power[r];
+
+        // The cells of an area have no ray path
+        if (m_area == nullptr) {
+            foreach (RayPath *rp, m_receivers_list.at(r)->getRayPaths()) {
+                c.ray_paths.append({m_emitters_list.indexOf(rp->getEmitter()), rp->getPower(), rp->getRays()});
+            }
+        }
+
+        results.receivers.append(c);
+    }
+
+    if (!m_results_cache.store(resultsKey(), results)) {
+        qDebug() << "Unable to write the results into the cache:" << m_results_cache.directory();
+    }
+}
+
+/**
+ * @brief SimulationHandler::compileScene
+ *
+ * This function builds the compiled scene (flat and read-only copy of the walls, emitters
+ * and receivers, in meters) from the simulation data and the current receivers list.
+ * It must be called from the GUI thread, before the computation threads are started.
+ */
+void SimulationHandler::compileScene() {
+    delete m_compiled_scene;
+    m_compiled_scene = new CompiledScene();
+
+    // Keep the walls and emitters in the same order as in the compiled scene
+    m_walls_list = simulationData()->getWallsList();
+    m_emitters_list = simulationData()->getEmittersList();
+
+    foreach(Wall *w, m_walls_list) {
+        m_compiled_scene->addWall(
+                    w->getRealLine(),
+                    w->getRelPermitivity(),
+                    w->getConductivity(),
+                    w->getThickness());
+    }
+
+    foreach(Emitter *e, m_emitters_list) {
+        m_compiled_scene->addEmitter(e->getRealPos(), e->getFrequency(), e->getPower(), e->getAntenna());
+    }
+
+    foreach(Receiver *r, m_receivers_list) {
+        m_compiled_scene->addReceiver(r->getRealPos(), r->getRotation(), r->getAntenna());
+    }
+
+    if (m_area != nullptr) {
+        for (int cell : m_area_cells) {
+            m_compiled_scene->addReceiver(m_area->cellRealPos(cell), m_area->getRotation(), m_area->getAntenna());
+        }
+    }
+
+    m_compiled_scene->setReflectionsCount(simulationData()->maxReflectionsCount());
+
+    // The ray paths are never shown for an area simulation, so only compute their power
+    m_power_only = (simulationData()->simulationType() == SimType::AreaReceiver);
+
+    // Only the ray paths which are shown are kept for the incremental updates (keeping
+    // the terms of every ray path of an area would cost more than its received powers,
+    // its cells keep the power of each order of reflection instead)
+    m_keep_paths = m_incremental && !m_power_only;
+
+    // Get the pruning threshold in Watts (0 to disable the pruning)
+    m_pruning_threshold = 0;
+
+    if (simulationData()->pruningEnabled()) {
+        m_pruning_threshold = SimulationData::convertPowerToWatts(simulationData()->pruningThreshold());
+    }
+
+    // Reset the pruning report
+    m_pruned_branches = 0;
+    m_pruned_nodes = 0;
+    m_pruned_power.assign(receiversCount(), 0.0);
+
+    // Precompute the data that depends on the whole scene
+    m_compiled_scene->finalize();
+}
+
+/**
+ * @brief SimulationHandler::stopSimulationComputation
+ *
+ * This function cancel the current simulation.
+ * The cancel operation must wait for all threads to finish.
+ */
+void SimulationHandler::stopSimulationComputation() {
+    // Clear the queue of the thread pool
     m_threadpool.clear();
 
+    // Don't give more work to the running computation units
+    m_work_next.fetchAndStoreOrdered((qint64) m_work_chunks.size());
+
     // Mark the simulation as cancelling
     m_sim_cancelling = true;
 
@@ -690,12 +1461,459 @@ void SimulationHandler::stopSimulationComputation() {
  */
 void SimulationHandler::resetComputedData() {
     // Reset each receiver
-    foreach(Receiver *r, m_receivers_list) {
-        r->reset();
+    clearReceiversResults();
+
+    // Clear the emitters and walls lists
+    m_emitters_list.clear();
+    m_walls_list.clear();
+
+    // Delete the kept ray paths
+    m_paths.clear();
+    m_path_chains.clear();
+    m_paths_valid = false;
+    m_order_powers.clear();
+    m_order_paths_counts.clear();
+    m_orders_valid = false;
+
+    // Delete the snapshot of the scene
+    delete m_compiled_scene;
+    m_compiled_scene = nullptr;
+}
+
+/**
+ * @brief SimulationHandler::clearReceiversResults
+ *
+ * This function erases the results and RayPaths of the receivers, but keeps the
+ * computed ray paths (with the snapshot of their scene) for an incremental update.
+ * It must be called before the receivers are deleted.
+ */
+void SimulationHandler::clearReceiversResults() {
+    // Reset each receiver
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        resetReceiver(r);
     }
 
     // Clear the receivers list
     m_receivers_list.clear();
+    m_area = nullptr;
+    m_area_cells.clear();
+
+    // Delete the image trees
+    delete m_model;
+    m_model = nullptr;
+}
+
+/**
+ * @brief SimulationHandler::prepareIncrementalUpdate
+ * @param previous_scene    : The scene of the last simulation (or nullptr)
+ * @param previous_walls    : The walls of the last simulation (same order as its scene)
+ * @param previous_emitters : The emitters of the last simulation (same order as its scene)
+ * @param previous_receivers : The receivers of the last simulation (same order as its scene)
+ *
+ * This function compares the new compiled scene with the scene of the last simulation,
+ * and finds the work to do to update its ray paths:
+ *  - the ray paths of a removed receiver or emitter, or reflected on a removed wall, are
+ *    removed, and all the ray paths of a new receiver or emitter are computed
+ *    (a moved item, or an emitter of another frequency, is removed and added)
+ *  - the power of the kept ray paths of a receiver or emitter that only changed of power,
+ *    antenna or rotation is updated from the terms of the ray paths (if there is no pruning)
+ *  - the kept ray paths whose lines can cross a new or a removed wall are recomputed
+ *    (their transmissions change)
+ *  - the ray paths reflected on a new wall are computed
+ *  - if the reflections count is raised, only the ray paths of the new orders are computed,
+ *    and if it is lowered, the ray paths of the removed orders are removed
+ * An area simulation is updated from the power of each order instead (see prepareOrdersUpdate()).
+ * If there is no previous scene (or another simulation setting changed), all the
+ * ray paths are computed. The receivers that are kept without any change of their
+ * ray paths keep their results (they are not reset).
+ */
+void SimulationHandler::prepareIncrementalUpdate(
+        const CompiledScene *previous_scene,
+        QList<Wall*> previous_walls,
+        QList<Emitter*> previous_emitters,
+        QList<Receiver*> previous_receivers)
+{
+    const vector<CompiledWall> &walls = m_compiled_scene->getWalls();
+    const vector<CompiledEmitter> &emitters = m_compiled_scene->getEmitters();
+    const vector<CompiledReceiver> &receivers = m_compiled_scene->getReceivers();
+
+    m_new_walls.assign(walls.size(), false);
+    m_recomputed_paths.clear();
+    m_reweighted_paths.clear();
+    m_clean_receivers.assign(receivers.size(), false);
+
+    // The cells of an area keep the power of each order of reflection instead of ray paths
+    if (m_power_only) {
+        prepareOrdersUpdate(previous_scene);
+        return;
+    }
+
+    m_order_powers.clear();
+    m_order_paths_counts.clear();
+    m_orders_valid = false;
+
+    // The paths can only be updated if they were computed with the same settings
+    // (the reflections count can change: only the new orders are computed)
+    m_incremental_run =
+            previous_scene != nullptr &&
+            m_keep_paths &&
+            m_paths_valid &&
+            m_paths_pruning_threshold == m_pruning_threshold;
+
+    if (!m_incremental_run) {
+        // The ray paths of the last simulation are removed (the ones of this
+        // simulation are only kept if m_keep_paths is set)
+        m_paths.clear();
+        m_path_chains.clear();
+        m_paths_valid = false;
+        m_pairs_update.assign(receivers.size() * emitters.size(), PairUpdate::Full);
+        m_kept_reflections = m_compiled_scene->reflectionsCount();
+        return;
+    }
+
+    // Max order of reflection of the kept ray paths
+    m_kept_reflections = min(previous_scene->reflectionsCount(), m_compiled_scene->reflectionsCount());
+
+    const vector<CompiledWall> &prev_walls = previous_scene->getWalls();
+    const vector<CompiledEmitter> &prev_emitters = previous_scene->getEmitters();
+    const vector<CompiledReceiver> &prev_receivers = previous_scene->getReceivers();
+
+    // Map the walls of the last simulation to the new ones (-1 if removed or modified).
+    // The same Wall object can have been modified, so its properties are also compared.
+    vector<int> walls_map(prev_walls.size(), -1);
+    QHash<Wall*, int> previous_walls_indexes;
+
+    for (int j = 0 ; j < previous_walls.size() ; j++) {
+        previous_walls_indexes.insert(previous_walls.at(j), j);
+    }
+
+    for (size_t i = 0 ; i < walls.size() ; i++) {
+        const int j = previous_walls_indexes.value(m_walls_list.at((int) i), -1);
+
+        if (j < 0) {
+            continue;
+        }
+
+        const CompiledMaterial &m1 = m_compiled_scene->getMaterials()[walls[i].material];
+        const CompiledMaterial &m2 = previous_scene->getMaterials()[prev_walls[j].material];
+
+        if (walls[i].line == prev_walls[j].line &&
+                m1.rel_permitivity == m2.rel_permitivity &&
+                m1.conductivity == m2.conductivity &&
+                m1.thickness == m2.thickness)
+        {
+            walls_map[j] = (int) i;
+        }
+    }
+
+    // The new walls are the ones that are not mapped, and the lines of the new
+    // and removed walls are the lines that can change the transmissions
+    vector<bool> kept_walls(walls.size(), false);
+    vector<QLineF> changed_lines;
+
+    for (size_t j = 0 ; j < prev_walls.size() ; j++) {
+        if (walls_map[j] >= 0) {
+            kept_walls[walls_map[j]] = true;
+        }
+        else {
+            changed_lines.push_back(prev_walls[j].line);
+        }
+    }
+
+    for (size_t i = 0 ; i < walls.size() ; i++) {
+        if (!kept_walls[i]) {
+            m_new_walls[i] = true;
+            changed_lines.push_back(walls[i].line);
+        }
+    }
+
+    // The powers of the kept ray paths can be updated for other antennas, but not
+    // the pruned branches (their bound depends on the powers and antennas)
+    const bool reweighting = (m_pruning_threshold == 0);
+
+    // Map the emitters of the last simulation to the new ones (same as the walls).
+    // The ray paths of an emitter that only changed of power or antenna are kept,
+    // their powers are updated from their terms.
+    vector<int> emitters_map(prev_emitters.size(), -1);
+    vector<bool> kept_emitters(emitters.size(), false);
+    vector<bool> reweighted_emitters(emitters.size(), false);
+    QHash<Emitter*, int> previous_emitters_indexes;
+
+    for (int j = 0 ; j < previous_emitters.size() ; j++) {
+        previous_emitters_indexes.insert(previous_emitters.at(j), j);
+    }
+
+    for (size_t i = 0 ; i < emitters.size() ; i++) {
+        const int j = previous_emitters_indexes.value(m_emitters_list.at((int) i), -1);
+
+        if (j < 0) {
+            continue;
+        }
+
+        const CompiledEmitter &e1 = emitters[i];
+        const CompiledEmitter &e2 = prev_emitters[j];
+
+        if (e1.position != e2.position || e1.frequency != e2.frequency) {
+            continue;
+        }
+
+        const bool same_antenna =
+                e1.power == e2.power &&
+                e1.antenna->getAntennaType() == e2.antenna->getAntennaType() &&
+                e1.antenna->getEfficiency() == e2.antenna->getEfficiency() &&
+                e1.antenna->getRotation() == e2.antenna->getRotation();
+
+        if (same_antenna || reweighting) {
+            emitters_map[j] = (int) i;
+            kept_emitters[i] = true;
+            reweighted_emitters[i] = !same_antenna;
+        }
+    }
+
+    // Map the receivers of the last simulation to the new ones. The receivers of an area
+    // are created again with the area, so they are compared by position and antenna.
+    QHash<QPair<double, double>, int> receivers_positions;
+    vector<int> receivers_map(prev_receivers.size(), -1);
+    vector<bool> kept_receivers(receivers.size(), false);
+    vector<bool> reweighted_receivers(receivers.size(), false);
+
+    for (size_t j = 0 ; j < prev_receivers.size() ; j++) {
+        const QPointF &pos = prev_receivers[j].position;
+        receivers_positions.insert(qMakePair(pos.x(), pos.y()), (int) j);
+    }
+
+    for (size_t i = 0 ; i < receivers.size() ; i++) {
+        const QPointF &pos = receivers[i].position;
+        const int j = receivers_positions.value(qMakePair(pos.x(), pos.y()), -1);
+
+        if (j < 0 || receivers_map[j] >= 0) {
+            continue;
+        }
+
+        const CompiledReceiver &r1 = receivers[i];
+        const CompiledReceiver &r2 = prev_receivers[j];
+
+        const bool same_antenna =
+                r1.rotation == r2.rotation &&
+                r1.antenna->getAntennaType() == r2.antenna->getAntennaType() &&
+                r1.antenna->getEfficiency() == r2.antenna->getEfficiency();
+
+        if (same_antenna || reweighting) {
+            receivers_map[j] = (int) i;
+            kept_receivers[i] = true;
+            reweighted_receivers[i] = !same_antenna;
+        }
+    }
+
+    // Work to do for each couple (receiver, emitter)
+    const bool new_nodes =
+            std::find(m_new_walls.begin(), m_new_walls.end(), true) != m_new_walls.end() ||
+            m_kept_reflections < m_compiled_scene->reflectionsCount();
+
+    m_pairs_update.assign(receivers.size() * emitters.size(), PairUpdate::None);
+
+    // The receivers whose results don't change keep them (if it is the same Receiver object)
+    vector<bool> changed_receivers(receivers.size(), new_nodes);
+
+    for (size_t r = 0 ; r < receivers.size() ; r++) {
+        if (reweighted_receivers[r]) {
+            changed_receivers[r] = true;
+        }
+    }
+
+    for (size_t r = 0 ; r < receivers.size() ; r++) {
+        for (size_t e = 0 ; e < emitters.size() ; e++) {
+            unsigned char &update = m_pairs_update[r * emitters.size() + e];
+
+            if (!kept_receivers[r] || !kept_emitters[e]) {
+                update = PairUpdate::Full;
+                changed_receivers[r] = true;
+            }
+            else if (new_nodes) {
+                update = PairUpdate::Partial;
+            }
+        }
+    }
+
+    // Keep the ray paths between kept receivers and emitters, reflected on kept walls and
+    // not more than the new reflections count (with the indexes of the new scene), and find
+    // the ones to recompute. Lowering the reflections count only removes ray paths.
+    vector<SimulationPath> paths;
+    vector<int> chains;
+
+    for (SimulationPath &path : m_paths) {
+        const int r = receivers_map[path.receiver];
+        const int e = emitters_map[path.emitter];
+
+        if (r < 0) {
+            continue;
+        }
+
+        if (e < 0 || path.chain_length > m_kept_reflections) {
+            changed_receivers[r] = true;
+            continue;
+        }
+
+        const int chain = (int) chains.size();
+        bool kept = true;
+
+        for (int k = 0 ; k < path.chain_length && kept ; k++) {
+            const int w = walls_map[m_path_chains[path.chain + k]];
+
+            kept = (w >= 0);
+            chains.push_back(w);
+        }
+
+        if (!kept) {
+            chains.resize(chain);
+            changed_receivers[r] = true;
+            continue;
+        }
+
+        path.receiver = r;
+        path.emitter = e;
+        path.chain = chain;
+
+        // Only the power of this ray path changes
+        if (reweighted_receivers[r] || reweighted_emitters[e]) {
+            m_reweighted_paths.push_back((int) paths.size());
+            changed_receivers[r] = true;
+        }
+
+        // The bounding rect of the ray path is compared to the bounding rect of the wall
+        for (const QLineF &line : changed_lines) {
+            if (line.p1().x() > path.bounds.right() && line.p2().x() > path.bounds.right()) continue;
+            if (line.p1().x() < path.bounds.left() && line.p2().x() < path.bounds.left()) continue;
+            if (line.p1().y() > path.bounds.bottom() && line.p2().y() > path.bounds.bottom()) continue;
+            if (line.p1().y() < path.bounds.top() && line.p2().y() < path.bounds.top()) continue;
+
+            m_recomputed_paths.push_back((int) paths.size());
+            changed_receivers[r] = true;
+            break;
+        }
+
+        paths.push_back(std::move(path));
+    }
+
+    m_paths = std::move(paths);
+    m_path_chains = std::move(chains);
+
+    for (size_t j = 0 ; j < prev_receivers.size() ; j++) {
+        const int r = receivers_map[j];
+
+        if (r >= 0 && !changed_receivers[r] && previous_receivers.value((int) j) == m_receivers_list.at(r)) {
+            m_clean_receivers[r] = true;
+        }
+    }
+}
+
+/**
+ * @brief SimulationHandler::prepareOrdersUpdate
+ * @param previous_scene : The scene of the last simulation (or nullptr)
+ *
+ * This function finds the work to do to update an area simulation from the power of each
+ * order of reflection of its cells. It is only updated if the scene is the same apart from
+ * the reflections count: if the count is raised, only the ray paths of the new orders are
+ * computed, and if it is lowered, nothing is computed (the cells only get back the power
+ * of the kept orders). Else, all the ray paths are computed.
+ * The sums are only kept if the incremental updates are enabled.
+ */
+void SimulationHandler::prepareOrdersUpdate(const CompiledScene *previous_scene) {
+    const int receivers_count = (int) m_compiled_scene->getReceivers().size();
+    const int emitters_count = (int) m_compiled_scene->getEmitters().size();
+    const int orders_count = m_compiled_scene->reflectionsCount() + 1;
+
+    // The ray paths of a previous simulation of receivers are not kept
+    m_paths.clear();
+    m_path_chains.clear();
+    m_paths_valid = false;
+
+    m_incremental_run =
+            previous_scene != nullptr &&
+            m_orders_valid &&
+            m_paths_pruning_threshold == m_pruning_threshold &&
+            previous_scene->itemsHash() == m_compiled_scene->itemsHash();
+
+    m_orders_valid = false;
+
+    vector<double> powers;
+    vector<int> paths_counts;
+
+    if (m_incremental) {
+        powers.assign(receivers_count * orders_count, 0.0);
+        paths_counts.assign(receivers_count * orders_count, 0);
+    }
+
+    if (!m_incremental_run) {
+        m_pairs_update.assign(receivers_count * emitters_count, PairUpdate::Full);
+        m_kept_reflections = m_compiled_scene->reflectionsCount();
+    }
+    else {
+        m_kept_reflections = min(previous_scene->reflectionsCount(), m_compiled_scene->reflectionsCount());
+
+        // Keep the sums of the orders up to the new reflections count
+        for (int r = 0 ; r < receivers_count ; r++) {
+            for (int k = 0 ; k <= m_kept_reflections ; k++) {
+                powers[r * orders_count + k] = m_order_powers[r * m_orders_count + k];
+                paths_counts[r * orders_count + k] = m_order_paths_counts[r * m_orders_count + k];
+            }
+        }
+
+        // Only the new orders are computed (nothing if the count is lowered)
+        const bool new_orders = m_kept_reflections < m_compiled_scene->reflectionsCount();
+        m_pairs_update.assign(receivers_count * emitters_count, new_orders ? PairUpdate::Partial : PairUpdate::None);
+    }
+
+    m_order_powers = std::move(powers);
+    m_order_paths_counts = std::move(paths_counts);
+    m_orders_count = orders_count;
+}
+
+/**
+ * @brief SimulationHandler::addKeptOrdersPowers
+ *
+ * This function adds to each cell of an updated area the power of its kept orders of
+ * reflection (the cells are reset before, as their power changes).
+ */
+void SimulationHandler::addKeptOrdersPowers() {
+    for (int r = 0 ; r < receiversCount() ; r++) {
+        for (int k = 0 ; k <= m_kept_reflections ; k++) {
+            const int paths_count = m_order_paths_counts[r * m_orders_count + k];
+
+            if (paths_count > 0) {
+                addReceivedPower(r, m_order_powers[r * m_orders_count + k], paths_count);
+            }
+        }
+    }
+}
+
+/**
+ * @brief SimulationHandler::prunedBranchesCount
+ * @return
+ *
+ * Returns the number of branches of reflections skipped by the pruning
+ * during the last simulation
+ */
+qint64 SimulationHandler::prunedBranchesCount() {
+    return m_pruned_branches;
+}
+
+/**
+ * @brief SimulationHandler::pruningErrorEstimate
+ * @return
+ *
+ * Returns an estimate of the max power missing at a receiver because of the pruning
+ * (in Watts, max over all receivers), for the last simulation. It is not a proven bound,
+ * since the reflection coefficients of the pruned branches are estimated.
+ */
+double SimulationHandler::pruningErrorEstimate() {
+    double error = 0;
+
+    for (double p : m_pruned_power) {
+        error = max(error, p);
+    }
+
+    return error;
 }
 
 /**
@@ -711,10 +1929,10 @@ void SimulationHandler::powerDataBoundaries(double *min, double *max) {
     *max = 0;
 
     // Loop over every receiver and get its power
-    foreach(Receiver *re , m_receivers_list)
+    for (int r = 0 ; r < receiversCount() ; r++)
     {
         // Get the receiver's received power
-        double pwr = re->receivedPower();
+        double pwr = receivedPower(r);
 
         // Keep this value if min/max
         if (*min > pwr || *min == 0) {
@@ -746,6 +1964,11 @@ void SimulationHandler::showReceiversResults(ResultType::ResultType r_type) {
         max = SimulationData::convertPowerTodBm(max);
     }
 
+    // Show the results of the cells of the area at once
+    if (m_area != nullptr) {
+        m_area->showResults(m_area_cells, r_type, min, max);
+    }
+
     // Loop over every receiver and show its results
     foreach(Receiver *re , m_receivers_list)
     {
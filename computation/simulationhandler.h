@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QElapsedTimer>
 #include <QThreadPool>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
 
 #include "simulationdata.h"
 #include "interface/simulationitem.h"
@@ -11,47 +15,102 @@
 #include "constants.h"
 #include "raypath.h"
 #include "computationunit.h"
+#include "compiledscene.h"
+#include "imagetree.h"
+#include "propagationmodel.h"
+#include "resultscache.h"
+
+// Kind of work to do for a couple (receiver, emitter) in an incremental update
+namespace PairUpdate {
+enum PairUpdate {
+    None,       // Nothing changed for this couple
+    Partial,    // Only compute the new nodes of the image tree (reflected on a new wall or of a new order)
+    Full        // New receiver or emitter: compute all the ray paths
+};
+}
+
+// Ray path kept after a simulation, for the incremental updates
+struct SimulationPath
+{
+    int receiver;       // Index of the receiver in the compiled scene
+    int emitter;        // Index of the emitter in the compiled scene
+    int chain;          // Offset of the reflection walls in the chains list
+    int chain_length;   // Number of reflections
+    double power;
+    PathTerms terms;    // Terms of the power that don't depend on the antennas
+    QRectF bounds;      // Rectangle containing the lines of the ray path
+    vector<QLineF> rays;    // Lines of the ray path (only if the ray paths are shown)
+};
 
 class SimulationHandler : public QObject
 {
     Q_OBJECT
 public:
     SimulationHandler();
+    ~SimulationHandler();
 
     SimulationData *simulationData();
+    const CompiledScene *compiledScene();
+    const PropagationModel *propagationModel();
     QList<RayPath*> getRayPathsList();
+    int receivedPathsCount();
 
     bool isRunning();
 
-    static QPointF mirror(QPointF source, Wall *wall);
-
-    vector<complex> computeReflection(Emitter *em, Wall *w, QLineF in_ray);
-    vector<complex> computeTransmissons(Emitter *em, QLineF ray, Wall *origin_wall = nullptr, Wall *target_wall = nullptr);
-    vector<complex> computeNominalElecField(Emitter *em, QLineF emitter_ray, QLineF receiver_ray, double dn);
-
-    double computeRayPower(Emitter *em, Receiver *re, QLineF ray, vector<complex> En);
-
-    RayPath *computeRayPath(
-            Emitter *emitter,
-            Receiver *receiver,
-            QList<QPointF> images = QList<QPointF>(),
-            QList<Wall*> walls = QList<Wall*>());
-
-    void recursiveReflection(
-            Emitter *emitter,
-            Receiver *receiver,
-            Wall *reflect_wall,
-            QList<QPointF> images = QList<QPointF>(),
-            QList<Wall*> walls = QList<Wall*>(),
-            int level = 1);
+    void setThreadsCount(int count);
+    int threadsCount();
+
+    void setIncrementalUpdates(bool enabled);
+    bool incrementalUpdates();
+    bool lastUpdateIncremental();
+
+    void setResultsCacheEnabled(bool enabled);
+    bool resultsCacheEnabled();
+    ResultsCache *resultsCache();
+    bool lastResultsCached();
+
+    bool computeRayPath(
+            int emitter,
+            int receiver,
+            qint64 item,
+            ComputationResults *results,
+            const vector<QPointF> &images = vector<QPointF>(),
+            const vector<int> &walls = vector<int>());
+
+    void computeReflections(
+            int emitter,
+            int receiver,
+            int first,
+            int last,
+            qint64 item,
+            ComputationResults *results);
+
+    void recomputePath(int index, qint64 item, ComputationResults *results);
+    void addComputedPath(
+            qint64 item,
+            int receiver,
+            int emitter,
+            int node,
+            int path,
+            double power,
+            const PathTerms &terms,
+            const vector<QLineF> &rays,
+            ComputationResults *results);
 
     void computeAllRays();
 
-    void recursiveReflectionThreaded( Emitter *e, Receiver *r, Wall *w);
+    bool nextWorkChunk(qint64 *first, qint64 *last);
+    void computeWorkChunk(qint64 first, qint64 last, ComputationResults *results);
 
     void startSimulationComputation(QList<Receiver *> rcv_list);
+    void startSimulationComputation(ReceiversArea *area, const vector<int> &cells);
     void stopSimulationComputation();
+    void refineSimulationComputation(ReceiversArea *area, const vector<int> &cells);
     void resetComputedData();
+    void clearReceiversResults();
+
+    qint64 prunedBranchesCount();
+    double pruningErrorEstimate();
 
     void powerDataBoundaries(double *min, double *max);
     void showReceiversResults(ResultType::ResultType r_type);
@@ -63,21 +122,130 @@ signals:
     void simulationProgress(double);
 
 private slots:
+    void computationUnitProgress();
     void computationUnitFinished();
 
 private:
+    void startComputation(QList<Receiver*> rcv_list, ReceiversArea *area, const vector<int> &cells);
+    void compileScene();
+    void startComputationUnit();
+    void splitWorkChunks();
+    void mergeComputedRayPaths();
+    void mergeComputedPaths();
+    void prepareIncrementalUpdate(
+            const CompiledScene *previous_scene,
+            QList<Wall*> previous_walls,
+            QList<Emitter*> previous_emitters,
+            QList<Receiver*> previous_receivers);
+    void prepareOrdersUpdate(const CompiledScene *previous_scene);
+    void addKeptOrdersPowers();
+    void resetReceivers(QList<Receiver*> previous_receivers);
+    void addPruningReport(int receiver, const ReceivedPower &pruned, ComputationResults *results);
+
+    int receiversCount();
+    void resetReceiver(int receiver);
+    void addReceivedPower(int receiver, double power, int paths_count);
+    double receivedPower(int receiver);
+    int receivedPathsCount(int receiver);
+
+    QByteArray resultsKey();
+    bool loadCachedResults(CachedResults *results);
+    void applyCachedResults(const CachedResults &results);
+    void storeResults();
+
     SimulationData *m_simulation_data;
     QList<Receiver*> m_receivers_list;
 
+    // Area of an area simulation, and its cells to compute (used instead of the receivers list)
+    ReceiversArea *m_area;
+    vector<int> m_area_cells;
+    QList<Emitter*> m_emitters_list;
+    QList<Wall*> m_walls_list;
+
+    CompiledScene *m_compiled_scene;
+    PropagationModel *m_model;
+
+    // Results of the previous simulations (loaded instead of computed if nothing changed)
+    ResultsCache m_results_cache;
+    bool m_cache_enabled;
+    bool m_results_cached;
+
     QElapsedTimer m_computation_timer;
 
     QThreadPool m_threadpool;
     QList<ComputationUnit*> m_computation_units;
     QMutex m_mutex;
 
+    // Work items of the simulation: offsets of each couple (receiver, emitter), boundaries
+    // of the chunks, next chunk to give to a computation unit and count of computed items
+    vector<qint64> m_work_offsets;
+    vector<qint64> m_work_chunks;
+    qint64 m_work_total;
+    QAtomicInteger<qint64> m_work_next;
+    QAtomicInteger<qint64> m_work_done;
+
+    // Ray paths collected from the finished computation units
+    vector<ComputedRayPath> m_computed_ray_paths;
+    vector<QLineF> m_computed_rays;
+    vector<ComputedPower> m_computed_powers;
+
+    // Only compute the power of the ray paths (no RayPath object)
+    bool m_power_only;
+
+    // Power under which the branches of reflections are pruned (in Watts, 0 if disabled)
+    double m_pruning_threshold;
+
+    // Keep the computed ray paths, so the next simulation only computes what changed
+    // (only for the simulations whose ray paths are shown)
+    bool m_incremental;
+    bool m_keep_paths;
+    bool m_incremental_run;
+
+    // Ray paths of the last simulation (with the walls of their reflections),
+    // and the settings they were computed with
+    vector<SimulationPath> m_paths;
+    vector<int> m_path_chains;
+    bool m_paths_valid;
+    double m_paths_pruning_threshold;
+
+    // Power received by each cell of the last area simulation for each order of reflection
+    // (index receiver * m_orders_count + order, 0 for the direct ray path), so a change of
+    // the reflections count only computes the new orders, or removes the old ones
+    vector<double> m_order_powers;
+    vector<int> m_order_paths_counts;
+    int m_orders_count;
+    bool m_orders_valid;
+
+    // Count of the cells of the area before its refinement (-1 if the simulation is not
+    // a refinement), and their pruning report (given back if the refinement is cancelled)
+    int m_refined_cells_count;
+    qint64 m_refined_pruned_branches;
+    qint64 m_refined_pruned_nodes;
+
+    // Work of an incremental update: what to compute for each couple (receiver, emitter),
+    // the new walls, the max order of reflection of the kept ray paths, the nodes of each
+    // image tree that are not in the kept ray paths, the kept ray paths to recompute, the
+    // kept ray paths whose power changes (power or antenna of their emitter or receiver),
+    // the receivers that keep their results and the count of work items of the couples
+    vector<unsigned char> m_pairs_update;
+    vector<bool> m_new_walls;
+    int m_kept_reflections;
+    vector<vector<bool>> m_new_nodes;
+    vector<int> m_recomputed_paths;
+    vector<int> m_reweighted_paths;
+    vector<bool> m_clean_receivers;
+    qint64 m_work_pairs_total;
+
+    // Ray paths collected from the finished computation units (incremental updates)
+    vector<ComputedPath> m_computed_paths;
+
+    // Pruning report collected from the finished computation units
+    qint64 m_pruned_branches;
+    qint64 m_pruned_nodes;
+    vector<double> m_pruned_power;
+
     bool m_sim_started;
     bool m_sim_cancelling;
-    int m_init_cu_count;
 };
 
 #endif // SIMULATIONHANDLER_H
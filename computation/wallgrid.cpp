@@ -0,0 +1,247 @@
+#include "wallgrid.h"
+#include "compiledscene.h"
+
+#include <algorithm>
+
+// Average number of cells per wall
+#define GRID_CELLS_PER_WALL 2.0
+
+// Boundaries of the size of the grid
+#define GRID_MIN_CELL_SIZE 0.5  // [m]
+#define GRID_MAX_DIMENSION 1024 // [cells]
+
+
+WallGrid::WallGrid()
+{
+    m_cell_size = 1.0;
+    m_columns = 0;
+    m_rows = 0;
+}
+
+/**
+ * @brief WallGrid::build
+ * @param walls  : The walls to index
+ * @param bounds : The rectangle (in meters) containing all the points that will be queried
+ *
+ * This function builds the grid index over the walls.
+ */
+void WallGrid::build(const vector<CompiledWall> &walls, QRectF bounds) {
+    // Add a margin to be sure the points on the boundary are inside the grid
+    bounds.adjust(-1.0, -1.0, 1.0, 1.0);
+
+    // Choose a cell size to get about GRID_CELLS_PER_WALL cells per wall
+    const double area = bounds.width() * bounds.height();
+    const double cells_count = max(1.0, GRID_CELLS_PER_WALL * walls.size());
+
+    m_cell_size = max(GRID_MIN_CELL_SIZE, sqrt(area / cells_count));
+    m_cell_size = max(m_cell_size, bounds.width() / GRID_MAX_DIMENSION);
+    m_cell_size = max(m_cell_size, bounds.height() / GRID_MAX_DIMENSION);
+
+    m_origin = bounds.topLeft();
+    m_columns = max(1, (int) ceil(bounds.width() / m_cell_size));
+    m_rows = max(1, (int) ceil(bounds.height() / m_cell_size));
+
+    // Get the cells crossed by each wall
+    vector<vector<int>> walls_cells(walls.size());
+    vector<int> count(m_columns * m_rows, 0);
+
+    for (size_t w = 0 ; w < walls.size() ; w++) {
+        cellsOnSegment(walls[w].line, &walls_cells[w]);
+
+        for (int c : walls_cells[w]) {
+            count[c]++;
+        }
+    }
+
+    // Store the walls of all cells in one contiguous array
+    m_cell_start.assign(m_columns * m_rows + 1, 0);
+
+    for (int c = 0 ; c < m_columns * m_rows ; c++) {
+        m_cell_start[c+1] = m_cell_start[c] + count[c];
+    }
+
+    m_cell_walls.assign(m_cell_start.back(), 0);
+
+    vector<int> fill(m_cell_start.begin(), m_cell_start.end() - 1);
+
+    for (size_t w = 0 ; w < walls.size() ; w++) {
+        for (int c : walls_cells[w]) {
+            m_cell_walls[fill[c]++] = (int) w;
+        }
+    }
+}
+
+/**
+ * @brief WallGrid::segmentCandidates
+ * @param segment    : The segment (in meters)
+ * @param candidates : The list to fill with the indexes of the walls (sorted, without duplicates)
+ *
+ * This function gets the walls that may intersect the segment (the walls that are
+ * in the cells crossed by the segment).
+ * The segment can go out of the grid (all the walls are inside it).
+ */
+void WallGrid::segmentCandidates(const QLineF &segment, vector<int> *candidates) const {
+    // The cells list is reused by each thread to avoid allocations
+    static thread_local vector<int> cells;
+
+    cells.clear();
+    candidates->clear();
+
+    // Only the part of the segment inside the grid can cross a wall
+    QLineF clipped = segment;
+
+    if (!clipSegment(&clipped)) {
+        return;
+    }
+
+    cellsOnSegment(clipped, &cells);
+
+    for (int c : cells) {
+        candidates->insert(
+                    candidates->end(),
+                    m_cell_walls.begin() + m_cell_start[c],
+                    m_cell_walls.begin() + m_cell_start[c+1]);
+    }
+
+    // Keep the walls in the same order as in the scene (and only once)
+    std::sort(candidates->begin(), candidates->end());
+    candidates->erase(std::unique(candidates->begin(), candidates->end()), candidates->end());
+}
+
+/**
+ * @brief WallGrid::clipSegment
+ * @param segment : The segment to clip (in meters)
+ * @return        : False if the segment is entirely out of the grid
+ *
+ * This function clips the segment to the rectangle of the grid (Liang-Barsky algorithm).
+ */
+bool WallGrid::clipSegment(QLineF *segment) const {
+    const double x0 = segment->p1().x();
+    const double y0 = segment->p1().y();
+    const double dx = segment->dx();
+    const double dy = segment->dy();
+
+    // Distances to the boundaries of the grid (left, right, top, bottom), and their directions
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {
+        x0 - m_origin.x(),
+        m_origin.x() + m_columns * m_cell_size - x0,
+        y0 - m_origin.y(),
+        m_origin.y() + m_rows * m_cell_size - y0
+    };
+
+    // Parameters (along the segment) of the clipped segment ends
+    double t0 = 0.0;
+    double t1 = 1.0;
+
+    for (int i = 0 ; i < 4 ; i++) {
+        if (p[i] == 0) {
+            // Parallel to this boundary and outside
+            if (q[i] < 0) {
+                return false;
+            }
+            continue;
+        }
+
+        const double t = q[i] / p[i];
+
+        if (p[i] < 0) {
+            t0 = max(t0, t);
+        }
+        else {
+            t1 = min(t1, t);
+        }
+    }
+
+    if (t0 > t1) {
+        return false;
+    }
+
+    // Don't move the ends that are inside the grid
+    if (t0 > 0 || t1 < 1) {
+        *segment = QLineF(segment->pointAt(t0), segment->pointAt(t1));
+    }
+
+    return true;
+}
+
+/**
+ * @brief WallGrid::cellsOnSegment
+ * @param segment : The segment (in meters)
+ * @param cells   : The list where to append the indexes of the cells
+ *
+ * This function gets the cells crossed by the segment (3D-DDA algorithm in 2D).
+ * When the segment passes exactly through a corner, the two neighbour cells are taken.
+ */
+void WallGrid::cellsOnSegment(const QLineF &segment, vector<int> *cells) const {
+    // Coordinates of the segment in cells units
+    const double x0 = (segment.p1().x() - m_origin.x()) / m_cell_size;
+    const double y0 = (segment.p1().y() - m_origin.y()) / m_cell_size;
+    const double x1 = (segment.p2().x() - m_origin.x()) / m_cell_size;
+    const double y1 = (segment.p2().y() - m_origin.y()) / m_cell_size;
+
+    // Start and end cells (limited to the grid)
+    int cx = qBound(0, (int) floor(x0), m_columns - 1);
+    int cy = qBound(0, (int) floor(y0), m_rows - 1);
+    const int cx_end = qBound(0, (int) floor(x1), m_columns - 1);
+    const int cy_end = qBound(0, (int) floor(y1), m_rows - 1);
+
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+
+    const int step_x = (dx > 0 ? 1 : -1);
+    const int step_y = (dy > 0 ? 1 : -1);
+
+    // Parameter (along the segment) to cross one cell in each direction
+    const double t_delta_x = (dx != 0 ? fabs(1.0 / dx) : INFINITY);
+    const double t_delta_y = (dy != 0 ? fabs(1.0 / dy) : INFINITY);
+
+    // Parameter of the next vertical and horizontal cells boundaries
+    double t_max_x = INFINITY;
+    double t_max_y = INFINITY;
+
+    if (dx > 0) {
+        t_max_x = (cx + 1 - x0) / dx;
+    }
+    else if (dx < 0) {
+        t_max_x = (x0 - cx) / -dx;
+    }
+
+    if (dy > 0) {
+        t_max_y = (cy + 1 - y0) / dy;
+    }
+    else if (dy < 0) {
+        t_max_y = (y0 - cy) / -dy;
+    }
+
+    cells->push_back(cy * m_columns + cx);
+
+    // Number of cells steps to reach the end cell
+    int steps = abs(cx_end - cx) + abs(cy_end - cy);
+
+    while (steps > 0) {
+        if (fabs(t_max_x - t_max_y) < 1e-12 && cx != cx_end && cy != cy_end) {
+            // The segment goes through a corner: take the two neighbour cells
+            cells->push_back(cy * m_columns + (cx + step_x));
+            cells->push_back((cy + step_y) * m_columns + cx);
+
+            cx += step_x;
+            cy += step_y;
+            t_max_x += t_delta_x;
+            t_max_y += t_delta_y;
+            steps -= 2;
+        }
+        else if ((t_max_x < t_max_y && cx != cx_end) || cy == cy_end) {
+            cx += step_x;
+            t_max_x += t_delta_x;
+            steps--;
+        }
+        else {
+            cy += step_y;
+            t_max_y += t_delta_y;
+            steps--;
+        }
+
+        cells->push_back(cy * m_columns + cx);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef WALLGRID_H
+#define WALLGRID_H
+
+#include <QPointF>
+#include <QLineF>
+#include <QRectF>
+
+#include "constants.h"
+
+struct CompiledWall;
+
+/**
+ * This class is a uniform grid index over the walls of a compiled scene.
+ * Each cell stores the walls whose segment goes through it, so a segment query only
+ * visits the walls that are in the cells crossed by the segment.
+ */
+class WallGrid
+{
+public:
+    WallGrid();
+
+    void build(const vector<CompiledWall> &walls, QRectF bounds);
+    void segmentCandidates(const QLineF &segment, vector<int> *candidates) const;
+
+private:
+    bool clipSegment(QLineF *segment) const;
+    void cellsOnSegment(const QLineF &segment, vector<int> *cells) const;
+
+    QPointF m_origin;
+    double m_cell_size;
+    int m_columns;
+    int m_rows;
+
+    // Walls of each cell: walls of the cell i are m_cell_walls[m_cell_start[i] .. m_cell_start[i+1]]
+    vector<int> m_cell_start;
+    vector<int> m_cell_walls;
+};
+
+#endif // WALLGRID_H
@@ -5,16 +5,6 @@
 #include <QPen>
 #include <QPainter>
 
-// Wall's relative permittivity
-#define BRICK_R_PERMITTIVITY      4.6
-#define CONCRETE_R_PERMITTIVITY   5
-#define PARTITION_R_PERMITTIVITY  2.25
-
-// Wall's conductivity
-#define BRICK_CONDUCTIVITY      0.02
-#define CONCRETE_CONDUCTIVITY   0.014
-#define PARTITION_CONDUCTIVITY  0.04
-
 // Wall's default thickness (meter)
 #define BRICK_THICKNESS_DEFAULT      0.35
 #define CONCRETE_THICKNESS_DEFAULT   0.30
@@ -33,6 +23,8 @@ Wall::Wall(QLineF line, double thickness) : SimulationItem() {
     m_thickness = thickness;
 
     m_text_scale = 1.0;
+
+    m_geometry_valid = false;
 }
 
 void Wall::setupTooltip() {
@@ -53,6 +45,7 @@ QLineF Wall::getLine() {
 void Wall::setLine(QLineF line) {
     prepareGeometryChange();
     m_line = line;
+    invalidateGeometry();
     update();
 }
 
@@ -63,7 +56,7 @@ void Wall::setLine(QLineF line) {
  * This function returns the real line of the wall (in meters)
  */
 QLineF Wall::getRealLine() {
-    qreal scale = simulationScene()->simulationScale();
+    qreal scale = simulationScale();
     return QLineF(m_line.p1() / scale, m_line.p2() / scale);
 }
 
@@ -97,6 +90,7 @@ QPen Wall::getPen() {
 void Wall::setPen(QPen pen) {
     prepareGeometryChange();
     m_pen = pen;
+    invalidateGeometry();
     update();
 }
 
@@ -110,6 +104,24 @@ void Wall::setBrush(QBrush b) {
     update();
 }
 
+/**
+ * @brief Wall::setTextScale
+ * @param scale : The inverse of the scale of the view
+ *
+ * This function sets the scale of the length text shown while placing the wall, so it
+ * keeps the same size on the screen (the rect of the text is in the shape of the wall).
+ */
+void Wall::setTextScale(qreal scale) {
+    if (scale == m_text_scale) {
+        return;
+    }
+
+    prepareGeometryChange();
+    m_text_scale = scale;
+    invalidateGeometry();
+    update();
+}
+
 QRectF Wall::getLengthTextRect() const {
     // Length of the line (in pixels)
     const qreal line_length = m_line.length();
@@ -125,16 +137,29 @@ QRectF Wall::getLengthTextRect() const {
                   text_height);
 }
 
-QRectF Wall::boundingRect() const {
-    // Return the rectangle containing the line
-    return shape().controlPointRect();
+void Wall::invalidateGeometry() {
+    m_geometry_valid = false;
 }
 
-QPainterPath Wall::shape() const {
+/**
+ * @brief Wall::updateGeometry
+ *
+ * This function computes the cached paths and bounding rect of the wall (if needed)
+ */
+void Wall::updateGeometry() const {
+    if (m_geometry_valid) {
+        return;
+    }
+
     QPainterPath path;
     path.moveTo(m_line.p1());
     path.lineTo(m_line.p2());
 
+    // Get the bounding path of the line representing the wall
+    QPainterPathStroker wall_ps;
+    wall_ps.setWidth(VISUAL_THICKNESS);
+    m_wall_path = wall_ps.createStroke(path);
+
     // Add the wall's length text if we are in placing mode
     if (placingMode()) {
         path.addRect(getLengthTextRect());
@@ -146,9 +171,23 @@ QPainterPath Wall::shape() const {
     ps.setJoinStyle(m_pen.joinStyle());
     ps.setMiterLimit(m_pen.miterLimit());
 
-    QPainterPath p = ps.createStroke(path);
-    p.addPath(path);
-    return p;
+    m_shape = ps.createStroke(path);
+    m_shape.addPath(path);
+
+    // The bounding rect is the rectangle containing the line
+    m_bounding_rect = m_shape.controlPointRect();
+
+    m_geometry_valid = true;
+}
+
+QRectF Wall::boundingRect() const {
+    updateGeometry();
+    return m_bounding_rect;
+}
+
+QPainterPath Wall::shape() const {
+    updateGeometry();
+    return m_shape;
 }
 
 void Wall::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) {
@@ -161,15 +200,8 @@ void Wall::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
     if (m_line.p1() == m_line.p2())
         return;
 
-    // Virtually trace the wall path
-    QPainterPath path;
-    path.moveTo(m_line.p1());
-    path.lineTo(m_line.p2());
-
     // Get the bounding path of the line representing the wall
-    QPainterPathStroker ps;
-    ps.setWidth(VISUAL_THICKNESS);
-    QPainterPath p = ps.createStroke(path);
+    updateGeometry();
 
     // The brush pattern must follow the wall's scale and rotation
     QTransform tr;
@@ -186,7 +218,7 @@ void Wall::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
     painter->setBackground(QColor(Qt::white));
 
     // Draw the path representing the wall
-    painter->drawPath(p);
+    painter->drawPath(m_wall_path);
 
     // Reset the transparent background
     painter->setBackgroundMode(Qt::TransparentMode);
@@ -199,9 +231,6 @@ void Wall::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
         painter->setPen(Qt::black);
         painter->setBrush(QBrush());
 
-        // Store the new text scale (inverse of the current view scale)
-        m_text_scale = 1.0 / painter->transform().m11();
-
         // Scale the font size to keep a readable measure reagardless of the zoom
         QFont f = painter->font();
         f.setPointSizeF(f.pointSizeF() * m_text_scale);
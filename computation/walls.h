@@ -5,15 +5,7 @@
 #include <QPen>
 
 #include "interface/simulationitem.h"
-
-// Type used to recognize the saved classes into a file
-namespace WallType {
-enum WallType{
-    BrickWall       = 1,
-    ConcreteWall    = 2,
-    PartitionWall   = 3,
-};
-}
+#include "materials.h"
 
 // Abstract wall class
 class Wall : public SimulationItem
@@ -36,6 +28,8 @@ public:
     QBrush getBrush();
     void setBrush(QBrush b);
 
+    void setTextScale(qreal scale);
+
     virtual QString getTypeName() const = 0;
 
     // The 'virtual' keyword makes these functions abstracts
@@ -47,8 +41,11 @@ public:
     QPainterPath shape() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) override;
 
+    void invalidateGeometry() override;
+
 private:
     QRectF getLengthTextRect() const;
+    void updateGeometry() const;
 
     QLineF m_line;
     double  m_thickness;
@@ -57,6 +54,13 @@ private:
     QBrush m_brush;
 
     qreal m_text_scale;
+
+    // Cached geometry: the painted path of the wall, the shape and bounding rect
+    // of the item (computed again after a change of the line, pen or placing mode)
+    mutable bool m_geometry_valid;
+    mutable QPainterPath m_wall_path;
+    mutable QPainterPath m_shape;
+    mutable QRectF m_bounding_rect;
 };
 
 
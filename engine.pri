@@ -0,0 +1,30 @@
+# Computation core: the compiled scene and the propagation model (ray paths and received powers).
+# These files only depend on QtCore (no graphics item). They are built once in the static library
+# of engine/engine.pro, which the graphical application and the command-line runner link
+# (see simulation.pri).
+
+QT       += core
+
+QMAKE_CXXFLAGS += -std=c++14
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/computation/antennas.cpp \
+    $$PWD/computation/channelmetrics.cpp \
+    $$PWD/computation/compiledscene.cpp \
+    $$PWD/computation/imagetree.cpp \
+    $$PWD/computation/propagationmodel.cpp \
+    $$PWD/computation/resultscache.cpp \
+    $$PWD/computation/wallgrid.cpp
+
+HEADERS += \
+    $$PWD/computation/antennas.h \
+    $$PWD/computation/channelmetrics.h \
+    $$PWD/computation/compiledscene.h \
+    $$PWD/computation/constants.h \
+    $$PWD/computation/imagetree.h \
+    $$PWD/computation/materials.h \
+    $$PWD/computation/propagationmodel.h \
+    $$PWD/computation/resultscache.h \
+    $$PWD/computation/wallgrid.h
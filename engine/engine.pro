@@ -0,0 +1,10 @@
+# Static library of the computation core (without the graphics items)
+
+TEMPLATE = lib
+CONFIG += staticlib
+
+QT -= gui
+
+TARGET = Physics_project_engine
+
+include(../engine.pri)
@@ -22,6 +22,9 @@
 #define PROXIMITY_SIZE 16
 #define ERASER_SIZE 20
 
+// Step of the first grid of a progressive simulation (in receivers, halved at each level)
+#define PROGRESSIVE_FIRST_STEP 8
+
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -61,6 +64,22 @@ MainWindow::MainWindow(QWidget *parent)
     // The simulation handler manages the simulation's data
     m_simulation_handler = new SimulationHandler();
 
+    // No progressive simulation running
+    m_progressive_step = 0;
+    m_progressive_stopped = false;
+    m_progressive_completed = false;
+    m_adaptive = false;
+
+    // Keep the ray paths between the simulations, so only the ray paths
+    // affected by the changes of the scene are computed again (only for the
+    // point receivers: an area is computed again after a change of the scene,
+    // except for the reflections count whose new orders are only computed)
+    m_simulation_handler->setIncrementalUpdates(true);
+
+    // Load the results of a simulation already done (same plan and settings) from the cache
+    // (disabled by default, enabled from the Simulation menu)
+    m_simulation_handler->setResultsCacheEnabled(ui->actionResultsCache->isChecked());
+
     // Hide the simulation group by default
     ui->group_simulation->hide();
 
@@ -99,6 +118,10 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->actionZoomReset,    SIGNAL(triggered()), this, SLOT(actionZoomReset()));
     connect(ui->actionZoomBest,     SIGNAL(triggered()), this, SLOT(actionZoomBest()));
 
+    // Window Simulation menu actions
+    connect(ui->actionResultsCache, SIGNAL(triggered(bool)), this, SLOT(actionResultsCache(bool)));
+    connect(ui->actionClearCache,   SIGNAL(triggered()),     this, SLOT(actionClearCache()));
+
     // Right-panel buttons
     // Scene edition buttons group
     connect(ui->button_addBrickWall,    SIGNAL(clicked()),      this, SLOT(addBrickWall()));
@@ -117,6 +140,9 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->button_simExport,  SIGNAL(clicked()),         this, SLOT(exportSimulationAction()));
     connect(ui->checkbox_rays,     SIGNAL(toggled(bool)),     this, SLOT(raysCheckboxToggled(bool)));
     connect(ui->slider_threshold,  SIGNAL(valueChanged(int)), this, SLOT(raysThresholdChanged(int)));
+    connect(ui->combobox_rays_emitter,     SIGNAL(currentIndexChanged(int)), this, SLOT(filterRaysThreshold()));
+    connect(ui->spinbox_rays_reflections,  SIGNAL(valueChanged(int)),        this, SLOT(filterRaysThreshold()));
+    connect(ui->spinbox_rays_count,        SIGNAL(valueChanged(int)),        this, SLOT(filterRaysThreshold()));
     connect(ui->radio_bitrate,     SIGNAL(toggled(bool)),     this, SLOT(showReceiversResult()));
 
     connect(ui->combobox_simType,  SIGNAL(currentIndexChanged(int)),
@@ -125,6 +151,14 @@ MainWindow::MainWindow(QWidget *parent)
             this, SLOT(receiversAntennaChanged()));
     connect(ui->spinbox_reflections, SIGNAL(valueChanged(int)),
             m_simulation_handler->simulationData(), SLOT(setReflectionsCount(int)));
+    connect(ui->checkbox_pruning, SIGNAL(toggled(bool)),
+            m_simulation_handler->simulationData(), SLOT(setPruningEnabled(bool)));
+    connect(ui->checkbox_pruning, SIGNAL(toggled(bool)),
+            ui->spinbox_pruning, SLOT(setEnabled(bool)));
+    connect(ui->spinbox_pruning, SIGNAL(valueChanged(double)),
+            m_simulation_handler->simulationData(), SLOT(setPruningThreshold(double)));
+    connect(ui->checkbox_adaptive, SIGNAL(toggled(bool)),
+            ui->spinbox_tolerance, SLOT(setEnabled(bool)));
 
     // Simulation handler signals
     connect(m_simulation_handler, SIGNAL(simulationStarted()), this, SLOT(simulationStarted()));
@@ -198,6 +232,13 @@ void MainWindow::updateSceneRect() {
     // The scale factor is the diagonal components of the transformation matrix
     qreal scale_factor = ui->graphicsView->transform().m11();
 
+    // The length text of a wall being placed keeps the same size on the screen
+    Wall *drawing_wall = dynamic_cast<Wall*>(m_drawing_item);
+
+    if (drawing_wall != nullptr) {
+        drawing_wall->setTextScale(1.0 / scale_factor);
+    }
+
     // Offset to avoid the scrollbars
     int offset = ceil(2/scale_factor);
 
@@ -396,6 +437,9 @@ void MainWindow::configureEmitter(Emitter *em) {
     em->setPower(power);
     em->setFrequency(frequency);
     em->setAntenna(type, efficiency);
+
+    // The shape of the emitter depends on its antenna
+    m_simulation_handler->simulationData()->updateItem(em);
 }
 
 void MainWindow::configureReceiver(Receiver *re) {
@@ -411,6 +455,9 @@ void MainWindow::configureReceiver(Receiver *re) {
 
     // Update the receiver
     re->setAntenna(type, efficiency);
+
+    // Index the receiver again (same as an emitter)
+    m_simulation_handler->simulationData()->updateItem(re);
 }
 
 void MainWindow::addEmitter() {
@@ -646,6 +693,7 @@ void MainWindow::graphicsSceneLeftReleased(QGraphicsSceneMouseEvent *event) {
             QLine line(pos, pos);
             BrickWall *wall = new BrickWall(line);
             wall->setPlacingMode(true);
+            wall->setTextScale(1.0 / ui->graphicsView->transform().m11());
             m_drawing_item = wall;
             m_scene->addItem(m_drawing_item);
             break;
@@ -656,6 +704,7 @@ void MainWindow::graphicsSceneLeftReleased(QGraphicsSceneMouseEvent *event) {
             QLine line(pos, pos);
             ConcreteWall *wall = new ConcreteWall(line);
             wall->setPlacingMode(true);
+            wall->setTextScale(1.0 / ui->graphicsView->transform().m11());
             m_drawing_item = wall;
             m_scene->addItem(m_drawing_item);
             break;
@@ -666,6 +715,7 @@ void MainWindow::graphicsSceneLeftReleased(QGraphicsSceneMouseEvent *event) {
             QLine line(pos, pos);
             PartitionWall *wall = new PartitionWall(line);
             wall->setPlacingMode(true);
+            wall->setTextScale(1.0 / ui->graphicsView->transform().m11());
             m_drawing_item = wall;
             m_scene->addItem(m_drawing_item);
             break;
@@ -755,33 +805,17 @@ void MainWindow::graphicsSceneLeftReleased(QGraphicsSceneMouseEvent *event) {
         case DrawActions::Erase: {
             QGraphicsRectItem *rect_item = (QGraphicsRectItem*) m_drawing_item;
 
-            // Retreive all items under the eraser rectangle
+            // Retreive all items under the eraser rectangle (from the index of the
+            // simulation data, so only the walls, emitters and receivers)
             QRectF rect (rect_item->pos(), rect_item->rect().size());
-            QList<QGraphicsItem*> trash = m_scene->items(rect);
+            QList<SimulationItem*> trash = m_simulation_handler->simulationData()->editorIndex()->itemsIn(rect);
+
+            // Remove them from the simulation data at once
+            m_simulation_handler->simulationData()->detachItems(trash);
 
             // Remove each items from the graphics scene and delete it
-            foreach (QGraphicsItem *item, trash) {
-                // Don't remove other items (ie: mouse tracker lines or
-                // eraser rectancgle) than the type SimulationItem
-                if (!(dynamic_cast<SimulationItem*>(item))) {
-                    continue;
-                }
-
-                // Remove the item from the scene
+            foreach (SimulationItem *item, trash) {
                 m_scene->removeItem(item);
-
-                // Action for some types of items
-                if (dynamic_cast<Wall*>(item)) {
-                    // Remove it from the walls list
-                    m_simulation_handler->simulationData()->detachWall((Wall*) item);
-                }
-                else if (dynamic_cast<Emitter*>(item)){
-                    m_simulation_handler->simulationData()->detachEmitter((Emitter*) item);
-                }
-                else if (dynamic_cast<Receiver*>(item)){
-                    m_simulation_handler->simulationData()->detachReceiver((Receiver*) item);
-                }
-
                 delete item;
             }
             break;
@@ -891,50 +925,28 @@ QPoint MainWindow::moveAligned(QPoint start, QPoint actual) {
 }
 
 QPoint MainWindow::attractivePoint(QPoint actual) {
-    double min_dist = PROXIMITY_SIZE + 1;
+    // The walls are found with the index of the simulation data (the wall
+    // being drawn is not attached to the simulation data yet)
+    const EditorIndex *index = m_simulation_handler->simulationData()->editorIndex();
+
+    // Point over point alignment (the closest end of a wall)
+    QPointF end_point;
+
+    if (index->nearestEndpoint(actual, PROXIMITY_SIZE + 1, &end_point)) {
+        return end_point.toPoint();
+    }
+
     QPoint attractive_point = actual;
+    double aligned;
 
-    // Loop over each Wall of the scene
-    foreach (QGraphicsItem *item, m_scene->items()) {
-        // Skip this item if it's the current drawing item
-        if (item == m_drawing_item)
-            continue;
+    // Horizontal alignment (with the closest end of a wall)
+    if (index->alignedX(actual.x(), PROXIMITY_SIZE, &aligned)) {
+        attractive_point.setX(qRound(aligned));
+    }
 
-        // Use the dynamic cast to be shure the item is a Wall
-        Wall* wall_item = dynamic_cast<Wall*>(item);
-
-        // If this item is a wall
-        if (wall_item) {
-            // Save the two points of the line in a list to loop over them
-            QList<QPointF> line_points;
-            line_points << wall_item->getLine().p1() << wall_item->getLine().p2();
-
-            // For the two points of the line (start and end points)
-            foreach (QPointF pt, line_points) {
-                QLineF bounding_line(actual, pt);
-
-                double true_lenght       = bounding_line.length();
-                double horizontal_length = abs(actual.x() - pt.x());
-                double vertical_length   = abs(actual.y() - pt.y());
-
-                // Keep the one with the closest distance to the mouse position
-                if (true_lenght < min_dist) {
-                    // Point over point alignment
-                    min_dist = true_lenght;
-                    attractive_point = pt.toPoint();
-                }
-                else {
-                    if (horizontal_length < PROXIMITY_SIZE) {
-                        // Horizontal alignment
-                        attractive_point = QPoint(pt.x(), attractive_point.y());
-                    }
-                    if (vertical_length < PROXIMITY_SIZE) {
-                        // Vertical alignment
-                        attractive_point = QPoint(attractive_point.x(), pt.y());
-                    }
-                }
-            }
-        }
+    // Vertical alignment (with the closest end of a wall)
+    if (index->alignedY(actual.y(), PROXIMITY_SIZE, &aligned)) {
+        attractive_point.setY(qRound(aligned));
     }
 
     return attractive_point;
@@ -1107,6 +1119,15 @@ void MainWindow::actionZoomBest() {
     bestView();
 }
 
+void MainWindow::actionResultsCache(bool enabled) {
+    m_simulation_handler->setResultsCacheEnabled(enabled);
+}
+
+void MainWindow::actionClearCache() {
+    m_simulation_handler->resultsCache()->clear();
+    ui->statusbar->showMessage("Cache des résultats vidé");
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////// MODE SWITCHING FUNCTIONS //////////////////////////////////////
@@ -1149,12 +1170,15 @@ void MainWindow::switchEditSceneMode() {
     if (m_ui_mode == UIMode::EditorMode)
         return;
 
-    // This will reset the simulation data
-    bool ans = askSimulationReset();
+    // Clear the results of the receivers (the computed ray paths are kept
+    // by the simulation handler to update them after the changes)
+    m_simulation_handler->clearReceiversResults();
+    m_scene->hideDataLegend();
+    m_scene->clearRayPaths();
 
-    // Don't continue if user refused
-    if (!ans)
-        return;
+    if (m_sim_area_item != nullptr) {
+        m_sim_area_item->resetSampling();
+    }
 
     // Set the current mode to EditorMode
     m_ui_mode = UIMode::EditorMode;
@@ -1190,6 +1214,11 @@ void MainWindow::updateSimulationUI() {
     // Set the current reflections count
     ui->spinbox_reflections->setValue(m_simulation_handler->simulationData()->maxReflectionsCount());
 
+    // Set the current pruning settings
+    ui->checkbox_pruning->setChecked(m_simulation_handler->simulationData()->pruningEnabled());
+    ui->spinbox_pruning->setValue(m_simulation_handler->simulationData()->pruningThreshold());
+    ui->spinbox_pruning->setEnabled(ui->checkbox_pruning->isChecked());
+
     if (!m_simulation_handler->isRunning()) {
         // Hide the progress bar
         ui->progressbar_simulation->hide();
@@ -1251,8 +1280,15 @@ void MainWindow::simulationTypeChanged() {
 }
 
 void MainWindow::receiversAntennaChanged() {
-    // Reset the computed data
-    simulationReset();
+    // Clear the results of the receivers (the computed ray paths are kept, so
+    // only their powers are updated for the new antenna by the next simulation)
+    m_simulation_handler->clearReceiversResults();
+    m_scene->hideDataLegend();
+    m_scene->clearRayPaths();
+
+    if (m_sim_area_item != nullptr) {
+        m_sim_area_item->resetSampling();
+    }
 
     updateSimulationUI();
     updateSimulationScene();
@@ -1284,6 +1320,8 @@ void MainWindow::simulationControlAction() {
         switch (m_simulation_handler->simulationData()->simulationType())
         {
         case SimType::PointReceiver: {
+            m_progressive_step = 0;
+
             QList<Receiver*> rcv_list = m_simulation_handler->simulationData()->getReceiverList();
             m_simulation_handler->startSimulationComputation(rcv_list);
             break;
@@ -1295,12 +1333,32 @@ void MainWindow::simulationControlAction() {
                 return;
             }
 
-            m_simulation_handler->startSimulationComputation(m_sim_area_item->getReceiversList());
+            // A progressive simulation starts with a coarse grid of cells, then refines it.
+            // An adaptive sampling is always progressive.
+            m_adaptive = ui->checkbox_adaptive->isChecked();
+            m_progressive_step = 0;
+            m_progressive_stopped = false;
+            m_progressive_completed = false;
+
+            if (ui->checkbox_progressive->isChecked() || m_adaptive) {
+                m_progressive_step = PROGRESSIVE_FIRST_STEP;
+            }
+
+            m_sim_area_item->resetSampling();
+
+            if (m_progressive_step == 0) {
+                m_sim_area_item->setGridSize(1);
+            }
+
+            m_simulation_handler->startSimulationComputation(m_sim_area_item, progressiveCellsList());
             break;
         }
         }
     }
     else {
+        // Keep the last completed grid of a progressive simulation (if one)
+        m_progressive_stopped = m_progressive_completed;
+
         // Cancel the current simulation
         m_simulation_handler->stopSimulationComputation();
 
@@ -1315,6 +1373,11 @@ void MainWindow::simulationStarted() {
     ui->combobox_simType->setEnabled(false);
     ui->combobox_antennas_type->setEnabled(false);
     ui->spinbox_reflections->setEnabled(false);
+    ui->checkbox_pruning->setEnabled(false);
+    ui->spinbox_pruning->setEnabled(false);
+    ui->checkbox_progressive->setEnabled(false);
+    ui->checkbox_adaptive->setEnabled(false);
+    ui->spinbox_tolerance->setEnabled(false);
     ui->button_simReset->setEnabled(false);
     ui->button_editScene->setEnabled(false);
     ui->actionOpen->setEnabled(false);
@@ -1325,13 +1388,55 @@ void MainWindow::simulationStarted() {
 
     // Show the progress bar
     ui->progressbar_simulation->show();
+
+    // The previous ray paths are deleted by the simulation
+    m_scene->clearRayPaths();
 }
 
 void MainWindow::simulationFinished() {
+    // Show the grid computed by a progressive simulation, and compute the next one
+    if (m_progressive_step > 0) {
+        // Each cell covers the cells of the finer grids
+        m_sim_area_item->setGridSize(m_progressive_step);
+
+        if (m_progressive_step > 1 && !m_progressive_stopped) {
+            showReceiversResult();
+
+            // The cells of this grid keep their results (and stay shown) while the
+            // next grid only computes its new cells
+            m_progressive_completed = true;
+
+            m_progressive_step /= 2;
+            m_simulation_handler->refineSimulationComputation(m_sim_area_item, progressiveCellsList());
+            return;
+        }
+
+        m_progressive_step = 0;
+        m_progressive_stopped = false;
+        m_progressive_completed = false;
+    }
+
+    // Show the count of points computed by an adaptive sampling
+    if (m_adaptive && m_sim_area_item != nullptr) {
+        const int total = m_sim_area_item->cellsCount();
+        const int interpolated = m_sim_area_item->interpolatedCount();
+
+        ui->statusbar->showMessage(
+                    QString("Points calculés : %1 sur %2 (%3 interpolés)")
+                    .arg(total - interpolated)
+                    .arg(total)
+                    .arg(interpolated));
+    }
+
     // Enable the UI controls
     ui->combobox_simType->setEnabled(true);
     ui->combobox_antennas_type->setEnabled(true);
     ui->spinbox_reflections->setEnabled(true);
+    ui->checkbox_pruning->setEnabled(true);
+    ui->spinbox_pruning->setEnabled(ui->checkbox_pruning->isChecked());
+    ui->checkbox_progressive->setEnabled(true);
+    ui->checkbox_adaptive->setEnabled(true);
+    ui->spinbox_tolerance->setEnabled(ui->checkbox_adaptive->isChecked());
     ui->button_simReset->setEnabled(true);
     ui->button_editScene->setEnabled(true);
     ui->actionOpen->setEnabled(true);
@@ -1345,24 +1450,56 @@ void MainWindow::simulationFinished() {
 
     // Don't add the ray paths is this is a AreaReceivers simulations
     if (m_simulation_handler->simulationData()->simulationType() == SimType::PointReceiver) {
-        // Add all computed rays to the scene
-        foreach (RayPath *rp, m_simulation_handler->getRayPathsList()) {
-            m_scene->addItem(rp);
-        }
+        // Draw all computed rays (in a single item)
+        m_scene->showRayPaths(m_simulation_handler->getRayPathsList());
     }
 
     // Filter the rays to show
+    updateRaysEmitterFilter();
     filterRaysThreshold();
 
     // Show the results
     showReceiversResult();
+
+    // Show the pruning report
+    if (m_simulation_handler->simulationData()->pruningEnabled()) {
+        double error = m_simulation_handler->pruningErrorEstimate();
+
+        ui->statusbar->showMessage(
+                    QString("Branches élaguées : %1 - Erreur estimée par récepteur : %2")
+                    .arg(m_simulation_handler->prunedBranchesCount())
+                    .arg(error > 0 ? QString("%1 dBm").arg(SimulationData::convertPowerTodBm(error), 0, 'f', 1) : "0 W"));
+    }
 }
 
 void MainWindow::simulationCancelled() {
+    // Stop a progressive simulation at its last completed grid as if it was finished
+    // (the handler reset the new cells of the cancelled grid, nothing is computed)
+    if (m_progressive_stopped) {
+        // The sampling of the cancelled grid is undone (the previous grid is the
+        // grid of twice its step)
+        if (m_adaptive) {
+            m_sim_area_item->cancelSampling(m_progressive_step);
+        }
+
+        m_progressive_step *= 2;
+        simulationFinished();
+        return;
+    }
+
+    m_progressive_step = 0;
+    m_progressive_stopped = false;
+    m_progressive_completed = false;
+
     // Enable the UI controls
     ui->combobox_simType->setEnabled(true);
     ui->combobox_antennas_type->setEnabled(true);
     ui->spinbox_reflections->setEnabled(true);
+    ui->checkbox_pruning->setEnabled(true);
+    ui->spinbox_pruning->setEnabled(ui->checkbox_pruning->isChecked());
+    ui->checkbox_progressive->setEnabled(true);
+    ui->checkbox_adaptive->setEnabled(true);
+    ui->spinbox_tolerance->setEnabled(ui->checkbox_adaptive->isChecked());
     ui->button_simReset->setEnabled(true);
     ui->button_editScene->setEnabled(true);
     ui->actionOpen->setEnabled(true);
@@ -1386,6 +1523,31 @@ void MainWindow::simulationProgress(double p) {
 void MainWindow::simulationReset() {
     m_simulation_handler->resetComputedData();
     m_scene->hideDataLegend();
+    m_scene->clearRayPaths();
+
+    if (m_sim_area_item != nullptr) {
+        m_sim_area_item->resetSampling();
+    }
+}
+
+/**
+ * @brief MainWindow::progressiveCellsList
+ * @return
+ *
+ * This function returns the cells of the area to compute for the current grid of
+ * a progressive simulation (the cells of the grid that are not in the completed
+ * grid, or only the ones needed by the adaptive sampling).
+ */
+vector<int> MainWindow::progressiveCellsList() {
+    if (m_adaptive) {
+        return m_sim_area_item->getSampledCellsList(m_progressive_step, ui->spinbox_tolerance->value());
+    }
+
+    if (m_progressive_completed) {
+        return m_sim_area_item->getRefinedCellsList(m_progressive_step);
+    }
+
+    return m_sim_area_item->getCellsList(m_progressive_step);
 }
 
 void MainWindow::simulationResetAction() {
@@ -1414,6 +1576,9 @@ void MainWindow::raysCheckboxToggled(bool state) {
     ui->label_threshold_msg->setEnabled(state);
     ui->label_threshold_val->setEnabled(state);
     ui->slider_threshold->setEnabled(state);
+    ui->combobox_rays_emitter->setEnabled(state);
+    ui->spinbox_rays_reflections->setEnabled(state);
+    ui->spinbox_rays_count->setEnabled(state);
 
     // Apply the filter to hide/show the rays
     filterRaysThreshold();
@@ -1437,22 +1602,45 @@ void MainWindow::filterRaysThreshold() {
     // Convert the threshold in Watts
     const double threshold = SimulationData::convertPowerToWatts(ui->slider_threshold->value());
 
-    // Loop over the RayPaths
-    foreach (RayPath *rp, m_simulation_handler->getRayPathsList())
-    {
-        // Hide the RayPaths with a power lower than the threshold, or checkbox not checked, or
-        // UI is not in simulation mode, or simulation type is area
-        if (rp->getPower() > threshold &&
-                ui->checkbox_rays->isChecked() &&
-                m_ui_mode == UIMode::SimulationMode &&
-                m_simulation_handler->simulationData()->simulationType() == SimType::PointReceiver)
-        {
-            rp->show();
-        }
-        else {
-            rp->hide();
-        }
+    // Hide the RayPaths with a power lower than the threshold, or all of them if checkbox
+    // not checked, or UI is not in simulation mode, or simulation type is area
+    const bool visible = ui->checkbox_rays->isChecked() &&
+            m_ui_mode == UIMode::SimulationMode &&
+            m_simulation_handler->simulationData()->simulationType() == SimType::PointReceiver;
+
+    // Only the ray paths of the chosen emitter, with at most the chosen number of reflections,
+    // and only the most powerful ones (the lowest value of the spinboxes shows all of them)
+    const int emitter_index = ui->combobox_rays_emitter->currentIndex() - 1;
+    const QList<Emitter*> emitters = m_simulation_handler->simulationData()->getEmittersList();
+    Emitter *emitter = (emitter_index >= 0 && emitter_index < emitters.size() ? emitters.at(emitter_index) : nullptr);
+
+    const int max_count = (ui->spinbox_rays_count->value() > 0 ? ui->spinbox_rays_count->value() : -1);
+
+    m_scene->setRayPathsFilters(emitter, ui->spinbox_rays_reflections->value(), max_count);
+    m_scene->filterRayPaths(threshold, visible);
+}
+
+/**
+ * @brief MainWindow::updateRaysEmitterFilter
+ *
+ * This function fills the emitter filter of the ray paths with the emitters of the
+ * simulation, after "all the emitters" (the chosen emitter is kept if it is still there)
+ */
+void MainWindow::updateRaysEmitterFilter() {
+    const int current = ui->combobox_rays_emitter->currentIndex() - 1;
+    const int count = m_simulation_handler->simulationData()->getEmittersList().size();
+
+    // Don't filter the ray paths while the items are added
+    ui->combobox_rays_emitter->blockSignals(true);
+    ui->combobox_rays_emitter->clear();
+    ui->combobox_rays_emitter->addItem("Tous les émetteurs");
+
+    for (int i = 0 ; i < count ; i++) {
+        ui->combobox_rays_emitter->addItem(QString("Émetteur %1").arg(i + 1));
     }
+
+    ui->combobox_rays_emitter->setCurrentIndex(current >= 0 && current < count ? current + 1 : 0);
+    ui->combobox_rays_emitter->blockSignals(false);
 }
 
 void MainWindow::showReceiversResult() {
@@ -1465,6 +1653,10 @@ void MainWindow::showReceiversResult() {
 
         if (m_simulation_handler->simulationData()->simulationType() == SimType::AreaReceiver) {
             m_scene->showDataLegend(ResultType::Bitrate, 54, 433);
+
+            if (m_sim_area_item != nullptr) {
+                m_sim_area_item->showInterpolatedResults(ResultType::Bitrate, 54, 433);
+            }
         }
     }
     else {
@@ -1478,6 +1670,11 @@ void MainWindow::showReceiversResult() {
             max = SimulationData::convertPowerTodBm(max);
 
             m_scene->showDataLegend(ResultType::Power, min, max);
+
+            // The interpolated powers are in the range of the computed ones
+            if (m_sim_area_item != nullptr) {
+                m_sim_area_item->showInterpolatedResults(ResultType::Power, min, max);
+            }
         }
     }
 }
@@ -1507,8 +1704,10 @@ void MainWindow::setSimAreaVisible(bool visible) {
     }
     else if (!visible && m_sim_area_item != nullptr)
     {
-        // Be sure the simulation is resetted
-        simulationReset();
+        // Be sure the results of the receivers are cleared before they are deleted
+        m_simulation_handler->clearReceiversResults();
+        m_scene->hideDataLegend();
+        m_scene->clearRayPaths();
 
         // Remove the simulation area
         delete m_sim_area_item;
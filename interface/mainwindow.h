@@ -62,6 +62,9 @@ public slots:
     void actionZoomReset();
     void actionZoomBest();
 
+    void actionResultsCache(bool enabled);
+    void actionClearCache();
+
     void clearAllItems();
     void cancelCurrentDrawing();
 
@@ -112,6 +115,7 @@ private slots:
     void raysCheckboxToggled(bool state);
     void raysThresholdChanged(int val);
     void filterRaysThreshold();
+    void updateRaysEmitterFilter();
 
     void showReceiversResult();
 
@@ -125,6 +129,7 @@ private:
     QPoint attractivePoint(QPoint actual);
 
     bool askSimulationReset();
+    vector<int> progressiveCellsList();
 
     Ui::MainWindow *ui;
 
@@ -142,5 +147,13 @@ private:
 
     UIMode::UIMode m_ui_mode;
     ReceiversArea *m_sim_area_item;
+
+    // Step of the grid of cells computed by a progressive simulation (0 if none),
+    // if the simulation must stop after the last completed grid, if a grid is completed
+    // (the next grids only compute their new cells), and if the grids are sampled adaptively
+    int m_progressive_step;
+    bool m_progressive_stopped;
+    bool m_progressive_completed;
+    bool m_adaptive;
 };
 #endif // MAINWINDOW_H
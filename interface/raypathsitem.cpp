@@ -0,0 +1,302 @@
+#include "raypathsitem.h"
+#include "computation/simulationdata.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+
+#define PEN_WIDTH 1
+
+// Number of colors of the ray paths (power ranges)
+#define RAYS_COLORS_COUNT 64
+
+// Max number of lines given to the painter at once
+#define RAYS_BATCH_SIZE 4096
+
+// Max number of exposed lines drawn one by one (more lines are aggregated)
+#define RAYS_MAX_DRAWN_LINES 20000
+
+// Size of the pixels of the aggregated lines (in screen pixels), and max size of the image
+#define RAYS_DENSITY_PIXEL_SIZE 2
+#define RAYS_DENSITY_MAX_SIZE 2048
+
+RayPathsItem::RayPathsItem() : QGraphicsItem()
+{
+    // Under the walls (same level as the ray paths)
+    setZValue(500);
+
+    // Only the exposed lines are drawn, and the mouse events go to the items below
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    setAcceptedMouseButtons(Qt::NoButton);
+
+    m_threshold = -1;
+    m_shown_count = 0;
+
+    m_emitter_filter = nullptr;
+    m_max_reflections = -1;
+    m_max_count = -1;
+}
+
+/**
+ * @brief RayPathsItem::colorTable
+ * @return
+ *
+ * Returns the color of each power range of the ray paths (same colors as RayPath::paint())
+ */
+const QVector<QRgb> &RayPathsItem::colorTable() {
+    static QVector<QRgb> table;
+
+    if (table.isEmpty()) {
+        for (int i = 0 ; i < RAYS_COLORS_COUNT ; i++) {
+            table.append(SimulationData::ratioToColor(i / (double) (RAYS_COLORS_COUNT - 1)));
+        }
+    }
+
+    return table;
+}
+
+/**
+ * @brief RayPathsItem::setRayPaths
+ * @param ray_paths
+ * @param sim_scale : The number of pixels per meter
+ *
+ * This function sets the ray paths to draw (their lines are copied, so the ray
+ * paths can be deleted). All the ray paths matching the filters are shown until
+ * setThreshold() is called.
+ */
+void RayPathsItem::setRayPaths(QList<RayPath*> ray_paths, qreal sim_scale) {
+    prepareGeometryChange();
+
+    m_index.build(ray_paths, sim_scale);
+
+    // Color of the lines of each ray path
+    m_colors.clear();
+
+    for (int i = 0 ; i < m_index.size() ; i++) {
+        const IndexedRayPath &path = m_index.path(i);
+        const double ratio = max(0.0, min(1.0, RayPath::colorRatio(path.power)));
+
+        m_colors.insert(m_colors.end(), path.lines_count, (unsigned char) round(ratio * (RAYS_COLORS_COUNT - 1)));
+    }
+
+    // No threshold (the powers are positive)
+    m_threshold = -1;
+    m_shown_count = shownCount(m_threshold);
+    update();
+}
+
+/**
+ * @brief RayPathsItem::clear
+ *
+ * This function removes all the ray paths
+ */
+void RayPathsItem::clear() {
+    setRayPaths(QList<RayPath*>(), 1.0);
+}
+
+/**
+ * @brief RayPathsItem::setThreshold
+ * @param threshold
+ *
+ * This function hides the ray paths with a power lower than the threshold (in Watts).
+ * Only the ray paths shown or hidden by this change are repainted.
+ */
+void RayPathsItem::setThreshold(double threshold) {
+    m_threshold = threshold;
+
+    const int count = shownCount(threshold);
+
+    if (count == m_shown_count) {
+        return;
+    }
+
+    // The ray paths between the previous and the new threshold
+    const QRectF changed_rect = m_index.pathsRect(
+                min(count, m_shown_count),
+                max(count, m_shown_count),
+                m_emitter_filter,
+                m_max_reflections);
+
+    m_shown_count = count;
+
+    if (!changed_rect.isNull()) {
+        update(changed_rect.adjusted(-PEN_WIDTH, -PEN_WIDTH, PEN_WIDTH, PEN_WIDTH));
+    }
+}
+
+/**
+ * @brief RayPathsItem::setFilters
+ * @param emitter         : Only show the ray paths from this emitter (nullptr for all)
+ * @param max_reflections : Only show the ray paths with at most this number of reflections (-1 for all)
+ * @param max_count       : Only show the most powerful ray paths (-1 for all)
+ */
+void RayPathsItem::setFilters(Emitter *emitter, int max_reflections, int max_count) {
+    if (emitter == m_emitter_filter && max_reflections == m_max_reflections && max_count == m_max_count) {
+        return;
+    }
+
+    m_emitter_filter = emitter;
+    m_max_reflections = max_reflections;
+    m_max_count = max_count;
+
+    m_shown_count = shownCount(m_threshold);
+    update();
+}
+
+/**
+ * @brief RayPathsItem::shownCount
+ * @param threshold : The min power of the shown ray paths (in Watts)
+ * @return
+ *
+ * Returns the number of ray paths of the index to consider for the painting: the ray
+ * paths over the threshold, or only up to the last of the most powerful ray paths
+ * matching the filters (the other ray paths of this prefix are skipped by the filters).
+ */
+int RayPathsItem::shownCount(double threshold) const {
+    const int count = m_index.countOver(threshold);
+
+    if (m_max_count < 0) {
+        return count;
+    }
+
+    const QList<int> top = m_index.topPaths(m_max_count, threshold, m_emitter_filter, m_max_reflections);
+
+    return (top.size() == m_max_count ? (top.isEmpty() ? 0 : top.last() + 1) : count);
+}
+
+const RayPathsIndex &RayPathsItem::index() const {
+    return m_index;
+}
+
+QRectF RayPathsItem::boundingRect() const {
+    // Take care of the width of the pen
+    return m_index.boundingRect().adjusted(-PEN_WIDTH, -PEN_WIDTH, PEN_WIDTH, PEN_WIDTH);
+}
+
+QPainterPath RayPathsItem::shape() const {
+    // The ray paths can't be hovered or selected
+    return QPainterPath();
+}
+
+void RayPathsItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) {
+    const QRectF &exposed_rect = option->exposedRect;
+
+    // Nothing to paint (and no scale from the exposed rect to the density image)
+    if (exposed_rect.isEmpty()) {
+        return;
+    }
+
+    // Find the lines of the shown ray paths that can cross the exposed rect (from the grid
+    // of the index, only among the lines of the ray paths over the threshold and matching
+    // the filters)
+    vector<int> &lines = m_exposed_lines;
+    m_index.linesIn(
+                exposed_rect.adjusted(-PEN_WIDTH, -PEN_WIDTH, PEN_WIDTH, PEN_WIDTH),
+                m_shown_count,
+                &lines,
+                m_emitter_filter,
+                m_max_reflections);
+
+    if ((int) lines.size() > RAYS_MAX_DRAWN_LINES) {
+        paintDensity(painter, exposed_rect, lines);
+    }
+    else {
+        paintLines(painter, lines);
+    }
+}
+
+/**
+ * @brief RayPathsItem::paintLines
+ * @param painter
+ * @param lines   : The indexes of the lines to draw (by decreasing power)
+ *
+ * This function draws the lines by batches of the same color. The less powerful
+ * lines are drawn first, so the most powerful ones are on top.
+ */
+void RayPathsItem::paintLines(QPainter *painter, const vector<int> &lines) {
+    const QVector<QRgb> &table = colorTable();
+
+    QVector<QLineF> batch;
+    batch.reserve(RAYS_BATCH_SIZE);
+
+    int color = -1;
+
+    for (int k = (int) lines.size() - 1 ; k >= 0 ; k--) {
+        const int i = lines[k];
+
+        // Draw the batch when the color changes or when it is full
+        if (m_colors[i] != color || batch.size() == RAYS_BATCH_SIZE) {
+            if (!batch.isEmpty()) {
+                painter->drawLines(batch);
+                batch.clear();
+            }
+
+            color = m_colors[i];
+            painter->setPen(QPen(QColor(table[color]), PEN_WIDTH));
+        }
+
+        batch.append(m_index.lines()[i]);
+    }
+
+    if (!batch.isEmpty()) {
+        painter->drawLines(batch);
+    }
+}
+
+/**
+ * @brief RayPathsItem::paintDensity
+ * @param painter
+ * @param exposed_rect : The rect to paint
+ * @param lines        : The indexes of the lines to draw (by decreasing power)
+ *
+ * This function draws the lines aggregated in a coarse image of the exposed rect:
+ * each pixel crossed by some lines takes the color of the most powerful one.
+ * The exposed rect must not be empty (see paint()).
+ */
+void RayPathsItem::paintDensity(QPainter *painter, const QRectF &exposed_rect, const vector<int> &lines) {
+    const QVector<QRgb> &table = colorTable();
+
+    // Size of the image (coarser than the screen)
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const int width = max(1, min(RAYS_DENSITY_MAX_SIZE, (int) ceil(exposed_rect.width() * lod / RAYS_DENSITY_PIXEL_SIZE)));
+    const int height = max(1, min(RAYS_DENSITY_MAX_SIZE, (int) ceil(exposed_rect.height() * lod / RAYS_DENSITY_PIXEL_SIZE)));
+
+    const double sx = width / exposed_rect.width();
+    const double sy = height / exposed_rect.height();
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // The lines are sorted by decreasing power, so a pixel is only set by its first line
+    vector<bool> set_pixels(width * height, false);
+
+    for (int i : lines) {
+        const QLineF &l = m_index.lines()[i];
+
+        const double x1 = (l.x1() - exposed_rect.left()) * sx;
+        const double y1 = (l.y1() - exposed_rect.top()) * sy;
+        const double x2 = (l.x2() - exposed_rect.left()) * sx;
+        const double y2 = (l.y2() - exposed_rect.top()) * sy;
+
+        // Walk along the line, one pixel at a time
+        const int steps = (int) ceil(max(fabs(x2 - x1), fabs(y2 - y1))) + 1;
+
+        for (int s = 0 ; s <= steps ; s++) {
+            const double t = s / (double) steps;
+            const int px = (int) floor(x1 + t * (x2 - x1));
+            const int py = (int) floor(y1 + t * (y2 - y1));
+
+            if (px < 0 || py < 0 || px >= width || py >= height || set_pixels[py * width + px]) {
+                continue;
+            }
+
+            set_pixels[py * width + px] = true;
+            image.setPixel(px, py, table[m_colors[i]]);
+        }
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(exposed_rect, image);
+    painter->restore();
+}
@@ -0,0 +1,66 @@
+#ifndef RAYPATHSITEM_H
+#define RAYPATHSITEM_H
+
+#include <QGraphicsItem>
+
+#include "computation/raypath.h"
+#include "computation/raypathsindex.h"
+
+/**
+ * This item draws all the ray paths of a simulation at once (instead of one graphics
+ * item per ray path).
+ *
+ * The ray paths are kept in an index sorted by decreasing power, so the lines of a same
+ * color (power range) are contiguous, and a change of the threshold only repaints the ray
+ * paths between the previous and the new threshold. Only the lines crossing the exposed
+ * rect (found from the grid of the index) are drawn, by batches of the same color. When
+ * too many lines are exposed (zoomed out), they are aggregated instead: each pixel of a
+ * coarse image takes the color of the most powerful line crossing it.
+ *
+ * The ray paths can also be filtered by emitter, by number of reflections, and to the
+ * most powerful ones (the last shown ray path is then found by RayPathsIndex::topPaths()).
+ */
+class RayPathsItem : public QGraphicsItem
+{
+public:
+    RayPathsItem();
+
+    void setRayPaths(QList<RayPath*> ray_paths, qreal sim_scale);
+    void clear();
+    void setThreshold(double threshold);
+    void setFilters(Emitter *emitter, int max_reflections, int max_count);
+
+    const RayPathsIndex &index() const;
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) override;
+
+private:
+    static const QVector<QRgb> &colorTable();
+
+    int shownCount(double threshold) const;
+
+    void paintLines(QPainter *painter, const vector<int> &lines);
+    void paintDensity(QPainter *painter, const QRectF &exposed_rect, const vector<int> &lines);
+
+    // Ray paths (lines in pixels), and color of each line in the color table
+    RayPathsIndex m_index;
+    vector<unsigned char> m_colors;
+
+    // Power threshold, and number of ray paths over the threshold (the first ones of the
+    // index, or up to the last of the most powerful ray paths matching the filters)
+    double m_threshold;
+    int m_shown_count;
+
+    // Only the ray paths of this emitter (or all if nullptr), with at most this number
+    // of reflections (or all if -1), and at most this number of ray paths (or all if -1)
+    Emitter *m_emitter_filter;
+    int m_max_reflections;
+    int m_max_count;
+
+    // Indexes of the lines crossing the exposed rect (kept between the paintings)
+    vector<int> m_exposed_lines;
+};
+
+#endif // RAYPATHSITEM_H
@@ -13,9 +13,20 @@ bool SimulationItem::placingMode() const {
 void SimulationItem::setPlacingMode(bool on) {
     prepareGeometryChange();
     m_placing_mode = on;
+    invalidateGeometry();
     update();
 }
 
+/**
+ * @brief SimulationItem::invalidateGeometry
+ *
+ * This function is called when the geometry of the item changes, so the items
+ * caching their bounding rect or shape can compute them again
+ */
+void SimulationItem::invalidateGeometry() {
+    // Nothing is cached by default
+}
+
 /**
  * @brief SimulationItem::getRealPos
  * @return
@@ -23,7 +34,7 @@ void SimulationItem::setPlacingMode(bool on) {
  * Returns the real position of the item (in meters)
  */
 QPointF SimulationItem::getRealPos() {
-    qreal scale = simulationScene()->simulationScale();
+    qreal scale = simulationScale();
     return pos() / scale;
 }
 
@@ -37,3 +48,20 @@ QPointF SimulationItem::getRealPos() {
 SimulationScene *SimulationItem::simulationScene() const {
     return dynamic_cast<SimulationScene*>(scene());
 }
+
+/**
+ * @brief SimulationItem::simulationScale
+ * @return
+ *
+ * Returns the number of pixels per meter of the item's simulation scene,
+ * or the default scale if the item is not in a simulation scene (headless simulation)
+ */
+qreal SimulationItem::simulationScale() const {
+    SimulationScene *scene = simulationScene();
+
+    if (scene == nullptr) {
+        return SIMULATION_SCALE;
+    }
+
+    return scene->simulationScale();
+}
@@ -3,6 +3,8 @@
 
 #include <QGraphicsItem>
 
+#include "computation/constants.h"
+
 class SimulationScene;
 
 class SimulationItem : public QGraphicsItem
@@ -16,6 +18,9 @@ public:
     QPointF getRealPos();
 
     SimulationScene *simulationScene() const;
+    qreal simulationScale() const;
+
+    virtual void invalidateGeometry();
 
 private:
     bool m_placing_mode;
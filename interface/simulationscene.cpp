@@ -2,13 +2,12 @@
 #include "simulationitem.h"
 #include "scaleruleritem.h"
 #include "datalegenditem.h"
+#include "raypathsitem.h"
 
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsView>
 
 
-#define SIMULATION_SCALE 50.0
-
 SimulationScene::SimulationScene(QObject *parent) : QGraphicsScene (parent)
 {
     m_scale_legend = new ScaleRulerItem();
@@ -17,6 +16,10 @@ SimulationScene::SimulationScene(QObject *parent) : QGraphicsScene (parent)
     m_data_legend = new DataLegendItem();
     m_data_legend->hide();
     addItem(m_data_legend);
+
+    m_ray_paths = new RayPathsItem();
+    m_ray_paths->hide();
+    addItem(m_ray_paths);
 }
 
 /**
@@ -109,3 +112,39 @@ void SimulationScene::hideDataLegend() {
     m_data_legend->hide();
     update();
 }
+
+/**
+ * @brief SimulationScene::showRayPaths
+ * @param ray_paths
+ *
+ * This function draws these ray paths (all of them in a single item), the ray paths
+ * are only shown by filterRayPaths()
+ */
+void SimulationScene::showRayPaths(QList<RayPath*> ray_paths) {
+    m_ray_paths->setRayPaths(ray_paths, simulationScale());
+}
+
+/**
+ * @brief SimulationScene::filterRayPaths
+ * @param threshold : The minimum power of the shown ray paths (in Watts)
+ * @param visible   : Whether the ray paths are shown
+ */
+void SimulationScene::filterRayPaths(double threshold, bool visible) {
+    m_ray_paths->setThreshold(threshold);
+    m_ray_paths->setVisible(visible);
+}
+
+/**
+ * @brief SimulationScene::setRayPathsFilters
+ * @param emitter         : Only show the ray paths from this emitter (nullptr for all)
+ * @param max_reflections : Only show the ray paths with at most this number of reflections (-1 for all)
+ * @param max_count       : Only show the most powerful ray paths (-1 for all)
+ */
+void SimulationScene::setRayPathsFilters(Emitter *emitter, int max_reflections, int max_count) {
+    m_ray_paths->setFilters(emitter, max_reflections, max_count);
+}
+
+void SimulationScene::clearRayPaths() {
+    m_ray_paths->clear();
+    m_ray_paths->hide();
+}
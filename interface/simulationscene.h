@@ -10,6 +10,9 @@
 
 class ScaleRulerItem;
 class DataLegendItem;
+class RayPathsItem;
+class RayPath;
+class Emitter;
 
 class SimulationScene : public QGraphicsScene
 {
@@ -26,6 +29,10 @@ public slots:
     void viewRectChanged(const QRectF rect, const qreal scale);
     void showDataLegend(ResultType::ResultType type, double min, double max);
     void hideDataLegend();
+    void showRayPaths(QList<RayPath*> ray_paths);
+    void filterRayPaths(double threshold, bool visible);
+    void setRayPathsFilters(Emitter *emitter, int max_reflections, int max_count);
+    void clearRayPaths();
 
 protected:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent *event) override;
@@ -54,6 +61,7 @@ signals:
 private:
     ScaleRulerItem *m_scale_legend;
     DataLegendItem *m_data_legend;
+    RayPathsItem *m_ray_paths;
 };
 
 #endif // SIMULATIONSCENE_H
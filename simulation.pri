@@ -0,0 +1,54 @@
+# Simulation: the computation core and the simulation items (graphics items) built on it.
+# This file is included by the graphical application and the command-line runner.
+
+QT       += core gui
+
+QMAKE_CXXFLAGS += -std=c++14
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+# Link the static library of the computation core (built by engine/engine.pro)
+ENGINE_LIB_DIR = $$shadowed($$PWD)/engine
+
+win32:CONFIG(release, debug|release): ENGINE_LIB_DIR = $$ENGINE_LIB_DIR/release
+else:win32:CONFIG(debug, debug|release): ENGINE_LIB_DIR = $$ENGINE_LIB_DIR/debug
+
+LIBS += -L$$ENGINE_LIB_DIR -lPhysics_project_engine
+
+win32:!win32-g++: PRE_TARGETDEPS += $$ENGINE_LIB_DIR/Physics_project_engine.lib
+else: PRE_TARGETDEPS += $$ENGINE_LIB_DIR/libPhysics_project_engine.a
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+SOURCES += \
+    $$PWD/computation/computationunit.cpp \
+    $$PWD/computation/editorindex.cpp \
+    $$PWD/computation/emitter.cpp \
+    $$PWD/computation/raypath.cpp \
+    $$PWD/computation/raypathsindex.cpp \
+    $$PWD/computation/receiver.cpp \
+    $$PWD/computation/simulationdata.cpp \
+    $$PWD/computation/simulationhandler.cpp \
+    $$PWD/computation/walls.cpp \
+    $$PWD/interface/datalegenditem.cpp \
+    $$PWD/interface/raypathsitem.cpp \
+    $$PWD/interface/scaleruleritem.cpp \
+    $$PWD/interface/simulationitem.cpp \
+    $$PWD/interface/simulationscene.cpp
+
+HEADERS += \
+    $$PWD/computation/computationunit.h \
+    $$PWD/computation/editorindex.h \
+    $$PWD/computation/emitter.h \
+    $$PWD/computation/raypath.h \
+    $$PWD/computation/raypathsindex.h \
+    $$PWD/computation/receiver.h \
+    $$PWD/computation/simulationdata.h \
+    $$PWD/computation/simulationhandler.h \
+    $$PWD/computation/walls.h \
+    $$PWD/interface/datalegenditem.h \
+    $$PWD/interface/raypathsitem.h \
+    $$PWD/interface/scaleruleritem.h \
+    $$PWD/interface/simulationitem.h \
+    $$PWD/interface/simulationscene.h
@@ -0,0 +1,28 @@
+# Tests of the computation core (run with 'make check')
+
+QT       += core testlib
+QT       -= gui
+
+CONFIG   += console testcase
+CONFIG   -= app_bundle
+
+TARGET = tst_propagationmodel
+
+QMAKE_CXXFLAGS += -std=c++14
+
+INCLUDEPATH += $$PWD/..
+DEPENDPATH += $$PWD/..
+
+# Link the static library of the computation core (built by engine/engine.pro)
+ENGINE_LIB_DIR = $$shadowed($$PWD/..)/engine
+
+win32:CONFIG(release, debug|release): ENGINE_LIB_DIR = $$ENGINE_LIB_DIR/release
+else:win32:CONFIG(debug, debug|release): ENGINE_LIB_DIR = $$ENGINE_LIB_DIR/debug
+
+LIBS += -L$$ENGINE_LIB_DIR -lPhysics_project_engine
+
+win32:!win32-g++: PRE_TARGETDEPS += $$ENGINE_LIB_DIR/Physics_project_engine.lib
+else: PRE_TARGETDEPS += $$ENGINE_LIB_DIR/libPhysics_project_engine.a
+
+SOURCES += \
+    tst_propagationmodel.cpp
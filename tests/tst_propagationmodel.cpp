@@ -0,0 +1,219 @@
+#include "computation/propagationmodel.h"
+#include "computation/materials.h"
+
+#include <QtTest>
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+// Number of calls to the global operator new while the allocations are counted
+static std::atomic<long> allocations_count(0);
+static std::atomic<bool> counting_allocations(false);
+
+void *operator new(size_t size) {
+    if (counting_allocations.load()) {
+        allocations_count++;
+    }
+
+    void *p = std::malloc(size > 0 ? size : 1);
+
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+
+/**
+ * This class tests the computation core on a fixed scene (a room with two inner walls,
+ * one emitter and one receiver).
+ *
+ * The hot loops of the ray tracing reuse their buffers, so once they are warmed up
+ * (the buffers reached the length of the longest chain of reflections), no memory
+ * is allocated per ray path. The global operator new counts the allocations.
+ * The power of each order of reflection is checked against the total power (an area
+ * simulation is updated from these sums when the reflections count changes).
+ */
+class TestPropagationModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void traceRayPathAllocations();
+    void reflectionsPowerAllocations();
+    void reflectionsPowerOrders();
+
+private:
+    int traceAllPaths();
+
+    CompiledScene *m_scene;
+    PropagationModel *m_model;
+    Antenna *m_antenna;
+    CompiledReceiver m_receiver;
+};
+
+void TestPropagationModel::initTestCase() {
+    m_scene = new CompiledScene();
+
+    // Outer walls of a 20 x 12 m room, and two inner walls
+    m_scene->addWall(QLineF(0, 0, 20, 0), BRICK_R_PERMITTIVITY, BRICK_CONDUCTIVITY, 0.3);
+    m_scene->addWall(QLineF(20, 0, 20, 12), BRICK_R_PERMITTIVITY, BRICK_CONDUCTIVITY, 0.3);
+    m_scene->addWall(QLineF(20, 12, 0, 12), BRICK_R_PERMITTIVITY, BRICK_CONDUCTIVITY, 0.3);
+    m_scene->addWall(QLineF(0, 12, 0, 0), BRICK_R_PERMITTIVITY, BRICK_CONDUCTIVITY, 0.3);
+    m_scene->addWall(QLineF(8, 0, 8, 7), CONCRETE_R_PERMITTIVITY, CONCRETE_CONDUCTIVITY, 0.2);
+    m_scene->addWall(QLineF(12, 12, 12, 5), PARTITION_R_PERMITTIVITY, PARTITION_CONDUCTIVITY, 0.1);
+
+    m_antenna = Antenna::createAntenna(AntennaType::HalfWaveDipoleVert, 1.0);
+
+    m_scene->addEmitter(QPointF(3, 4), 5e9, 0.1, m_antenna);
+    m_scene->setReflectionsCount(3);
+    m_scene->finalize();
+
+    m_model = new PropagationModel(m_scene);
+
+    m_receiver.position = QPointF(17, 9);
+    m_receiver.rotation = M_PI_2;
+    m_receiver.antenna = m_antenna;
+}
+
+void TestPropagationModel::cleanupTestCase() {
+    delete m_model;
+    delete m_scene;
+    delete m_antenna;
+}
+
+/**
+ * @brief TestPropagationModel::traceAllPaths
+ * @return
+ *
+ * This function traces the ray path of each node of the emitter's image tree to the
+ * receiver (same loop as SimulationHandler::computeReflections()), and returns the
+ * number of valid ray paths.
+ */
+int TestPropagationModel::traceAllPaths() {
+    static vector<QPointF> images_chain;
+    static vector<int> walls_chain;
+    static vector<QLineF> rays;
+
+    const ImageTree *tree = m_model->imageTree(0);
+    const vector<ImageNode> &nodes = tree->getNodes();
+    const CompiledEmitter &em = m_scene->getEmitters()[0];
+
+    int paths_count = 0;
+
+    for (int i = 0 ; i < (int) nodes.size() ; i++) {
+        double power;
+        PathTerms terms;
+
+        tree->getChain(i, &images_chain, &walls_chain);
+
+        if (m_model->traceRayPath(em, m_receiver, images_chain, walls_chain, &rays, &power, &terms)) {
+            paths_count++;
+        }
+    }
+
+    return paths_count;
+}
+
+void TestPropagationModel::traceRayPathAllocations() {
+    // Warm up the buffers
+    const int paths_count = traceAllPaths();
+    QVERIFY(paths_count > 0);
+
+    allocations_count = 0;
+    counting_allocations = true;
+
+    const int counted_paths_count = traceAllPaths();
+
+    counting_allocations = false;
+
+    QCOMPARE(counted_paths_count, paths_count);
+    QCOMPARE(allocations_count.load(), 0L);
+}
+
+void TestPropagationModel::reflectionsPowerAllocations() {
+    const int nodes_count = (int) m_model->imageTree(0)->getNodes().size();
+
+    // Warm up the buffers (with and without pruning)
+    ReceivedPower received;
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 0, &received);
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 1e-12, &received);
+    QVERIFY(received.paths_count > 0);
+
+    allocations_count = 0;
+    counting_allocations = true;
+
+    ReceivedPower counted;
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 0, &counted);
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 1e-12, &counted);
+
+    counting_allocations = false;
+
+    QCOMPARE(counted.paths_count, received.paths_count);
+    QCOMPARE(allocations_count.load(), 0L);
+}
+
+void TestPropagationModel::reflectionsPowerOrders() {
+    const int nodes_count = (int) m_model->imageTree(0)->getNodes().size();
+    const int orders_count = m_scene->reflectionsCount() + 1;
+
+    ReceivedPower received;
+    vector<ReceivedPower> orders(orders_count);
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 0, &received, 0, orders.data());
+
+    // No reflected ray path is of order 0 (the direct ray path is not in the image tree)
+    QCOMPARE(orders[0].paths_count, 0);
+
+    double orders_power = 0;
+    int orders_paths_count = 0;
+
+    for (int k = 0 ; k < orders_count ; k++) {
+        orders_power += orders[k].power;
+        orders_paths_count += orders[k].paths_count;
+    }
+
+    QCOMPARE(orders_paths_count, received.paths_count);
+    QVERIFY(fabs(orders_power - received.power) <= 1e-12 * received.power);
+
+    // Only the orders above the min order are computed
+    ReceivedPower higher;
+    vector<ReceivedPower> higher_orders(orders_count);
+    m_model->reflectionsPower(0, m_receiver, 0, nodes_count, 0, &higher, 1, higher_orders.data());
+
+    QCOMPARE(higher_orders[1].paths_count, 0);
+    QCOMPARE(higher.paths_count, received.paths_count - orders[1].paths_count);
+
+    for (int k = 2 ; k < orders_count ; k++) {
+        QCOMPARE(higher_orders[k].paths_count, orders[k].paths_count);
+        QCOMPARE(higher_orders[k].power, orders[k].power);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestPropagationModel)
+
+#include "tst_propagationmodel.moc"